@@ -13,6 +13,15 @@ if( NOT TEST_REFERENCE )
 endif( NOT TEST_REFERENCE )
 
 set(ENV{BOX86_LOG} 0)
+if( DEFINED TEST_PEEPHOLE )
+  set(ENV{BOX86_DYNAREC_PEEPHOLE} ${TEST_PEEPHOLE})
+endif( DEFINED TEST_PEEPHOLE )
+if( DEFINED TEST_STRONGMEM )
+  set(ENV{BOX86_DYNAREC_STRONGMEM} ${TEST_STRONGMEM})
+endif( DEFINED TEST_STRONGMEM )
+if( DEFINED TEST_LOCKSTEP )
+  set(ENV{BOX86_DYNAREC_LOCKSTEP} ${TEST_LOCKSTEP})
+endif( DEFINED TEST_LOCKSTEP )
 set(ENV{LD_LIBRARY_PATH} ${CMAKE_SOURCE_DIR}/x86lib)
 # run the test program, capture the stdout/stderr and the result var
 execute_process(
@@ -17,18 +17,144 @@
 #include "wrapper.h"
 #include "myfts.h"
 #include "threads.h"
+#include "profiler.h"
 #ifdef DYNAREC
 #include <sys/mman.h>
 #include "dynablock.h"
 
+typedef struct blockowner_s {
+    uintptr_t     start;            // native code address
+    int           size;
+    dynablock_t*  db;
+} blockowner_t;
+
 typedef struct mmaplist_s {
     void*         block;
     uintptr_t     offset;           // offset in the block
+    blockowner_t* owners;           // dynablocks allocated in the block, so in address order
+    int           nowners;
+    int           capowners;
 } mmaplist_t;
 
+/*
+    Owners are added with mutex_mmap, but looked up without any lock (FindDynablockFromNativeAddress is used
+by signal handlers). So an entry is written before the count is increased, and a grown array is a new
+copy published before the count: the old array is never freed (arrays grow x2, so it cost at most the
+size of the live one), a reader still using it sees a smaller, but valid, list.
+    When a dynablock is freed, its entry is kept (the code memory is never reused) but its db is cleared,
+also with mutex_mmap and before the dynablock memory is released.
+*/
+static void AddOwner(mmaplist_t* map, uintptr_t start, int size, dynablock_t* db)
+{
+    if(map->nowners==map->capowners) {
+        int cap = map->capowners?(map->capowners*2):256;
+        blockowner_t* owners = (blockowner_t*)malloc(cap*sizeof(blockowner_t));
+        if(map->nowners)
+            memcpy(owners, map->owners, map->nowners*sizeof(blockowner_t));
+        map->owners = owners;   // old one is leaked, a reader may still use it
+        map->capowners = cap;
+    }
+    map->owners[map->nowners].start = start;
+    map->owners[map->nowners].size = size;
+    map->owners[map->nowners].db = db;
+    __sync_synchronize();
+    ++map->nowners;
+}
+
+static blockowner_t* GetOwner(mmaplist_t* map, uintptr_t addr)
+{
+    uintptr_t base = (uintptr_t)map->block;
+    if(addr<base || addr>=base+map->offset)
+        return NULL;
+    int lo = 0, hi = map->nowners-1;
+    __sync_synchronize();
+    blockowner_t* owners = map->owners;
+    while(lo<=hi) {
+        int mid = (lo+hi)/2;
+        blockowner_t* o = &owners[mid];
+        if(addr<o->start)
+            hi = mid-1;
+        else if(addr>=o->start+o->size)
+            lo = mid+1;
+        else
+            return o;
+    }
+    return NULL;
+}
+
+static dynablock_t* FindOwner(mmaplist_t* map, uintptr_t addr, uintptr_t* start)
+{
+    blockowner_t* o = GetOwner(map, addr);
+    if(!o)
+        return NULL;
+    dynablock_t* db = o->db;    // read once, it can be cleared at any time
+    if(db && start) *start = o->start;
+    return db;
+}
+
+static box86context_t* owners_context = NULL;   // dynablocks are freed without a context at hand
+
 #define MMAPSIZE (4*1024*1024)       // allocate 4Mo sized blocks
+#define NEARSIZE (16*1024*1024)      // size of the code arena reserved near box86 text
+#define BLRANGE  (32*1024*1024)      // reach of ARM B/BL
+
+extern char __executable_start[];
+extern char etext[];
+
+// Try to reserve a code arena close enough to box86 text so generated code can BL to the helpers
+static void ReserveDynarecNear(box86context_t *context)
+{
+    uintptr_t text_start = (uintptr_t)__executable_start;
+    uintptr_t text_end = (uintptr_t)etext;
+    // just below box86 text first, and just after it if the kernel didn't like it
+    uintptr_t hints[2] = {(text_start-NEARSIZE)&~0xffff, (text_end+0x100000+0xffff)&~0xffff};
+    for(int i=0; i<2; ++i) {
+        void* p = mmap((void*)hints[i], NEARSIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if(p==MAP_FAILED)
+            continue;
+        uintptr_t start = ((uintptr_t)p<text_start)?(uintptr_t)p:text_start;
+        uintptr_t end = ((uintptr_t)p+NEARSIZE>text_end)?((uintptr_t)p+NEARSIZE):text_end;
+        if(end-start<BLRANGE) {
+            dynarec_log(LOG_DEBUG, "Dynarec near arena reserved at %p (box86 text at %p-%p)\n", p, (void*)text_start, (void*)text_end);
+            context->dynarec_near = (uintptr_t)p;
+            context->nearmap = (mmaplist_t*)calloc(1, sizeof(mmaplist_t));
+            context->nearmap->block = p;
+            return;
+        }
+        munmap(p, NEARSIZE);
+    }
+    dynarec_log(LOG_INFO, "Cannot reserve a Dynarec arena near box86 text, helpers will be called with long branches\n");
+}
+
+// Allocate from the near arena, 0 if it's full (or not available). Memory there is never freed
+uintptr_t AllocDynarecNear(box86context_t *context, int size, dynablock_t* db)
+{
+    if(!context->dynarec_near)
+        return 0;
+    // make size 0x10 bytes aligned
+    size = (size+0x0f)&~0x0f;
+    uintptr_t ret = 0;
+    pthread_mutex_lock(&context->mutex_mmap);
+    if(context->nearmap->offset+size <= NEARSIZE) {
+        ret = context->dynarec_near + context->nearmap->offset;
+        context->nearmap->offset += size;
+        AddOwner(context->nearmap, ret, size, db);
+    }
+    pthread_mutex_unlock(&context->mutex_mmap);
+    return ret;
+}
 
-uintptr_t AllocDynarecMap(box86context_t *context, int size, int nolinker)
+// Is target reachable with a B/BL from anywhere in the near arena?
+int IsDynarecNear(box86context_t *context, uintptr_t target)
+{
+    if(!context->dynarec_near || (target&1))    // thumb targets would need a BLX
+        return 0;
+    intptr_t lo = (intptr_t)(target - (context->dynarec_near+8));
+    intptr_t hi = (intptr_t)(target - (context->dynarec_near+NEARSIZE+8));
+    return (lo<BLRANGE && lo>=-BLRANGE && hi<BLRANGE && hi>=-BLRANGE);
+}
+
+uintptr_t AllocDynarecMap(box86context_t *context, int size, int nolinker, dynablock_t* db)
 {
     if(nolinker) {
         void* p = mmap(NULL, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -46,27 +172,68 @@ uintptr_t AllocDynarecMap(box86context_t *context, int size, int nolinker)
         if(context->mmaplist[i].offset+size < MMAPSIZE) {
             uintptr_t ret = context->mmaplist[i].offset + (uintptr_t)context->mmaplist[i].block;
             context->mmaplist[i].offset+=size;
+            AddOwner(&context->mmaplist[i], ret, size, db);
             pthread_mutex_unlock(&context->mutex_mmap);
             return ret;
         }
     }
     // no luck, add a new one !
-    int i = context->mmapsize++;    // yeah, usefull post incrementation
-    dynarec_log(LOG_DEBUG, "Ask for DynaRec Block Alloc #%d\n", context->mmapsize);
-    context->mmaplist = (mmaplist_t*)realloc(context->mmaplist, context->mmapsize*sizeof(mmaplist_t));
+    int i = context->mmapsize;
+    dynarec_log(LOG_DEBUG, "Ask for DynaRec Block Alloc #%d\n", i+1);
     void* p = mmap(NULL, MMAPSIZE, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
     if(p==MAP_FAILED) {
         dynarec_log(LOG_INFO, "Cannot create memory map of %d byte for dynarec block #%d\n", MMAPSIZE, i);
-        --context->mmapsize;
         pthread_mutex_unlock(&context->mutex_mmap);
         return 0;
     }
-    context->mmaplist[i].block = p;
-    context->mmaplist[i].offset=size;
+    // same as the owners: a new copy of the list, published before the count (the old copy is leaked)
+    mmaplist_t* list = (mmaplist_t*)calloc(i+1, sizeof(mmaplist_t));
+    if(i)
+        memcpy(list, context->mmaplist, i*sizeof(mmaplist_t));
+    list[i].block = p;
+    list[i].offset=size;
+    AddOwner(&list[i], (uintptr_t)p, size, db);
+    context->mmaplist = list;
+    __sync_synchronize();
+    context->mmapsize = i+1;
     pthread_mutex_unlock(&context->mutex_mmap);
     return (uintptr_t)p;
 }
 
+// Find the dynablock that own a native address (only for blocks that are not nolinker), and the start of its code
+// No lock is taken, so it can be used from a signal handler
+dynablock_t* FindDynablockFromNativeAddress(box86context_t *context, uintptr_t addr, uintptr_t* start)
+{
+    dynablock_t* db = NULL;
+    if(context->nearmap)
+        db = FindOwner(context->nearmap, addr, start);
+    int n = context->mmapsize;
+    __sync_synchronize();
+    mmaplist_t* list = context->mmaplist;
+    for(int i=0; i<n && !db; ++i)
+        db = FindOwner(&list[i], addr, start);
+    return db;
+}
+
+// Clear the owner of the code at addr, before db is freed, so FindDynablockFromNativeAddress cannot return it anymore
+void RemoveDynarecOwner(uintptr_t addr, dynablock_t* db)
+{
+    box86context_t* context = owners_context;
+    if(!context)
+        return;
+    pthread_mutex_lock(&context->mutex_mmap);
+    blockowner_t* o = NULL;
+    if(context->nearmap)
+        o = GetOwner(context->nearmap, addr);
+    for(int i=0; i<context->mmapsize && !o; ++i)
+        o = GetOwner(&context->mmaplist[i], addr);
+    if(o && o->db==db) {
+        o->db = NULL;
+        __sync_synchronize();
+    }
+    pthread_mutex_unlock(&context->mutex_mmap);
+}
+
 // each dynmap is 64k of size
 typedef struct dynmap_s {
     dynablocklist_t* dynablocks;    // the dynabockist of the block
@@ -174,6 +341,9 @@ box86context_t *NewBox86Context(int argc)
 #ifdef DYNAREC
     pthread_mutex_init(&context->mutex_blocks, NULL);
     pthread_mutex_init(&context->mutex_mmap, NULL);
+    owners_context = context;
+    if(box86_dynarec)
+        ReserveDynarecNear(context);
     context->dynablocks = NewDynablockList(0, 0, 0, 0, 0);
 #endif
     InitFTSMap(context);
@@ -193,19 +363,38 @@ void FreeBox86Context(box86context_t** context)
     if(--(*context)->forked >= 0)
         return;
 
+    if(box86_profile)
+        ProfilerDump(*context);
+
     FreeFTSMap(*context);
 
     if((*context)->maplib)
         FreeLibrarian(&(*context)->maplib);
 
 #ifdef DYNAREC
+    if((*context)->dynarec_nblocks)
+        dynarec_log(LOG_INFO, "Dynarec stats: %u blocks, %u x86 bytes translated to %u ARM bytes (x%.2f)\n", 
+            (*context)->dynarec_nblocks, (*context)->dynarec_x86size, (*context)->dynarec_armsize, 
+            (*context)->dynarec_x86size?((float)(*context)->dynarec_armsize/(float)(*context)->dynarec_x86size):0.0f);
+    if((*context)->dynarec_thumb2size)
+        dynarec_log(LOG_INFO, "Dynarec stats: the same blocks would be %u bytes in Thumb-2 (x%.2f of ARM), %u ARM opcodes without Thumb-2 equivalent\n", 
+            (*context)->dynarec_thumb2size, (*context)->dynarec_armsize?((float)(*context)->dynarec_thumb2size/(float)(*context)->dynarec_armsize):0.0f,
+            (*context)->dynarec_thumb2untr);
     dynarec_log(LOG_INFO, "Free global Dynarecblocks\n");
     if((*context)->dynablocks)
         FreeDynablockList(&(*context)->dynablocks);
-    for (int i=0; i<(*context)->mmapsize; ++i)
+    owners_context = NULL;  // the remaining lists are nolinker, their blocks have no owner
+    for (int i=0; i<(*context)->mmapsize; ++i) {
         if((*context)->mmaplist[i].block)
             munmap((*context)->mmaplist[i].block, MMAPSIZE);
+        free((*context)->mmaplist[i].owners);
+    }
     free((*context)->mmaplist);
+    if((*context)->dynarec_near) {
+        munmap((void*)(*context)->dynarec_near, NEARSIZE);
+        free((*context)->nearmap->owners);
+        free((*context)->nearmap);
+    }
     pthread_mutex_destroy(&(*context)->mutex_blocks);
     pthread_mutex_destroy(&(*context)->mutex_mmap);
     dynarec_log(LOG_INFO, "Free dynamic Dynarecblocks\n");
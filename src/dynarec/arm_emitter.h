@@ -66,6 +66,10 @@ Op is 20-27
 
 //  nop
 #define NOP     EMIT(0xe1a00000)
+// yield hint (a nop on single thread cores)
+#define YIELD   EMIT(0xe320f001)
+// read the 64bits virtual count of the generic timer in hi:lo (MRRC p15, 1, lo, hi, c14)
+#define MRRC_CNTVCT(lo, hi) EMIT(c__ | 0x0c500f1e | ((hi) << 16) | ((lo) << 12))
 
 // mov dst, src
 #define MOV_REG(dst, src) EMIT(0xe1a00000 | ((dst) << 12) | (src) )
@@ -76,12 +80,14 @@ Op is 20-27
 #define MOVW(dst, imm16) EMIT(0xe3000000 | ((dst) << 12) | (((imm16) & 0xf000) << 4) | brIMM((imm16) & 0x0fff) )
 // movt dst, #imm16
 #define MOVT(dst, imm16) EMIT(0xe3400000 | ((dst) << 12) | (((imm16) & 0xf000) << 4) | brIMM((imm16) & 0x0fff) )
-// pseudo insruction: mov reg, #imm with imm a 32bits value
+// pseudo insruction: mov reg, #imm with imm a 32bits value (nothing emited if the peephole knows reg already has imm)
 #define MOV32(dst, imm32)                   \
-    MOVW(dst, ((uint32_t)imm32)&0xffff);    \
-    if (((uint32_t)imm32)>>16) {            \
-        MOVT(dst, (((uint32_t)imm32)>>16)); }
-// pseudo insruction: mov reg, #imm with imm a 32bits value, fixed size
+    if(!arm_peephole_isconst(dyn, dst, (uint32_t)(imm32))) {    \
+        MOVW(dst, ((uint32_t)imm32)&0xffff);    \
+        if (((uint32_t)imm32)>>16) {            \
+            MOVT(dst, (((uint32_t)imm32)>>16)); }   \
+        arm_peephole_setconst(dyn, dst, (uint32_t)(imm32)); }
+// pseudo insruction: mov reg, #imm with imm a 32bits value, fixed size (not tracked by the peephole)
 #define MOV32_(dst, imm32)                   \
     MOVW(dst, ((uint32_t)imm32)&0xffff);    \
     MOVT(dst, (((uint32_t)imm32)>>16))
@@ -267,8 +273,12 @@ Op is 20-27
 
 // str reg, [addr, #+/-imm9]
 #define STR_IMM9(reg, addr, imm9) EMIT(0xe5000000 | (((imm9)<0)?0:1)<<23 | ((reg) << 12) | ((addr) << 16) | brIMM(imm9) )
+// strxx reg, [addr, #+/-imm9]
+#define STR_IMM9_COND(cond, reg, addr, imm9) EMIT(cond | 0x05000000 | (((imm9)<0)?0:1)<<23 | ((reg) << 12) | ((addr) << 16) | brIMM(imm9) )
 // strb reg, [addr, #+/-imm9]
 #define STRB_IMM9(reg, addr, imm9) EMIT(0xe5400000 | (((imm9)<0)?0:1)<<23 | ((reg) << 12) | ((addr) << 16) | brIMM(imm9) )
+// strbxx reg, [addr, #+/-imm9]
+#define STRB_IMM9_COND(cond, reg, addr, imm9) EMIT(cond | 0x05400000 | (((imm9)<0)?0:1)<<23 | ((reg) << 12) | ((addr) << 16) | brIMM(imm9) )
 // str reg, [addr], #+/-imm9
 #define STRAI_IMM9_W(reg, addr, imm9)  EMIT(0xe4000000 | (((imm9)<0)?0:1)<<23 | ((reg) << 12) | ((addr) << 16) | brIMM(imm9) )
 // str reg, [addr, rm lsl imm5]
@@ -340,6 +350,8 @@ Op is 20-27
 // Mul and MulA
 #define MULMULA(Cond, A, S, Rd, Rn, Rs, Rm)     (Cond | (0b000000<<22) | (A<<21) | (S<<20) | (Rd<<16) | (Rn<<12) | (Rs<<8) | (0b1001<<4) | (Rm))
 #define MUL(Rd, Rm, Rn)     EMIT(MULMULA(c__, 0, 0, (Rd), 0, (Rm), (Rn)))
+// Mul and Sub: Rd <- Ra - Rn*Rm
+#define MLS(Rd, Rn, Rm, Ra) EMIT(c__ | 0b00000110<<20 | (Rd)<<16 | (Ra)<<12 | (Rm)<<8 | 0b1001<<4 | (Rn))
 
 #define SMUL_16_gen(cond, Rd, Rm, M, N, Rn) (cond | 0b00010110<<20 | (Rd)<<16 | (Rm)<<8 | 1<<7 | (M)<<6 | (N)<<5 | (Rn))
 // Signed Mul between Rn[0..15] * Rm[0..15] => Rd
@@ -604,6 +616,10 @@ Op is 20-27
 #define VEORQ(Dd, Dn, Dm)   EMIT(VEOR_gen(((Dd)>>4)&1, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, (Dm)&15))
 
 #define VMOVL_gen(U, D, imm3, Vd, M, Vm) (0b1111<<28 | 0b001<<25 | (U)<<24 | 1<<23 | (D)<<22 | (imm3)<<19 | (Vd)<<12 | 0b1010<<8 | (M)<<5 | 1<<4 | (Vm))
+#define VMOVL_S8(Dd, Dm)    EMIT(VMOVL_gen(0, ((Dd)>>4)&1, 0b001, (Dd)&15, ((Dm)>>4)&1, (Dm)&15))
+#define VMOVL_U8(Dd, Dm)    EMIT(VMOVL_gen(1, ((Dd)>>4)&1, 0b001, (Dd)&15, ((Dm)>>4)&1, (Dm)&15))
+#define VMOVL_S16(Dd, Dm)   EMIT(VMOVL_gen(0, ((Dd)>>4)&1, 0b010, (Dd)&15, ((Dm)>>4)&1, (Dm)&15))
+#define VMOVL_U16(Dd, Dm)   EMIT(VMOVL_gen(1, ((Dd)>>4)&1, 0b010, (Dd)&15, ((Dm)>>4)&1, (Dm)&15))
 #define VMOVL_S32(Dd, Dm)   EMIT(VMOVL_gen(0, ((Dd)>>4)&1, 0b100, (Dd)&15, ((Dm)>>4)&1, (Dm)&15))
 #define VMOVL_U32(Dd, Dm)   EMIT(VMOVL_gen(1, ((Dd)>>4)&1, 0b100, (Dd)&15, ((Dm)>>4)&1, (Dm)&15))
 
@@ -921,4 +937,68 @@ Op is 20-27
 #define VMINQ_F32(Dd, Dn, Dm)   EMIT(VMINMAXF_gen(((Dd)>>4)&1, 1, 0, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, (Dm)&15))
 #define VMAXQ_F32(Dd, Dn, Dm)   EMIT(VMINMAXF_gen(((Dd)>>4)&1, 0, 0, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, (Dm)&15))
 
+#define VMINMAX_gen(U, D, size, Vn, Vd, N, Q, M, op, Vm) (0b1111<<28 | 0b001<<25 | (U)<<24 | 0<<23 | (D)<<22 | (size)<<20 | (Vn)<<16 | (Vd)<<12 | 0b0110<<8 | (N)<<7 | (Q)<<6 | (M)<<5 | (op)<<4 | (Vm))
+#define VMINQ_S8(Dd, Dn, Dm)    EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMINQ_S16(Dd, Dn, Dm)   EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMINQ_S32(Dd, Dn, Dm)   EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b10, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMINQ_U8(Dd, Dn, Dm)    EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMINQ_U16(Dd, Dn, Dm)   EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMINQ_U32(Dd, Dn, Dm)   EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b10, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMAXQ_S8(Dd, Dn, Dm)    EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 0, (Dm)&15))
+#define VMAXQ_S16(Dd, Dn, Dm)   EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 0, (Dm)&15))
+#define VMAXQ_S32(Dd, Dn, Dm)   EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b10, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 0, (Dm)&15))
+#define VMAXQ_U8(Dd, Dn, Dm)    EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 0, (Dm)&15))
+#define VMAXQ_U16(Dd, Dn, Dm)   EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 0, (Dm)&15))
+#define VMAXQ_U32(Dd, Dn, Dm)   EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b10, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, 0, (Dm)&15))
+#define VMIN_U8(Dd, Dn, Dm)     EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMIN_S16(Dd, Dn, Dm)    EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, 1, (Dm)&15))
+#define VMAX_U8(Dd, Dn, Dm)     EMIT(VMINMAX_gen(1, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, 0, (Dm)&15))
+#define VMAX_S16(Dd, Dn, Dm)    EMIT(VMINMAX_gen(0, ((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, 0, (Dm)&15))
+
+#define VPADD_gen(D, size, Vn, Vd, N, M, Vm) (0b1111<<28 | 0b0010<<24 | 0<<23 | (D)<<22 | (size)<<20 | (Vn)<<16 | (Vd)<<12 | 0b1011<<8 | (N)<<7 | 0<<6 | (M)<<5 | 1<<4 | (Vm))
+// Pairwise add: Dd = {Dn[0]+Dn[1], Dn[2]+Dn[3]..., Dm[0]+Dm[1]...}, no Q form
+#define VPADD_8(Dd, Dn, Dm)     EMIT(VPADD_gen(((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, ((Dm)>>4)&1, (Dm)&15))
+#define VPADD_16(Dd, Dn, Dm)    EMIT(VPADD_gen(((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, ((Dm)>>4)&1, (Dm)&15))
+#define VPADD_32(Dd, Dn, Dm)    EMIT(VPADD_gen(((Dd)>>4)&1, 0b10, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, ((Dm)>>4)&1, (Dm)&15))
+#define VPADD_F32(Dd, Dn, Dm)   EMIT(0b1111<<28 | 0b0011<<24 | 0<<23 | (((Dd)>>4)&1)<<22 | 0b00<<20 | ((Dn)&15)<<16 | ((Dd)&15)<<12 | 0b1101<<8 | (((Dn)>>4)&1)<<7 | 0<<6 | (((Dm)>>4)&1)<<5 | 0<<4 | ((Dm)&15))
+
+#define VABS_gen(D, size, Vd, F, Q, M, Vm) (0b1111<<28 | 0b0011<<24 | 1<<23 | (D)<<22 | 0b11<<20 | (size)<<18 | 0b01<<16 | (Vd)<<12 | (F)<<10 | 0b110<<7 | (Q)<<6 | (M)<<5 | (Vm))
+#define VABSQ_8(Dd, Dm)     EMIT(VABS_gen(((Dd)>>4)&1, 0b00, (Dd)&15, 0, 1, ((Dm)>>4)&1, (Dm)&15))
+#define VABSQ_16(Dd, Dm)    EMIT(VABS_gen(((Dd)>>4)&1, 0b01, (Dd)&15, 0, 1, ((Dm)>>4)&1, (Dm)&15))
+#define VABSQ_32(Dd, Dm)    EMIT(VABS_gen(((Dd)>>4)&1, 0b10, (Dd)&15, 0, 1, ((Dm)>>4)&1, (Dm)&15))
+
+#define VDUP_gen(D, imm4, Vd, Q, M, Vm) (0b1111<<28 | 0b0011<<24 | 1<<23 | (D)<<22 | 0b11<<20 | (imm4)<<16 | (Vd)<<12 | 0b11000<<7 | (Q)<<6 | (M)<<5 | (Vm))
+// Duplicate scalar Dm[x] in all 32bits lanes of Dd
+#define VDUP_32(Dd, Dm, x)  EMIT(VDUP_gen(((Dd)>>4)&1, ((x)&1)<<3 | 0b100, (Dd)&15, 0, ((Dm)>>4)&1, (Dm)&15))
+#define VDUPR_gen(cond, b, Q, Vd, Rt, D, e) ((cond) | 0b11101<<23 | (b)<<22 | (Q)<<21 | 0<<20 | (Vd)<<16 | (Rt)<<12 | 0b1011<<8 | (D)<<7 | (e)<<5 | 1<<4)
+// Duplicate ARM register Rt in all 16bits / 32bits lanes of Dd
+#define VDUPR_16(Dd, Rt)    EMIT(VDUPR_gen(c__, 0, 0, (Dd)&15, Rt, ((Dd)>>4)&1, 1))
+#define VDUPR_32(Dd, Rt)    EMIT(VDUPR_gen(c__, 0, 0, (Dd)&15, Rt, ((Dd)>>4)&1, 0))
+
+#define VBSL_gen(D, op, Vn, Vd, N, Q, M, Vm) (0b1111<<28 | 0b0011<<24 | 0<<23 | (D)<<22 | (op)<<20 | (Vn)<<16 | (Vd)<<12 | 0b0001<<8 | (N)<<7 | (Q)<<6 | (M)<<5 | 1<<4 | (Vm))
+// Bitwise insert if true: bits of Dn are copied in Dd where Dm bits are set
+#define VBITQ(Dd, Dn, Dm)   EMIT(VBSL_gen(((Dd)>>4)&1, 0b10, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 1, ((Dm)>>4)&1, (Dm)&15))
+#define VBIT(Dd, Dn, Dm)    EMIT(VBSL_gen(((Dd)>>4)&1, 0b10, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, (Dm)&15))
+
+#define VMOVI_gen(i, D, imm3, Vd, cmode, Q, op, imm4) (0b1111<<28 | 0b001<<25 | (i)<<24 | 1<<23 | (D)<<22 | (imm3)<<16 | (Vd)<<12 | (cmode)<<8 | (Q)<<6 | (op)<<5 | 1<<4 | (imm4))
+// Dd = imm8 replicated in all bytes
+#define VMOVQ_I8(Dd, imm8)  EMIT(VMOVI_gen(((imm8)>>7)&1, ((Dd)>>4)&1, ((imm8)>>4)&7, (Dd)&15, 0b1110, 1, 0, (imm8)&15))
+// Dd = 64bits, each bit of imm8 giving 0x00 or 0xff for the corresponding byte
+#define VMOV_I64(Dd, imm8)  EMIT(VMOVI_gen(((imm8)>>7)&1, ((Dd)>>4)&1, ((imm8)>>4)&7, (Dd)&15, 0b1110, 0, 1, (imm8)&15))
+
+#define VRHADD_gen(U, D, size, Vn, Vd, N, Q, M, Vm) (0b1111<<28 | 0b001<<25 | (U)<<24 | 0<<23 | (D)<<22 | (size)<<20 | (Vn)<<16 | (Vd)<<12 | 0b0001<<8 | (N)<<7 | (Q)<<6 | (M)<<5 | 0<<4 | (Vm))
+// Rounding halving add: Dd = (Dn+Dm+1)>>1
+#define VRHADD_U8(Dd, Dn, Dm)   EMIT(VRHADD_gen(1, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, (Dm)&15))
+#define VRHADD_U16(Dd, Dn, Dm)  EMIT(VRHADD_gen(1, ((Dd)>>4)&1, 0b01, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, (Dm)&15))
+
+#define VABD_gen(U, D, size, Vn, Vd, N, Q, M, Vm) (0b1111<<28 | 0b001<<25 | (U)<<24 | 0<<23 | (D)<<22 | (size)<<20 | (Vn)<<16 | (Vd)<<12 | 0b0111<<8 | (N)<<7 | (Q)<<6 | (M)<<5 | 0<<4 | (Vm))
+// Absolute difference: Dd = |Dn-Dm|
+#define VABD_U8(Dd, Dn, Dm)     EMIT(VABD_gen(1, ((Dd)>>4)&1, 0b00, (Dn)&15, (Dd)&15, ((Dn)>>4)&1, 0, ((Dm)>>4)&1, (Dm)&15))
+
+#define VPADDL_gen(D, size, Vd, op, Q, M, Vm) (0b1111<<28 | 0b0011<<24 | 1<<23 | (D)<<22 | 0b11<<20 | (size)<<18 | 0b00<<16 | (Vd)<<12 | 0b0010<<8 | (op)<<7 | (Q)<<6 | (M)<<5 | 0<<4 | (Vm))
+// Pairwise add long: Dd = {Dm[0]+Dm[1], Dm[2]+Dm[3]...} with lanes twice as wide
+#define VPADDL_U8(Dd, Dm)   EMIT(VPADDL_gen(((Dd)>>4)&1, 0b00, (Dd)&15, 1, 0, ((Dm)>>4)&1, (Dm)&15))
+#define VPADDL_U16(Dd, Dm)  EMIT(VPADDL_gen(((Dd)>>4)&1, 0b01, (Dd)&15, 1, 0, ((Dm)>>4)&1, (Dm)&15))
+#define VPADDL_U32(Dd, Dm)  EMIT(VPADDL_gen(((Dd)>>4)&1, 0b10, (Dd)&15, 1, 0, ((Dm)>>4)&1, (Dm)&15))
+
 #endif  //__ARM_EMITTER_H__
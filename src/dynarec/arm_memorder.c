@@ -0,0 +1,99 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#include "debug.h"
+#include "x86trace.h"
+#include "dynarec_arm_private.h"
+#include "arm_memorder.h"
+
+/*
+    ARM Memory ordering
+
+x86 is TSO: loads are not reordered with other loads, stores are not reordered with older loads or other stores.
+ARM is weakly ordered, so multithreaded x86 code (lock-free queues, double-checked init...) can misbehave.
+Barriers are placed at emit time (on pass 2 and 3, so sizes stay coherent), looking at each memory access:
+    - accesses based on xEmu, the ARM stack, xESP or the PC are private and never need a barrier
+    - other accesses are "shared": a DMB ISH is emited before a shared access if an older shared access
+      it must not be reordered with is still pending (i.e. there was no DMB in between)
+So a region with no shared accesses doesn't get any barrier. In TSO mode, loads and stores are ordered
+In Selective mode, only stores are ordered with older accesses, and loads with older stores.
+On jump targets and after branches/calls, pending accesses are unknown, so assumed.
+*/
+
+#define xEmu    0
+#define xESP    8
+#define xSP     13
+#define xPC     15
+
+#define PEND_LD 1
+#define PEND_ST 2
+
+void arm_memorder_label(dynarec_arm_t* dyn, int jmptarget)
+{
+    if(jmptarget)
+        dyn->mem_pending = PEND_LD|PEND_ST;
+}
+
+// return 0 if not a memory access, 1 for a load, 2 for a store. *rn is the base register
+static int memaccess(uint32_t op, int* rn)
+{
+    *rn = (op>>16)&15;
+    int l = (op>>20)&1;
+    if((op>>28)==0b1111) {
+        if((op&0xff300000)==0xf4000000)     // VST1..4 (bit 21 is L)
+            return 2;
+        if((op&0xff300000)==0xf4200000)     // VLD1..4
+            return 1;
+        return 0;
+    }
+    switch((op>>25)&0b111) {
+        case 0b000:
+            if((op&0x0f8000f0)==0x01800090)     // LDREX / STREX
+                return l?1:2;
+            if((op&0x0e000090)==0x00000090 && (op&0x60)) {
+                // extra load/store (halfword, signed byte, dual)
+                if(!l && (op&0x60)==0x40)   // LDRD
+                    return 1;
+                return l?1:2;
+            }
+            return 0;
+        case 0b011:
+            if((op>>4)&1)
+                return 0;   // media instructions
+            // fallthrough
+        case 0b010:         // LDR / STR
+        case 0b100:         // LDM / STM
+            return l?1:2;
+        case 0b110:         // VLDR / VSTR / VLDM / VSTM
+            if(!(op&0x01a00000))
+                return 0;   // VMOV between 2 core regs and a double
+            return l?1:2;
+        default:
+            return 0;
+    }
+}
+
+int arm_memorder(dynarec_arm_t* dyn, uint32_t opcode)
+{
+    if(box86_dynarec_strongmem==MEMORDER_WEAK)
+        return 0;
+    int rn;
+    int type = memaccess(opcode, &rn);
+    if(!type) {
+        if(((opcode>>25)&0b111)==0b101 || (opcode&0x0ffffff0)==0x012fff10 || (opcode&0x0ffffff0)==0x012fff30)
+            dyn->mem_pending = PEND_LD|PEND_ST;  // B / BL / BX / BLX: who knows what was done there
+        return 0;
+    }
+    if(rn==xEmu || rn==xSP || rn==xESP || rn==xPC)
+        return 0;   // private access
+    int need;
+    if(type==1)
+        need = dyn->mem_pending & ((box86_dynarec_strongmem==MEMORDER_TSO)?PEND_LD:PEND_ST);
+    else
+        need = dyn->mem_pending;
+    if(need)
+        dyn->mem_pending = 0;
+    dyn->mem_pending |= (type==1)?PEND_LD:PEND_ST;
+    return need?1:0;
+}
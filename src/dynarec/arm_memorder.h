@@ -0,0 +1,19 @@
+#ifndef _ARM_MEMORDER_H_
+#define _ARM_MEMORDER_H_
+
+typedef struct dynarec_arm_s dynarec_arm_t;
+
+// DMB ISH
+#define ARM_DMB_ISH 0xf57ff05b
+
+// memory ordering modes (BOX86_DYNAREC_STRONGMEM)
+#define MEMORDER_WEAK       0   // no barrier
+#define MEMORDER_TSO        1   // keep x86 load/load, load/store and store/store ordering
+#define MEMORDER_SELECTIVE  2   // only order stores (and loads following them)
+
+// label (jump target): nothing is known about pending accesses. jmptarget = 0 on a fall-through only label
+void arm_memorder_label(dynarec_arm_t* dyn, int jmptarget);
+// return 1 if a DMB ISH needs to be emited before the opcode
+int arm_memorder(dynarec_arm_t* dyn, uint32_t opcode);
+
+#endif //_ARM_MEMORDER_H_
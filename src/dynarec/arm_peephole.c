@@ -0,0 +1,194 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "debug.h"
+#include "x86trace.h"
+#include "dynarec_arm_private.h"
+#include "arm_peephole.h"
+
+/*
+    ARM Peephole
+
+The peephole looks at each opcode as it's emitted, and keep track of
+    - the ARM registers that contains a known constant (only set by the MOV32 pseudo instruction)
+    - the ARM registers that contains a copy of an x86emu_t field (from a LDR/STR [r0, #imm])
+So that a reload of a field still in a register, a MOV32 of a constant already there or a MOV of a reg to itself
+can be dropped (or turned into a simple MOV).
+The same filter is applied on pass 2 and 3, so sizes and offsets stay coherent. Everything is forgotten
+on every label (instruction start / epilog, MARKx) and on anything not understood here (branch, call,
+block transfert, coprocessor access...), so no branch can land where a knowledge would be wrong.
+*/
+
+#define xEmu    0
+#define xPC     15
+
+void arm_peephole_reset(dynarec_arm_t* dyn)
+{
+    dyn->peep_known = 0;
+    for(int i=0; i<16; ++i)
+        dyn->peep_emu[i] = -1;
+}
+
+static void forget_reg(dynarec_arm_t* dyn, int reg)
+{
+    if(reg==xPC) {
+        arm_peephole_reset(dyn);
+        return;
+    }
+    dyn->peep_known &= ~(1<<reg);
+    dyn->peep_emu[reg] = -1;
+    if(reg==xEmu)   // emu pointer changed, all fields are unknown now
+        for(int i=0; i<16; ++i)
+            dyn->peep_emu[i] = -1;
+}
+
+static void forget_emu(dynarec_arm_t* dyn)
+{
+    for(int i=0; i<16; ++i)
+        dyn->peep_emu[i] = -1;
+}
+
+static void forget_emu_off(dynarec_arm_t* dyn, int off)
+{
+    for(int i=0; i<16; ++i)
+        if(dyn->peep_emu[i]!=-1 && dyn->peep_emu[i]>off-4 && dyn->peep_emu[i]<off+4)
+            dyn->peep_emu[i] = -1;
+}
+
+int arm_peephole_isconst(dynarec_arm_t* dyn, int reg, uint32_t val)
+{
+    if(!box86_dynarec_peephole)
+        return 0;
+    return ((dyn->peep_known>>reg)&1) && dyn->peep_const[reg]==val;
+}
+
+void arm_peephole_setconst(dynarec_arm_t* dyn, int reg, uint32_t val)
+{
+    dyn->peep_known |= (1<<reg);
+    dyn->peep_const[reg] = val;
+}
+
+int arm_peephole(dynarec_arm_t* dyn, uint32_t* opcode)
+{
+    if(!box86_dynarec_peephole)
+        return 1;
+    uint32_t op = *opcode;
+    uint32_t cond = op>>28;
+    int rn = (op>>16)&15;
+    int rd = (op>>12)&15;
+    if(cond==0b1111) {
+        // unconditionnal space (NEON, PLD...)
+        if(((op>>25)&0b111)!=0b001)    // NEON data processing doesn't touch ARM regs or memory
+            arm_peephole_reset(dyn);
+        return 1;
+    }
+    switch((op>>25)&0b111) {
+        case 0b000:
+            if((op&0x0ff00ff0)==0x01a00000) {
+                // MOV rd, rm
+                int rm = op&15;
+                if(rd==rm && cond==0b1110)
+                    return 0;
+                if(rd==xPC || rm==xPC) {
+                    arm_peephole_reset(dyn);
+                    return 1;
+                }
+                forget_reg(dyn, rd);
+                if(cond==0b1110) {
+                    if((dyn->peep_known>>rm)&1)
+                        arm_peephole_setconst(dyn, rd, dyn->peep_const[rm]);
+                    if(rd!=xEmu)
+                        dyn->peep_emu[rd] = dyn->peep_emu[rm];
+                }
+                return 1;
+            }
+            if(((op>>4)&0b1001)==0b1001 || (((op>>23)&0b11)==0b10 && !((op>>20)&1))) {
+                // multiply, extra load/store, misc (MRS/MSR, BX, CLZ, SWP...): not tracked
+                if(((op>>4)&0b1111)==0b1001 && ((op>>24)&0b1111)==0) {
+                    // MUL / MLA / MLS / xMULL
+                    forget_reg(dyn, rn);
+                    if((op>>23)&1)
+                        forget_reg(dyn, rd);
+                    return 1;
+                }
+                arm_peephole_reset(dyn);
+                return 1;
+            }
+            // fallthrough
+        case 0b001:
+            if((op&0x0fb00000)==0x03000000) {
+                // MOVW / MOVT
+                forget_reg(dyn, rd);
+                return 1;
+            }
+            if(((op>>23)&0b11)==0b10 && ((op>>20)&1)) {
+                // TST / TEQ / CMP / CMN: only flags
+                return 1;
+            }
+            forget_reg(dyn, rd);
+            return 1;
+        case 0b010:
+        case 0b011:
+            if(((op>>25)&1) && ((op>>4)&1)) {
+                // media instructions
+                if((op&0x0f800010)==0x07000010) {
+                    // signed multiplies (SMMUL, SMUAD...) / SDIV / UDIV: Rd is in bits 16-19
+                    forget_reg(dyn, rn);
+                    if(((op>>20)&7)==0b100)
+                        forget_reg(dyn, rd);    // SMLALD / SMLSLD: RdLo
+                } else if((op&0x0ff000f0)==0x07800010) // USAD8 / USADA8: Rd is in bits 16-19
+                    forget_reg(dyn, rn);
+                else
+                    forget_reg(dyn, rd);
+                return 1;
+            }
+            {
+                int p = (op>>24)&1;
+                int b = (op>>22)&1;
+                int w = (op>>21)&1;
+                int l = (op>>20)&1;
+                int imm = !((op>>25)&1);
+                int simple = (cond==0b1110) && p && ((op>>23)&1) && !w && !b && imm && (rn==xEmu) && (rd!=xPC);
+                int off = op&0xfff;
+                if(l) {
+                    if(simple && rd!=xEmu) {
+                        for(int i=0; i<16; ++i)
+                            if(dyn->peep_emu[i]==off) {
+                                if(i==rd)
+                                    return 0;   // already there
+                                *opcode = 0xe1a00000 | (rd<<12) | i;
+                                forget_reg(dyn, rd);
+                                dyn->peep_emu[rd] = off;
+                                if((dyn->peep_known>>i)&1)
+                                    arm_peephole_setconst(dyn, rd, dyn->peep_const[i]);
+                                return 1;
+                            }
+                        forget_reg(dyn, rd);
+                        dyn->peep_emu[rd] = off;
+                        return 1;
+                    }
+                    forget_reg(dyn, rd);
+                } else {
+                    if(simple) {
+                        forget_emu_off(dyn, off);
+                        dyn->peep_emu[rd] = off;
+                        return 1;
+                    }
+                    forget_emu(dyn);
+                }
+                if(!p || w)
+                    forget_reg(dyn, rn);
+            }
+            return 1;
+        case 0b111:
+            if(((op>>24)&1)==0 && ((op>>4)&1)==0)
+                return 1;   // VFP data processing
+            // fallthrough
+        default:
+            // branch, block transfert, coprocessor transfert, svc...
+            arm_peephole_reset(dyn);
+            return 1;
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef _ARM_PEEPHOLE_H_
+#define _ARM_PEEPHOLE_H_
+
+typedef struct dynarec_arm_s dynarec_arm_t;
+
+// forget everything known about the ARM registers (to be used on every label / jump target)
+void arm_peephole_reset(dynarec_arm_t* dyn);
+// filter an opcode about to be emitted. Return 0 if the opcode can be dropped, else emit *opcode (that may have been changed)
+int arm_peephole(dynarec_arm_t* dyn, uint32_t* opcode);
+// return 1 if reg is already known to contains the 32bits value
+int arm_peephole_isconst(dynarec_arm_t* dyn, int reg, uint32_t val);
+// reg now contains the 32bits value
+void arm_peephole_setconst(dynarec_arm_t* dyn, int reg, uint32_t val);
+
+#endif //_ARM_PEEPHOLE_H_
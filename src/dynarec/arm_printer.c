@@ -78,6 +78,11 @@ const char* arm_print(uint32_t opcode)
     static __thread char ret[100];
     memset(ret, 0, sizeof(ret));
     if((opcode & (0b1111<<28))==(0b1111<<28)) {
+        if((opcode&0xfffffff0)==0xf57ff050) {
+            // DMB
+            sprintf(ret, "DMB #%d", opcode&15);
+            return ret;
+        }
         // NEON?
         if(((opcode>>24)&0b1111)==0b0100 && ((opcode>>20)&0b1001)==0b0000)
         {
@@ -420,7 +425,11 @@ const char* arm_print(uint32_t opcode)
         strcpy(ret, "?????");
     } else {
         const char* cond = conds[(opcode>>28)&15];
-        if((opcode&0b00001111111111111111111111010000)==0b00000001001011111111111100010000) {
+        if((opcode&0x0fffffff)==0x0320f001) {
+            sprintf(ret, "YIELD%s", cond);
+        } else if((opcode&0x0ff00fff)==0x0c500f1e) {
+            sprintf(ret, "MRRC%s p15, 1, %s, %s, c14", cond, regname[(opcode>>12)&15], regname[(opcode>>16)&15]);
+        } else if((opcode&0b00001111111111111111111111010000)==0b00000001001011111111111100010000) {
             int l = (opcode>>5)&1;
             sprintf(ret, "B%sX%s r%d", l?"L":"", cond, opcode&0b1111);
         } else if (((opcode>>25)&0b111)==0b101) {
@@ -452,6 +461,18 @@ const char* arm_print(uint32_t opcode)
             } else {
                 sprintf(ret, "%sMULL%s%s %s, %s, %s, %s", u?"S":"U", cond, s?"S":"", regname[rdlo], regname[rdhi], regname[rm], regname[rs]);
             }
+        } else if((opcode&0b00001111111100000000000011110000)==0b00000000011000000000000010010000) {
+            int rd = (opcode>>16)&15;
+            int ra = (opcode>>12)&15;
+            int rm = (opcode>>8)&15;
+            int rn = (opcode)&15;
+            sprintf(ret, "MLS%s %s, %s, %s, %s", cond, regname[rd], regname[rn], regname[rm], regname[ra]);
+        } else if((opcode&0b00001111110100001111000011110000)==0b00000111000100001111000000010000) {
+            int u = (opcode>>21)&1;
+            int rd = (opcode>>16)&15;
+            int rm = (opcode>>8)&15;
+            int rn = (opcode)&15;
+            sprintf(ret, "%sDIV%s %s, %s, %s", u?"U":"S", cond, regname[rd], regname[rn], regname[rm]);
         } else if((opcode&0b00001111101100000000111111110000)==0b00000001000000000000000010010000) {
             int b = (opcode>>22)&1;
             int rn = (opcode>>16)&15;
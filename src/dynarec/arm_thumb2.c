@@ -0,0 +1,643 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "arm_thumb2.h"
+
+/*
+    A32 to Thumb-2 (T32) translation
+
+Every opcode emited by the dynarec is re-encoded in T32, to see how much smaller a Thumb-2 dynarec code would be.
+    - 16bits encodings are used when the registers are low (r0-r7), offsets small enough, and the flags behave the same
+      (most 16bits data processing opcodes set the flags outside an IT block, and don't inside)
+    - conditional opcodes (other than B) are grouped in IT blocks of up to 4 opcodes (same condition or its inverse),
+      an IT block never spans a branch target
+    - B/Bcc/BL are relaxed: a 16bits B/Bcc is used when the target is close enough, the size of the block is
+      recomputed until it's stable. BL to outside of the block becomes a BLX (the helpers are A32)
+    - VFP and NEON opcodes have the same encoding in T32 (with a different prefix)
+An A32 opcode without T32 equivalent (register shifted by register, RSC, post-indexed register offset,
+negative register offset, SWP...) is counted and replaced by 2 UDF.W, as a T32 backend would need 2 opcodes there.
+*/
+
+#define T32_UDF     0xf7f0a000  // UDF.W #0
+#define LOW(r)      ((r)<8)
+
+static int t16(uint32_t* t, uint32_t v) { *t = v; return 2; }
+static int t32(uint32_t* t, uint32_t v) { *t = v; return 4; }
+
+// value of an A32 modified immediate (imm8 ror rot*2)
+static uint32_t a32_imm(uint32_t op)
+{
+    uint32_t v = op&0xff;
+    int r = ((op>>8)&15)*2;
+    return r?((v>>r)|(v<<(32-r))):v;
+}
+
+// encode v as a T32 modified immediate (i:imm3:imm8), -1 if not possible. *rot is set if it's a rotated encoding
+static int t32_imm(uint32_t v, int* rot)
+{
+    *rot = 0;
+    if(v<256)
+        return v;
+    uint32_t b = v&0xff;
+    if(v==(b|(b<<16)))
+        return 0x100|b;         // 00XY00XY
+    b = (v>>8)&0xff;
+    if(v==((b<<8)|(b<<24)))
+        return 0x200|b;         // XY00XY00
+    b = v&0xff;
+    if(v==b*0x01010101u)
+        return 0x300|b;         // XYXYXYXY
+    for(int r=8; r<32; ++r) {   // 1bcdefgh ror r
+        uint32_t x = (v<<r)|(v>>(32-r));
+        if(x>=0x80 && x<=0xff) {
+            *rot = 1;
+            return (r<<7)|(x&0x7f);
+        }
+    }
+    return -1;
+}
+
+// A32 data processing opcode => T32 one (TST/TEQ/CMP/CMN are done with Rd=PC, MOV/MVN with Rn=PC)
+static const int8_t dp_op[16] = {0, 4, 13, 14, 8, 10, 11, -1, 0, 4, 13, 8, 2, 2, 1, 3};
+// A32 data processing opcode => 16bits "Rdn = Rdn op Rm" opcode (-1 if none)
+static const int8_t dp_op16[16] = {0, 1, -1, -1, -1, 5, 6, -1, -1, -1, -1, -1, 12, -1, 14, -1};
+
+static int dataproc(uint32_t op, int in_it, uint32_t* t)
+{
+    int opc = (op>>21)&15;
+    int s = (op>>20)&1;
+    int rn = (op>>16)&15, rd = (op>>12)&15, rm = op&15;
+    int test = (opc>=8 && opc<=11);     // TST TEQ CMP CMN
+    int mov = (opc==13 || opc==15);     // MOV MVN
+    int addsub = (opc==2 || opc==4);
+    int logical = (opc<=1 || opc==8 || opc==9 || opc>=12);
+    int flags16 = (s && !in_it) || (!s && in_it);   // the 16bits forms that set the flags outside of an IT block can be used
+    if(dp_op[opc]<0)
+        return 0;
+    if(test) rd = 15;
+    if(mov) rn = 15;
+    if((!test && rd==15) || (!mov && rn==15))
+        return 0;
+    if((op>>25)&1) {
+        // immediate
+        uint32_t v = a32_imm(op);
+        int rot = (op>>8)&15;
+        if(opc==13 && flags16 && LOW(rd) && v<256 && (!s || !rot))
+            return t16(t, 0x2000|(rd<<8)|v);                    // MOV(S) Rd, #imm8
+        if(opc==10 && LOW(rn) && v<256)
+            return t16(t, 0x2800|(rn<<8)|v);                    // CMP Rn, #imm8
+        if(addsub && flags16 && LOW(rd) && LOW(rn)) {
+            if(v<8)
+                return t16(t, ((opc==4)?0x1c00:0x1e00)|(v<<6)|(rn<<3)|rd);  // ADD(S) Rd, Rn, #imm3
+            if(rd==rn && v<256)
+                return t16(t, ((opc==4)?0x3000:0x3800)|(rd<<8)|v);          // ADD(S) Rdn, #imm8
+        }
+        if(addsub && !s && rd==13 && rn==13 && !(v&3) && v<=508)
+            return t16(t, ((opc==4)?0xb000:0xb080)|(v>>2));     // ADD/SUB SP, SP, #imm7
+        if(opc==4 && !s && rn==13 && LOW(rd) && !(v&3) && v<=1020)
+            return t16(t, 0xa800|(rd<<8)|(v>>2));               // ADD Rd, SP, #imm8
+        if(opc==3 && flags16 && !v && LOW(rd) && LOW(rn))
+            return t16(t, 0x4240|(rn<<3)|rd);                   // RSB(S) Rd, Rn, #0
+        if(!test && rd==13 && !(addsub && rn==13))
+            return 0;
+        if(!mov && rn==13 && !(addsub || opc==10 || opc==11))
+            return 0;
+        int trot;
+        int enc = t32_imm(v, &trot);
+        if(enc>=0) {
+            if(s && logical && rot && !trot)
+                return 0;   // the carry would not be the same
+            return t32(t, 0xf0000000|((enc>>11)<<26)|(dp_op[opc]<<21)|(s<<20)|(rn<<16)|(((enc>>8)&7)<<12)|(rd<<8)|(enc&0xff));
+        }
+        if(addsub && !s && v<4096)
+            return t32(t, ((opc==4)?0xf2000000:0xf2a00000)|((v>>11)<<26)|(rn<<16)|(((v>>8)&7)<<12)|(rd<<8)|(v&0xff));   // ADDW / SUBW
+        if(opc==13 && !s && v<65536)
+            return t32(t, 0xf2400000|((v>>12)<<16)|(((v>>11)&1)<<26)|(((v>>8)&7)<<12)|(rd<<8)|(v&0xff));   // MOVW
+        return 0;
+    }
+    if(rm==15)
+        return 0;
+    int type = (op>>5)&3;
+    if((op>>4)&1) {
+        // register shifted by register: only MOV has a T32 equivalent
+        int rs = (op>>8)&15;
+        if(opc!=13 || rd==13 || rm==13 || rs==13 || rs==15)
+            return 0;
+        if(flags16 && rd==rm && LOW(rd) && LOW(rs)) {
+            static const int sh16[4] = {2, 3, 4, 7};
+            return t16(t, 0x4000|(sh16[type]<<6)|(rs<<3)|rd);  // LSL(S)/LSR(S)/ASR(S)/ROR(S) Rdn, Rs
+        }
+        return t32(t, 0xfa00f000|(type<<21)|(s<<20)|(rm<<16)|(rd<<8)|rs);
+    }
+    int sh = (op>>7)&31;
+    int noshift = (!type && !sh);
+    if(opc==13) {
+        if(noshift && !s)
+            return t16(t, 0x4600|((rd>>3)<<7)|(rm<<3)|(rd&7));  // MOV Rd, Rm
+        if(noshift && s && !in_it && LOW(rd) && LOW(rm))
+            return t16(t, (rm<<3)|rd);                          // MOVS Rd, Rm
+        if(!noshift && type!=3 && flags16 && LOW(rd) && LOW(rm))
+            return t16(t, (type<<11)|(sh<<6)|(rm<<3)|rd);       // LSL(S)/LSR(S)/ASR(S) Rd, Rm, #imm5
+    }
+    if(noshift) {
+        if(opc==15 && flags16 && LOW(rd) && LOW(rm))
+            return t16(t, 0x43c0|(rm<<3)|rd);                   // MVN(S) Rd, Rm
+        if(addsub && flags16 && LOW(rd) && LOW(rn) && LOW(rm))
+            return t16(t, ((opc==4)?0x1800:0x1a00)|(rm<<6)|(rn<<3)|rd);    // ADD(S)/SUB(S) Rd, Rn, Rm
+        if(opc==4 && !s && (rd==rn || rd==rm)) {
+            int other = (rd==rn)?rm:rn;
+            return t16(t, 0x4400|((rd>>3)<<7)|(other<<3)|(rd&7));          // ADD Rdn, Rm
+        }
+        if(opc==10 && LOW(rn) && LOW(rm))
+            return t16(t, 0x4280|(rm<<3)|rn);                   // CMP Rn, Rm
+        if(opc==10 && rn!=13 && rm!=13)
+            return t16(t, 0x4500|((rn>>3)<<7)|(rm<<3)|(rn&7));  // CMP Rn, Rm (high registers)
+        if(opc==11 && LOW(rn) && LOW(rm))
+            return t16(t, 0x42c0|(rm<<3)|rn);                   // CMN Rn, Rm
+        if(opc==8 && LOW(rn) && LOW(rm))
+            return t16(t, 0x4200|(rm<<3)|rn);                   // TST Rn, Rm
+        if(dp_op16[opc]>=0 && flags16 && LOW(rd) && LOW(rn) && LOW(rm)) {
+            int commutative = (opc!=6 && opc!=14);
+            if(rd==rn)
+                return t16(t, 0x4000|(dp_op16[opc]<<6)|(rm<<3)|rd);
+            if(rd==rm && commutative)
+                return t16(t, 0x4000|(dp_op16[opc]<<6)|(rn<<3)|rd);
+        }
+    }
+    if(rm==13 || (!test && rd==13 && !(addsub && rn==13)))
+        return 0;
+    if(!mov && rn==13 && !(addsub || opc==10 || opc==11))
+        return 0;
+    if(rd==13 && (type || sh>3))
+        return 0;
+    return t32(t, 0xea000000|(dp_op[opc]<<21)|(s<<20)|(rn<<16)|((sh>>2)<<12)|(rd<<8)|((sh&3)<<6)|(type<<4)|rm);
+}
+
+// load / store kinds, with their T32 encodings
+enum { LS_STR, LS_LDR, LS_STRB, LS_LDRB, LS_STRH, LS_LDRH, LS_LDRSB, LS_LDRSH };
+typedef struct ldst_s {
+    uint32_t    imm12;  // [Rn, #imm12]
+    uint32_t    imm8;   // [Rn, #-imm8], [Rn, #+/-imm8]! and [Rn], #+/-imm8 (without bit 11: [Rn, Rm, lsl #imm2])
+    uint16_t    imm5;   // 16bits [Rn, #imm5<<scale] (0 if none)
+    uint16_t    reg;    // 16bits [Rn, Rm]
+    int         scale;
+} ldst_t;
+static const ldst_t ldst[] = {
+    {0xf8c00000, 0xf8400800, 0x6000, 0x5000, 2},    // STR
+    {0xf8d00000, 0xf8500800, 0x6800, 0x5800, 2},    // LDR
+    {0xf8800000, 0xf8000800, 0x7000, 0x5400, 0},    // STRB
+    {0xf8900000, 0xf8100800, 0x7800, 0x5c00, 0},    // LDRB
+    {0xf8a00000, 0xf8200800, 0x8000, 0x5200, 1},    // STRH
+    {0xf8b00000, 0xf8300800, 0x8800, 0x5a00, 1},    // LDRH
+    {0xf9900000, 0xf9100800, 0,      0x5600, 0},    // LDRSB
+    {0xf9b00000, 0xf9300800, 0,      0x5e00, 0},    // LDRSH
+};
+
+// p, u, w are the A32 bits. off is an immediate, or Rm if reg (shifted left by shift)
+static int loadstore(int kind, int p, int u, int w, int rn, int rt, int reg, uint32_t off, int shift, uint32_t* t)
+{
+    const ldst_t* l = &ldst[kind];
+    if(rn==15 || rt==15 || (rt==13 && kind>LS_LDR))
+        return 0;
+    if((w || !p) && rn==rt)
+        return 0;
+    if(reg) {
+        if(!p || !u || w || shift>3 || off==13 || off==15)
+            return 0;
+        if(!shift && LOW(rt) && LOW(rn) && LOW(off))
+            return t16(t, l->reg|(off<<6)|(rn<<3)|rt);
+        return t32(t, (l->imm8&~0x800)|(rn<<16)|(rt<<12)|(shift<<4)|off);
+    }
+    if(p && u && !w) {
+        if(l->imm5 && LOW(rt) && LOW(rn) && !(off&((1<<l->scale)-1)) && (off>>l->scale)<32)
+            return t16(t, l->imm5|((off>>l->scale)<<6)|(rn<<3)|rt);
+        if(kind<=LS_LDR && rn==13 && LOW(rt) && !(off&3) && off<1024)
+            return t16(t, ((kind==LS_LDR)?0x9800:0x9000)|(rt<<8)|(off>>2));
+        if(off<4096)
+            return t32(t, l->imm12|(rn<<16)|(rt<<12)|off);
+        return 0;
+    }
+    if((!p && w) || off>255)
+        return 0;   // LDRT/STRT, or offset too big
+    return t32(t, l->imm8|(rn<<16)|(rt<<12)|(p<<10)|(u<<9)|((w||!p)<<8)|off);
+}
+
+// LDRH/STRH/LDRSB/LDRSH/LDRD/STRD
+static int extraloadstore(uint32_t op, uint32_t* t)
+{
+    int p = (op>>24)&1, u = (op>>23)&1, imm = (op>>22)&1, w = (op>>21)&1, l = (op>>20)&1;
+    int rn = (op>>16)&15, rt = (op>>12)&15;
+    int sh = (op>>5)&3;
+    uint32_t off = imm?(((op>>4)&0xf0)|(op&0xf)):(op&15);
+    if(sh==1)
+        return loadstore(l?LS_LDRH:LS_STRH, p, u, w, rn, rt, !imm, off, 0, t);
+    if(l)
+        return loadstore((sh==2)?LS_LDRSB:LS_LDRSH, p, u, w, rn, rt, !imm, off, 0, t);
+    // LDRD (sh==2) / STRD (sh==3): Rt2 is explicit in T32, and the offset is a multiple of 4
+    if(!imm || (off&3) || (rt&1) || rt>=12 || rn==15)
+        return 0;
+    if((w || !p) && (rn==rt || rn==rt+1))
+        return 0;
+    return t32(t, 0xe8400000|(p<<24)|(u<<23)|((w||!p)<<21)|((sh==2)<<20)|(rn<<16)|(rt<<12)|((rt+1)<<8)|(off>>2));
+}
+
+static int loadstoremultiple(uint32_t op, uint32_t* t)
+{
+    int p = (op>>24)&1, u = (op>>23)&1, w = (op>>21)&1, l = (op>>20)&1;
+    int rn = (op>>16)&15;
+    uint32_t list = op&0xffff;
+    if(((op>>22)&1) || rn==15 || !list)
+        return 0;
+    if(__builtin_popcount(list)==1) {
+        // T32 LDM/STM need 2 registers, use a LDR/STR
+        int rt = __builtin_ctz(list);
+        if(!p)
+            return loadstore(l?LS_LDR:LS_STR, !w, w?u:1, 0, rn, rt, 0, w?4:0, 0, t);
+        return loadstore(l?LS_LDR:LS_STR, 1, u, w, rn, rt, 0, 4, 0, t);
+    }
+    if((list&(1<<13)) || (!l && (list&(1<<15))) || (l && (list&0xc000)==0xc000) || (w && (list&(1<<rn))))
+        return 0;
+    if(p && !u && w && !l && rn==13 && !(list&0xbf00))
+        return t16(t, 0xb400|(((list>>14)&1)<<8)|(list&0xff));     // PUSH
+    if(!p && u && w && l && rn==13 && !(list&0x7f00))
+        return t16(t, 0xbc00|(((list>>15)&1)<<8)|(list&0xff));     // POP
+    if(!p && u && !l && w && LOW(rn) && list<256)
+        return t16(t, 0xc000|(rn<<8)|list);                         // STMIA Rn!
+    if(!p && u && l && LOW(rn) && list<256 && (w==!(list&(1<<rn))))
+        return t16(t, 0xc800|(rn<<8)|list);                         // LDMIA Rn(!)
+    if(!p && u)
+        return t32(t, (l?0xe8900000:0xe8800000)|(w<<21)|(rn<<16)|list);
+    if(p && !u)
+        return t32(t, (l?0xe9100000:0xe9000000)|(w<<21)|(rn<<16)|list);
+    return 0;   // IB / DA
+}
+
+// multiply, SWP and exclusive load/store
+static int multiply(uint32_t op, int in_it, uint32_t* t)
+{
+    int s = (op>>20)&1;
+    int r16 = (op>>16)&15, r12 = (op>>12)&15, r8 = (op>>8)&15, r0 = op&15;
+    if(((op>>24)&15)==1) {
+        if(!((op>>23)&1))
+            return 0;   // SWP / SWPB
+        if(r16==15 || r12==15 || r16==13 || r12==13)
+            return 0;
+        switch(op&0x0ff00fff) {
+            case 0x01900f9f: return t32(t, 0xe8500f00|(r16<<16)|(r12<<12));                // LDREX
+            case 0x01b00f9f: return t32(t, 0xe8d0007f|(r16<<16)|(r12<<12)|((r12+1)<<8));   // LDREXD
+            case 0x01d00f9f: return t32(t, 0xe8d00f4f|(r16<<16)|(r12<<12));                // LDREXB
+            case 0x01f00f9f: return t32(t, 0xe8d00f5f|(r16<<16)|(r12<<12));                // LDREXH
+        }
+        if(r0==15 || r0==13)
+            return 0;
+        switch(op&0x0ff00ff0) {
+            case 0x01800f90: return t32(t, 0xe8400000|(r16<<16)|(r0<<12)|(r12<<8));        // STREX
+            case 0x01a00f90: return t32(t, 0xe8c00070|(r16<<16)|(r0<<12)|((r0+1)<<8)|r12); // STREXD
+            case 0x01c00f90: return t32(t, 0xe8c00f40|(r16<<16)|(r0<<12)|r12);             // STREXB
+            case 0x01e00f90: return t32(t, 0xe8c00f50|(r16<<16)|(r0<<12)|r12);             // STREXH
+        }
+        return 0;
+    }
+    if(r16>=13 || r8>=13 || r0>=13)
+        return 0;
+    switch((op>>21)&7) {
+        case 0: // MUL Rd(16), Rn(0), Rm(8)
+            if(((s && !in_it) || (!s && in_it)) && LOW(r16) && LOW(r0) && LOW(r8) && (r16==r0 || r16==r8))
+                return t16(t, 0x4340|(((r16==r0)?r8:r0)<<3)|r16);  // MULS Rdm, Rn, Rdm
+            if(s) return 0;
+            return t32(t, 0xfb00f000|(r0<<16)|(r16<<8)|r8);
+        case 1: // MLA Rd(16), Rn(0), Rm(8), Ra(12)
+            if(s || r12>=13) return 0;
+            return t32(t, 0xfb000000|(r0<<16)|(r12<<12)|(r16<<8)|r8);
+        case 3: // MLS
+            if(s || r12>=13) return 0;
+            return t32(t, 0xfb000010|(r0<<16)|(r12<<12)|(r16<<8)|r8);
+        case 4: case 5: case 6: case 7: {
+            // UMULL UMLAL SMULL SMLAL RdLo(12), RdHi(16), Rn(0), Rm(8)
+            static const uint32_t base[4] = {0xfba00000, 0xfbe00000, 0xfb800000, 0xfbc00000};
+            if(s || r12>=13) return 0;
+            return t32(t, base[((op>>21)&7)-4]|(r0<<16)|(r12<<12)|(r16<<8)|r8);
+        }
+    }
+    return 0;
+}
+
+// BX, BLX, CLZ, MRS, MSR, SMULxy
+static int misc(uint32_t op, uint32_t* t)
+{
+    int rd = (op>>12)&15, rm = op&15;
+    if((op&0x0ffffff0)==0x012fff10 && rm!=15)
+        return t16(t, 0x4700|(rm<<3));     // BX
+    if((op&0x0ffffff0)==0x012fff30 && rm!=15)
+        return t16(t, 0x4780|(rm<<3));     // BLX
+    if((op&0x0fff0fff)==0x010f0000 && rd<13)
+        return t32(t, 0xf3ef8000|(rd<<8)); // MRS Rd, APSR
+    if((op&0x0ff3fff0)==0x0120f000 && (op&0x000c0000) && rm<13)
+        return t32(t, 0xf3808000|(rm<<16)|(((op>>18)&3)<<10));   // MSR APSR_xx, Rn
+    if(rd>=13 || rm>=13)
+        return 0;
+    if((op&0x0fff0ff0)==0x016f0f10)
+        return t32(t, 0xfab0f080|(rm<<16)|(rd<<8)|rm);    // CLZ
+    if((op&0x0ff0f090)==0x01600080) {
+        int d = (op>>16)&15, m = (op>>8)&15;
+        if(d>=13 || m>=13)
+            return 0;
+        return t32(t, 0xfb10f000|(rm<<16)|(d<<8)|(((op>>5)&1)<<5)|(((op>>6)&1)<<4)|m);   // SMULxy
+    }
+    return 0;
+}
+
+// extend, reverse, bit fields, saturate, divide...
+static int media(uint32_t op, uint32_t* t)
+{
+    int r16 = (op>>16)&15, rd = (op>>12)&15, r8 = (op>>8)&15, rm = op&15;
+    if((op&0x0f8003f0)==0x06800070) {
+        // SXTB SXTH UXTB UXTH (and SXTAB... when Rn!=PC)
+        static const int8_t op32[8] = {-1, -1, 4, 0, -1, -1, 5, 1};
+        static const int8_t op16[8] = {-1, -1, 1, 0, -1, -1, 3, 2};
+        int o = (op>>20)&7, rot = (op>>10)&3;
+        if(op32[o]<0 || rd>=13 || rm>=13 || r16==13)
+            return 0;
+        if(r16==15 && !rot && LOW(rd) && LOW(rm))
+            return t16(t, 0xb200|(op16[o]<<6)|(rm<<3)|rd);
+        return t32(t, 0xfa00f080|(op32[o]<<20)|(r16<<16)|(rd<<8)|(rot<<4)|rm);
+    }
+    if((op&0x0fd0f0f0)==0x0710f010 || (op&0x0ff0f0d0)==0x0750f010 || (op&0x0ff0f0f0)==0x0780f010) {
+        // SDIV / UDIV, SMMUL(R), USAD8: Rd is on bits 16-19, Rn on 0-3, Rm on 8-11
+        if(r16>=13 || r8>=13 || rm>=13)
+            return 0;
+        if(((op>>22)&1)==0 && ((op>>20)&1))
+            return t32(t, (((op>>21)&1)?0xfbb0f0f0:0xfb90f0f0)|(rm<<16)|(r16<<8)|r8);
+        if(((op>>20)&0xff)==0x75)
+            return t32(t, 0xfb50f000|(rm<<16)|(r16<<8)|(((op>>5)&1)<<4)|r8);
+        return t32(t, 0xfb70f000|(rm<<16)|(r16<<8)|r8);
+    }
+    int lsb = (op>>7)&31;
+    if((op&0x0fe00070)==0x07c00010 && rd<13 && rm!=13)     // BFI / BFC (Rn=PC)
+        return t32(t, 0xf3600000|(rm<<16)|((lsb>>2)<<12)|(rd<<8)|((lsb&3)<<6)|((op>>16)&31));
+    if(rd>=13 || rm>=13)
+        return 0;
+    switch(op&0x0fff0ff0) {
+        case 0x06bf0f30:    // REV
+            if(LOW(rd) && LOW(rm)) return t16(t, 0xba00|(rm<<3)|rd);
+            return t32(t, 0xfa90f080|(rm<<16)|(rd<<8)|rm);
+        case 0x06bf0fb0:    // REV16
+            if(LOW(rd) && LOW(rm)) return t16(t, 0xba40|(rm<<3)|rd);
+            return t32(t, 0xfa90f090|(rm<<16)|(rd<<8)|rm);
+        case 0x06ff0fb0:    // REVSH
+            if(LOW(rd) && LOW(rm)) return t16(t, 0xbac0|(rm<<3)|rd);
+            return t32(t, 0xfa90f0b0|(rm<<16)|(rd<<8)|rm);
+        case 0x06ff0f30:    // RBIT
+            return t32(t, 0xfa90f0a0|(rm<<16)|(rd<<8)|rm);
+    }
+    if((op&0x0fa00070)==0x07a00050)     // SBFX / UBFX
+        return t32(t, (((op>>22)&1)?0xf3c00000:0xf3400000)|(rm<<16)|((lsb>>2)<<12)|(rd<<8)|((lsb&3)<<6)|((op>>16)&31));
+    if((op&0x0fa00030)==0x06a00010) {   // SSAT / USAT
+        int sh = (op>>6)&1;
+        if(sh && !lsb)
+            return 0;   // ASR #32, T32 would be SSAT16
+        return t32(t, (((op>>22)&1)?0xf3800000:0xf3000000)|(sh<<21)|(rm<<16)|((lsb>>2)<<12)|(rd<<8)|((lsb&3)<<6)|((op>>16)&31));
+    }
+    return 0;
+}
+
+// opcodes with the 0b1111 condition: NEON, barriers, PLD
+static int unconditional(uint32_t op, uint32_t* t)
+{
+    if((op&0xfe000000)==0xf2000000)     // NEON data processing
+        return t32(t, 0xef000000|(((op>>24)&1)<<28)|(op&0x00ffffff));
+    if((op&0xff100000)==0xf4000000)     // NEON element / structure load / store
+        return t32(t, 0xf9000000|(op&0x00ffffff));
+    if((op&0xffffff00)==0xf57ff000) {
+        if(((op>>4)&15)==1)
+            return t32(t, 0xf3bf8f2f);  // CLREX
+        return t32(t, 0xf3bf8f00|(op&0xff));   // DSB DMB ISB
+    }
+    int rn = (op>>16)&15, rm = op&15;
+    if((op&0xfff0f000)==0xf5d0f000 && rn!=15)   // PLD [Rn, #imm12]
+        return t32(t, 0xf890f000|(rn<<16)|(op&0xfff));
+    if((op&0xfff0f000)==0xf550f000 && rn!=15 && (op&0xfff)<256)  // PLD [Rn, #-imm8]
+        return t32(t, 0xf810fc00|(rn<<16)|(op&0xff));
+    if((op&0xfff0fe70)==0xf7d0f000 && ((op>>7)&31)<4 && rm<13)  // PLD [Rn, Rm, lsl #imm2]
+        return t32(t, 0xf810f000|(rn<<16)|(((op>>7)&3)<<4)|rm);
+    return 0;
+}
+
+int arm_to_thumb2(uint32_t op, int in_it, uint32_t* t)
+{
+    if((op>>28)==0xf)
+        return unconditional(op, t);
+    switch((op>>25)&7) {
+        case 0:
+            if((op&0x90)==0x90) {
+                if(!(op&0x60))
+                    return multiply(op, in_it, t);
+                return extraloadstore(op, t);
+            }
+            if((op&0x01900000)==0x01000000)
+                return misc(op, t);
+            return dataproc(op, in_it, t);
+        case 1:
+            if((op&0x0fb00000)==0x03000000) {
+                // MOVW / MOVT
+                int rd = (op>>12)&15;
+                uint32_t v = ((op>>4)&0xf000)|(op&0xfff);
+                if(rd>=13)
+                    return 0;
+                if(!((op>>22)&1) && in_it && LOW(rd) && v<256)
+                    return t16(t, 0x2000|(rd<<8)|v);
+                return t32(t, (((op>>22)&1)?0xf2c00000:0xf2400000)|((v>>12)<<16)|(((v>>11)&1)<<26)|(((v>>8)&7)<<12)|(rd<<8)|(v&0xff));
+            }
+            if((op&0x0fb00000)==0x03200000) {
+                if(op&0x000f0000)
+                    return 0;   // MSR #imm
+                if((op&0xff)==0)
+                    return t16(t, 0xbf00);  // NOP
+                if((op&0xff)==1)
+                    return t16(t, 0xbf10);  // YIELD
+                return 0;
+            }
+            return dataproc(op, in_it, t);
+        case 2:
+        case 3:
+            if(((op>>25)&1) && ((op>>4)&1))
+                return media(op, t);
+            else {
+                int kind = (((op>>22)&1)?LS_STRB:LS_STR) + ((op>>20)&1);
+                int reg = (op>>25)&1;
+                if(reg && ((op>>5)&3))
+                    return 0;   // only LSL for the register offset
+                return loadstore(kind, (op>>24)&1, (op>>23)&1, (op>>21)&1, (op>>16)&15, (op>>12)&15, reg, reg?(op&15):(op&0xfff), reg?((op>>7)&31):0, t);
+            }
+        case 4:
+            return loadstoremultiple(op, t);
+        case 6:
+            if((op&0x0fe00000)!=0x0c400000 && ((op>>16)&15)==15)
+                return 0;   // PC relative VLDR / VSTR
+            // fallthrough
+        case 7:
+            if(((op>>24)&15)==15)
+                return 0;   // SVC
+            return t32(t, 0xe0000000|(op&0x0fffffff));  // VFP / coprocessor: same encoding, with 0b1110 prefix
+    }
+    return 0;   // B / BL are done with the whole block
+}
+
+static int is_branch(uint32_t op)
+{
+    return (op>>28)!=0xf && ((op>>25)&7)==5;
+}
+
+// opcode that writes PC (must be the last one of an IT block)
+static int writes_pc(uint32_t op)
+{
+    return is_branch(op) || (op&0x0fffffd0)==0x012fff10 || (((op>>25)&7)==4 && ((op>>20)&1) && (op&0x8000));
+}
+
+// size of a B/Bcc/BL of off bytes (from the T32 PC), 0 if out of range
+static int branch_size(int cond, int link, int32_t off)
+{
+    if(link)
+        return (off>=-(1<<24) && off<(1<<24))?4:0;
+    if(cond==0xe) {
+        if(off>=-2048 && off<=2046)
+            return 2;
+        return (off>=-(1<<24) && off<(1<<24))?4:0;
+    }
+    if(off>=-256 && off<=254)
+        return 2;
+    return (off>=-(1<<20) && off<(1<<20))?4:0;
+}
+
+static int branch_encode(int cond, int link, int blx, int32_t off, int size, uint32_t* t)
+{
+    uint32_t s = (off<0)?1:0;
+    if(size==2) {
+        if(cond==0xe)
+            return t16(t, 0xe000|((off>>1)&0x7ff));
+        return t16(t, 0xd000|(cond<<8)|((off>>1)&0xff));
+    }
+    if(!link && cond!=0xe) {
+        uint32_t j1 = (off>>18)&1, j2 = (off>>19)&1;
+        return t32(t, 0xf0008000|(s<<26)|(cond<<22)|(((off>>12)&0x3f)<<16)|(j1<<13)|(j2<<11)|((off>>1)&0x7ff));
+    }
+    uint32_t j1 = (!((off>>23)&1))^s, j2 = (!((off>>22)&1))^s;
+    uint32_t v = 0xf0000000|(s<<26)|(((off>>12)&0x3ff)<<16)|(j1<<13)|(j2<<11);
+    if(blx)
+        return t32(t, v|0xc000|((off>>1)&0x7fe));
+    return t32(t, v|(link?0xd000:0x9000)|((off>>1)&0x7ff));
+}
+
+int arm_thumb2_block(const uint32_t* code, int n, uintptr_t addr, uint16_t* out, int* untranslated)
+{
+    uint8_t* target = (uint8_t*)calloc(n, 1);   // opcode is a branch target
+    uint8_t* itlen = (uint8_t*)calloc(n, 1);    // number of opcodes in the IT block starting on this opcode
+    uint8_t* inside = (uint8_t*)calloc(n, 1);   // opcode is in an IT block
+    uint8_t* size = (uint8_t*)calloc(n, 1);     // T32 size of the opcode (without the IT)
+    uint32_t* t = (uint32_t*)calloc(n, sizeof(uint32_t));
+    int32_t* pos = (int32_t*)calloc(n+1, sizeof(int32_t));
+    int32_t* dest = (int32_t*)calloc(n, sizeof(int32_t));  // index of the branch target, -1 if outside
+    *untranslated = 0;
+    for(int i=0; i<n; ++i)
+        if(is_branch(code[i])) {
+            int32_t off = ((int32_t)(code[i]<<8))>>6;
+            int64_t j = ((int64_t)i*4+8+off)/4;
+            dest[i] = (j>=0 && j<n && !((i*4+8+off)&3))?j:-1;
+            if(dest[i]>=0)
+                target[dest[i]] = 1;
+        }
+    // IT blocks
+    int itstart = -1, itcount = 0, itcond = 0;
+    for(int i=0; i<n; ++i) {
+        int cond = code[i]>>28;
+        int link = is_branch(code[i]) && ((code[i]>>24)&1);
+        if(itcount && (target[i] || itcount==4 || cond>=0xe || (cond>>1)!=(itcond>>1) || (is_branch(code[i]) && !link)))
+            itcount = 0;
+        if(cond<0xe && (!is_branch(code[i]) || link)) {
+            if(!itcount) {
+                itstart = i;
+                itcond = cond;
+            }
+            itlen[itstart] = ++itcount;
+            inside[i] = 1;
+            if(writes_pc(code[i]))
+                itcount = 0;
+        }
+    }
+    // non branch opcodes
+    for(int i=0; i<n; ++i)
+        if(!is_branch(code[i])) {
+            size[i] = arm_to_thumb2(code[i], inside[i], &t[i]);
+            if(!size[i]) {
+                size[i] = 8;
+                ++*untranslated;
+            }
+        } else
+            size[i] = (((code[i]>>24)&1) || dest[i]<0)?4:2;
+    // place everything, growing the branches until it's stable
+    int changed;
+    do {
+        int32_t p = 0;
+        for(int i=0; i<n; ++i) {
+            pos[i] = p;
+            p += (itlen[i]?2:0) + size[i];
+        }
+        pos[n] = p;
+        changed = 0;
+        for(int i=0; i<n; ++i)
+            if(is_branch(code[i]) && dest[i]>=0 && size[i]<8) {
+                int32_t pc = pos[i] + (itlen[i]?2:0) + 4;
+                int sz = branch_size(code[i]>>28, (code[i]>>24)&1, pos[dest[i]]-pc);
+                if(!sz)
+                    sz = 8;
+                if(sz>size[i]) {
+                    size[i] = sz;
+                    changed = 1;
+                }
+            }
+    } while(changed);
+    // emit
+    uint16_t* o = out;
+    for(int i=0; i<n; ++i) {
+        if(itlen[i]) {
+            int first = code[i]>>28;
+            uint32_t mask = 1<<(4-itlen[i]);
+            for(int k=1; k<itlen[i]; ++k)
+                mask |= ((code[i+k]>>28)&1)<<(4-k);
+            *o++ = 0xbf00|(first<<4)|mask;
+        }
+        uint32_t op = t[i];
+        int sz = size[i];
+        if(is_branch(code[i])) {
+            int cond = inside[i]?0xe:(code[i]>>28);
+            int link = (code[i]>>24)&1;
+            int32_t pc = pos[i] + (itlen[i]?2:0) + 4;
+            int32_t off;
+            if(dest[i]>=0)
+                off = pos[dest[i]] - pc;
+            else {
+                // outside of the block: same absolute target, a BL becomes a BLX as the helpers are A32
+                int64_t a32target = (int64_t)addr + i*4 + 8 + (((int32_t)(code[i]<<8))>>6);
+                off = (int32_t)(a32target - (link?((addr+pc)&~3):(addr+pc)));
+                if(!branch_size(cond, link, off))
+                    sz = 8;
+            }
+            if(sz==8) {
+                ++*untranslated;
+                size[i] = 8;
+            } else
+                branch_encode(cond, link, link && dest[i]<0, off, sz, &op);
+        }
+        if(sz==8) {
+            *o++ = T32_UDF>>16; *o++ = T32_UDF&0xffff;
+            *o++ = T32_UDF>>16; *o++ = T32_UDF&0xffff;
+        } else if(sz==4) {
+            *o++ = op>>16;
+            *o++ = op&0xffff;
+        } else
+            *o++ = op;
+    }
+    free(target); free(itlen); free(inside); free(size); free(t); free(pos); free(dest);
+    return (int)((o-out)*2);
+}
@@ -0,0 +1,14 @@
+#ifndef _ARM_THUMB2_H_
+#define _ARM_THUMB2_H_
+
+#include <stdint.h>
+
+// translate one A32 opcode (not a B/BL) to T32 in *t (a 32bits T32 opcode has its first halfword in the high 16 bits)
+// in_it is 1 if the opcode is inside an IT block (its condition is then ignored)
+// return the T32 size in bytes (2 or 4), 0 if there is no single T32 equivalent
+int arm_to_thumb2(uint32_t op, int in_it, uint32_t* t);
+// translate a block of n A32 opcodes, that would be placed at addr, to T32 in out (must have room for 5*n halfwords)
+// return the size in bytes of the T32 code, *untranslated is the number of A32 opcodes without T32 equivalent
+int arm_thumb2_block(const uint32_t* code, int n, uintptr_t addr, uint16_t* out, int* untranslated);
+
+#endif //_ARM_THUMB2_H_
@@ -0,0 +1,253 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
+#include <pthread.h>
+
+#include "debug.h"
+#include "box86context.h"
+#include "x86trace.h"
+#include "dynablock.h"
+#include "dynablock_private.h"
+#include "dynarec_arm.h"
+#include "dynarec_arm_private.h"
+#include "arm_unaligned.h"
+
+/*
+    ARM Unaligned accesses
+
+LDRD/STRD and VLDR/VSTR need word aligned addresses on ARMv7, and fault (SIGBUS) if not.
+x86 code does unaligned accesses from time to time (packed structs, movq on unaligned buffers...)
+So, instead of using slow code everywhere:
+    - the SIGBUS handler find the dynablock and x86 instruction from the faulting ARM address,
+      emulates the access, and flags the x86 instruction (and the block for a rebuild)
+    - the next time the block is fetched, it's translated again, and the flagged instructions
+      get their LDRD/STRD/VLDR/VSTR (on x86 memory) rewritten with unaligned safe opcodes at emit time:
+      LDR/STR pairs for LDRD/STRD, VLD1/VST1 (with no alignment) for VLDR/VSTR
+Any other SIGBUS goes to the action that was installed before, or to the one the x86 program installed
+after (signals.c routes SIGBUS sigaction / signal here while the handler is installed).
+*/
+
+#define xEmu    0
+#define xSP     13
+#define xPC     15
+
+// encode an LDR/STR (immediate, offset) with a signed offset
+static uint32_t ldrstr(int load, int rt, int rn, int off)
+{
+    return 0xe5000000 | ((off<0)?0:1)<<23 | (load?1:0)<<20 | (rn<<16) | (rt<<12) | ((off<0)?-off:off);
+}
+
+// encode an ADD/SUB rn, rn, #off (off is a multiple of 4, below 1024)
+static uint32_t addsub(int rn, int off)
+{
+    uint32_t op = (off<0)?0xe2400000:0xe2800000;
+    if(off<0) off = -off;
+    uint32_t imm = (off<256)?off:((15<<8) | (off>>2));  // rotate right by 30 is a shift left by 2
+    return op | (rn<<16) | (rn<<12) | imm;
+}
+
+int arm_unaligned(dynarec_arm_t* dyn, int ninst, uint32_t op, uint32_t* ops)
+{
+    ops[0] = op;
+    if(!dyn->insts || !dyn->insts[ninst].unaligned)
+        return 1;
+    if((op>>28)!=0b1110)
+        return 1;
+    int rn = (op>>16)&15;
+    int rt = (op>>12)&15;
+    if(rn==xEmu || rn==xSP || rn==xPC)
+        return 1;   // emu and ARM stack are always aligned
+    int u = (op>>23)&1;
+    // LDRD / STRD, immediate offset, no writeback
+    if((op&0x0f7000f0)==0x014000d0 || (op&0x0f7000f0)==0x014000f0) {
+        int load = ((op>>5)&1)==0;
+        int off = ((op>>4)&0xf0) | (op&0x0f);
+        if(!u) off = -off;
+        if(load && rt==rn) {
+            ops[0] = ldrstr(1, rt+1, rn, off+4);
+            ops[1] = ldrstr(1, rt, rn, off);
+        } else {
+            ops[0] = ldrstr(load, rt, rn, off);
+            ops[1] = ldrstr(load, rt+1, rn, off+4);
+        }
+        return 2;
+    }
+    // VLDR / VSTR
+    if((op&0x0f200e00)==0x0d000a00) {
+        int load = (op>>20)&1;
+        int off = (op&0xff)*4;
+        if(!u) off = -off;
+        int d = (op>>22)&1;
+        uint32_t vop;
+        if((op>>8)&1) {
+            // 64bits: VLD1.8 {Dd}, [rn] / VST1.8 {Dd}, [rn]
+            vop = (load?0xf4200700:0xf4000700) | (d<<22) | (rn<<16) | (rt<<12) | 0xf;
+        } else {
+            // 32bits: VLD1.32 {Dd[x]}, [rn] / VST1.32 {Dd[x]}, [rn]
+            int s = (rt<<1) | d;
+            int dd = s>>1;
+            vop = (load?0xf4a00800:0xf4800800) | (((dd>>4)&1)<<22) | (rn<<16) | ((dd&15)<<12) | ((s&1)<<7) | 0xf;
+        }
+        if(!off) {
+            ops[0] = vop;
+            return 1;
+        }
+        ops[0] = addsub(rn, off);
+        ops[1] = vop;
+        ops[2] = addsub(rn, -off);
+        return 3;
+    }
+    return 1;
+}
+
+// find the VFP registers saved in the signal frame
+static uint64_t* get_vfpregs(ucontext_t* uc)
+{
+    uint32_t* p = (uint32_t*)uc->uc_regspace;
+    uint32_t* end = p + sizeof(uc->uc_regspace)/sizeof(uint32_t);
+    while(p<end && p[0]) {
+        if(p[0]==0x56465001)    // VFP_MAGIC
+            return (uint64_t*)(p+2);
+        if(!p[1])
+            break;
+        p += p[1]/4;
+    }
+    return NULL;
+}
+
+// emulate the faulting LDRD/STRD/VLDR/VSTR. Return 0 if it's not one of those
+static int emulate_access(ucontext_t* uc, uint32_t op)
+{
+    uint32_t* regs = (uint32_t*)&uc->uc_mcontext.arm_r0;
+    if((op>>28)!=0b1110)
+        return 0;
+    int rn = (op>>16)&15;
+    int rt = (op>>12)&15;
+    int u = (op>>23)&1;
+    if((op&0x0e1000d0)==0x000000d0) {
+        // LDRD / STRD
+        int p = (op>>24)&1;
+        int w = (op>>21)&1;
+        uint32_t off = ((op>>22)&1)?(((op>>4)&0xf0) | (op&0x0f)):regs[op&15];
+        uint32_t base = regs[rn];
+        uint32_t updated = u?(base+off):(base-off);
+        uint8_t* addr = (uint8_t*)(p?updated:base);
+        if((op>>5)&1) {
+            memcpy(addr, &regs[rt], 4);
+            memcpy(addr+4, &regs[rt+1], 4);
+        } else {
+            memcpy(&regs[rt], addr, 4);
+            memcpy(&regs[rt+1], addr+4, 4);
+        }
+        if(!p || w)
+            regs[rn] = updated;
+        return 1;
+    }
+    if((op&0x0f200e00)==0x0d000a00) {
+        // VLDR / VSTR
+        uint64_t* vfp = get_vfpregs(uc);
+        if(!vfp)
+            return 0;
+        int load = (op>>20)&1;
+        uint32_t off = (op&0xff)*4;
+        uint8_t* addr = (uint8_t*)(u?(regs[rn]+off):(regs[rn]-off));
+        int d = (op>>22)&1;
+        void* reg;
+        int sz;
+        if((op>>8)&1) {
+            reg = &vfp[(d<<4) | rt];
+            sz = 8;
+        } else {
+            int s = (rt<<1) | d;
+            reg = ((uint32_t*)&vfp[s>>1]) + (s&1);
+            sz = 4;
+        }
+        if(load)
+            memcpy(reg, addr, sz);
+        else
+            memcpy(addr, reg, sz);
+        return 1;
+    }
+    return 0;
+}
+
+static box86context_t* unaligned_context = NULL;
+static struct sigaction chained_sigbus;     // the SIGBUS action to use for faults not from the dynarec
+
+static void chain_sigbus(int sig, siginfo_t* info, void* ucntx)
+{
+    if(chained_sigbus.sa_handler==SIG_DFL || chained_sigbus.sa_handler==SIG_IGN) {
+        // default action (a synchronous SIGBUS cannot be ignored): fault again without handler
+        signal(SIGBUS, SIG_DFL);
+        return;
+    }
+    if(chained_sigbus.sa_flags&SA_SIGINFO)
+        chained_sigbus.sa_sigaction(sig, info, ucntx);
+    else
+        chained_sigbus.sa_handler(sig);
+}
+
+static void arm_sigbus(int sig, siginfo_t* info, void* ucntx)
+{
+    ucontext_t* uc = (ucontext_t*)ucntx;
+    uintptr_t pc = uc->uc_mcontext.arm_pc;
+    uintptr_t start = 0;
+    dynablock_t* db = FindDynablockFromNativeAddress(unaligned_context, pc, &start);
+    if(!db || !emulate_access(uc, *(uint32_t*)pc)) {
+        // not from the dynarec, nothing that can be done here
+        chain_sigbus(sig, info, ucntx);
+        return;
+    }
+    uc->uc_mcontext.arm_pc += 4;
+    // find the x86 instruction (a rebuilt block is a new dynablock, so db is never refilled under our feet)
+    if(start!=(uintptr_t)db->block || !db->instsize)
+        return;
+    uintptr_t x86 = db->x86addr;
+    uintptr_t arm = start;
+    for(int i=0; i<db->ninst; ++i) {
+        uintptr_t next = arm + (db->instsize[i]>>8);
+        if(pc<next) {
+            for(int j=0; j<4; ++j) {
+                if(db->unaligned[j]==x86)
+                    return;
+                if(__sync_bool_compare_and_swap(&db->unaligned[j], 0, x86)) {
+                    db->rebuild = 1;
+                    return;
+                }
+            }
+            return; // no more room, keep on emulating
+        }
+        arm = next;
+        x86 += db->instsize[i]&0xff;
+    }
+}
+
+void InstallUnalignedHandler(box86context_t* context)
+{
+    unaligned_context = context;
+    struct sigaction action = {0};
+    action.sa_sigaction = arm_sigbus;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGBUS, &action, &chained_sigbus);
+}
+
+int UnalignedSigaction(const struct sigaction* act, struct sigaction* oldact)
+{
+    if(!unaligned_context)
+        return 0;
+    // SIGBUS is blocked while the chained action is half written
+    sigset_t bus, old;
+    sigemptyset(&bus);
+    sigaddset(&bus, SIGBUS);
+    pthread_sigmask(SIG_BLOCK, &bus, &old);
+    if(oldact)
+        *oldact = chained_sigbus;
+    if(act)
+        chained_sigbus = *act;
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return 1;
+}
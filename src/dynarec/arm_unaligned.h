@@ -0,0 +1,9 @@
+#ifndef _ARM_UNALIGNED_H_
+#define _ARM_UNALIGNED_H_
+
+typedef struct dynarec_arm_s dynarec_arm_t;
+
+// rewrite opcode in ops if current instruction is flagged for unaligned accesses. Return the number of opcodes in ops (at most 3)
+int arm_unaligned(dynarec_arm_t* dyn, int ninst, uint32_t opcode, uint32_t* ops);
+
+#endif //_ARM_UNALIGNED_H_
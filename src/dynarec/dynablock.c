@@ -28,6 +28,44 @@
 
 KHASH_MAP_INIT_INT(dynablocks, dynablock_t*)
 
+// the direct map is a directory of leaves of DIRECT_LEAF entries, a leaf is only allocated when a block is put in it
+#define DIRECT_SHIFT    10
+#define DIRECT_LEAF     (1<<DIRECT_SHIFT)
+#define DIRECT_MASK     (DIRECT_LEAF-1)
+
+static dynablock_t*** NewDirect(int textsz)
+{
+    return (dynablock_t***)calloc((textsz+DIRECT_MASK)>>DIRECT_SHIFT, sizeof(dynablock_t**));
+}
+
+static inline int isInDirect(dynablocklist_t* dynablocks, uintptr_t addr)
+{
+    return dynablocks->direct && (addr>=dynablocks->text) && (addr<(dynablocks->text+dynablocks->textsz));
+}
+
+// can be used without lock: leaves are never freed while the list is alive
+static inline dynablock_t* getDirect(dynablocklist_t* dynablocks, uintptr_t addr)
+{
+    if(!isInDirect(dynablocks, addr))
+        return NULL;
+    uintptr_t idx = addr-dynablocks->text;
+    dynablock_t** leaf = dynablocks->direct[idx>>DIRECT_SHIFT];
+    return leaf?leaf[idx&DIRECT_MASK]:NULL;
+}
+
+// get the direct map entry for addr, allocating the leaf if needed (write lock must be held)
+static dynablock_t** setDirect(dynablock_t*** direct, int* leaves, uintptr_t idx)
+{
+    dynablock_t** leaf = direct[idx>>DIRECT_SHIFT];
+    if(!leaf) {
+        leaf = (dynablock_t**)calloc(DIRECT_LEAF, sizeof(dynablock_t*));
+        __sync_synchronize();   // leaf must be seen cleared before being seen in the directory
+        direct[idx>>DIRECT_SHIFT] = leaf;
+        ++*leaves;
+    }
+    return &leaf[idx&DIRECT_MASK];
+}
+
 
 dynablocklist_t* NewDynablockList(uintptr_t base, uintptr_t text, int textsz, int nolinker, int direct)
 {
@@ -39,7 +77,7 @@ dynablocklist_t* NewDynablockList(uintptr_t base, uintptr_t text, int textsz, in
     ret->nolinker = nolinker;
     pthread_rwlock_init(&ret->rwlock_blocks, NULL);
     if(direct && textsz)
-        ret->direct = (dynablock_t**)calloc(textsz, sizeof(dynablock_t*));
+        ret->direct = NewDirect(textsz);
 
     return ret;
 }
@@ -47,10 +85,13 @@ dynablocklist_t* NewDynablockList(uintptr_t base, uintptr_t text, int textsz, in
 void FreeDynablock(dynablock_t* db, int nolinker)
 {
     if(db) {
-        free(db->table);
-        free(db);
         if(nolinker)
             munmap(db->block, db->size);
+        else if(db->block)
+            RemoveDynarecOwner((uintptr_t)db->block, db);  // signal handlers must not find it anymore
+        free(db->table);
+        free(db->instsize);
+        free(db);
     }
 }
 
@@ -61,16 +102,26 @@ void FreeDynablockList(dynablocklist_t** dynablocks)
     if(!*dynablocks)
         return;
     int nolinker = (*dynablocks)->nolinker;
-    dynarec_log(LOG_INFO, "Free %d Blocks from Dynablocklist (with %d buckets, nolinker=%d) %s\n", kh_size((*dynablocks)->blocks), kh_n_buckets((*dynablocks)->blocks), (*dynablocks)->nolinker, ((*dynablocks)->direct)?" With Direct mapping enabled":"");
+    int ndir = ((*dynablocks)->textsz+DIRECT_MASK)>>DIRECT_SHIFT;
+    dynarec_log(LOG_INFO, "Free %d Blocks from Dynablocklist (with %d buckets, nolinker=%d)", kh_size((*dynablocks)->blocks), kh_n_buckets((*dynablocks)->blocks), (*dynablocks)->nolinker);
+    if((*dynablocks)->direct)
+        dynarec_log(LOG_INFO, " With Direct mapping enabled (%d/%d leaves, %d KB used instead of %d KB)", 
+            (*dynablocks)->directleaves, ndir, 
+            (int)((ndir*sizeof(dynablock_t**) + (*dynablocks)->directleaves*DIRECT_LEAF*sizeof(dynablock_t*))/1024),
+            (int)(((*dynablocks)->textsz*sizeof(dynablock_t*))/1024));
+    dynarec_log(LOG_INFO, "\n");
     dynablock_t* db;
     kh_foreach_value((*dynablocks)->blocks, db, 
         FreeDynablock(db, nolinker);
     );
     kh_destroy(dynablocks, (*dynablocks)->blocks);
     if((*dynablocks)->direct) {
-        for (int i=0; i<(*dynablocks)->textsz; ++i) {
-            FreeDynablock((*dynablocks)->direct[i], nolinker);
-        }
+        for (int i=0; i<ndir; ++i)
+            if((*dynablocks)->direct[i]) {
+                for (int j=0; j<DIRECT_LEAF; ++j)
+                    FreeDynablock((*dynablocks)->direct[i][j], nolinker);
+                free((*dynablocks)->direct[i]);
+            }
         free((*dynablocks)->direct);
     }
     (*dynablocks)->direct = 0;
@@ -104,11 +155,18 @@ void FreeDirectDynablock(dynablocklist_t* dynablocks, uintptr_t addr, uintptr_t
     if(end>enddb)
         end = enddb;
     if(end>startdb && start<enddb)
-        for(uintptr_t i = start; i<end; ++i)
-            if(dynablocks->direct[i-startdb]) {
-                FreeDynablock(dynablocks->direct[i-startdb], dynablocks->nolinker);
-                dynablocks->direct[i-startdb] = NULL;
+        for(uintptr_t i = start; i<end; ++i) {
+            dynablock_t** leaf = dynablocks->direct[(i-startdb)>>DIRECT_SHIFT];
+            if(!leaf) {
+                // empty leaf, skip to the next one
+                i = startdb + ((((i-startdb)>>DIRECT_SHIFT)+1)<<DIRECT_SHIFT) - 1;
+                continue;
             }
+            if(leaf[(i-startdb)&DIRECT_MASK]) {
+                FreeDynablock(leaf[(i-startdb)&DIRECT_MASK], dynablocks->nolinker);
+                leaf[(i-startdb)&DIRECT_MASK] = NULL;
+            }
+        }
 }
 
 
@@ -117,7 +175,7 @@ void ConvertHash2Direct(dynablocklist_t* dynablocks)
     if(dynablocks->textsz==0 || dynablocks->text==0)
         return; // nothing to do
     // create the new set
-    dynablock_t **direct = (dynablock_t**)calloc(dynablocks->textsz, sizeof(dynablock_t*));
+    dynablock_t ***direct = NewDirect(dynablocks->textsz);
     kh_dynablocks_t *blocks = kh_init(dynablocks);
     // transfert
     int ret;
@@ -128,7 +186,7 @@ void ConvertHash2Direct(dynablocklist_t* dynablocks)
     uintptr_t end = dynablocks->text + dynablocks->textsz-dynablocks->base;
     kh_foreach(dynablocks->blocks, key, db,
         if(key>=start && key<end)
-            direct[key-start] = db;
+            *setDirect(direct, &dynablocks->directleaves, key-start) = db;
         else {
             k = kh_put(dynablocks, blocks, key, &ret);
             if(ret) {   // don't try to insert if already done...
@@ -139,6 +197,7 @@ void ConvertHash2Direct(dynablocklist_t* dynablocks)
     // destroy old and do the swap (should swap before destroy, but hash access is always behind mutex)
     kh_destroy(dynablocks, dynablocks->blocks);
     dynablocks->blocks = blocks;
+    __sync_synchronize();   // direct is read without lock
     dynablocks->direct = direct;
 }
 
@@ -147,18 +206,16 @@ void ConvertHash2Direct(dynablocklist_t* dynablocks)
     return NULL if block is not found / cannot be created. 
     Don't create if create==0
 */
-dynablock_t* DBGetBlock(x86emu_t* emu, uintptr_t addr, int create, dynablock_t* current)
+static dynablock_t* internalDBGetBlock(x86emu_t* emu, uintptr_t addr, int create, dynablock_t* current)
 {
     // try the quickest way first: get parent of current and check if ok!
     dynablocklist_t *dynablocks = NULL;
     dynablock_t* block = NULL;
     if(current) {
         dynablocks = current->parent;    
-        if(dynablocks->direct && (addr>=dynablocks->text) && (addr<=(dynablocks->text+dynablocks->textsz))) {
-            block = dynablocks->direct[addr-dynablocks->text];
-            if(block)
-                return block;
-        }
+        block = getDirect(dynablocks, addr);
+        if(block)
+            return block;
         if(!(addr>=dynablocks->text && addr<=(dynablocks->text+dynablocks->textsz)))
             dynablocks = NULL;
     }
@@ -168,15 +225,13 @@ dynablock_t* DBGetBlock(x86emu_t* emu, uintptr_t addr, int create, dynablock_t*
     if(!dynablocks)
         return NULL;
     // check direct first, without lock
-    if(dynablocks->direct && (addr>=dynablocks->text) && (addr<=(dynablocks->text+dynablocks->textsz)))
-        block = dynablocks->direct[addr-dynablocks->text];
+    block = getDirect(dynablocks, addr);
     if(block)
         return block;
     // nope, put rwlock in read mode and check hash
     pthread_rwlock_rdlock(&dynablocks->rwlock_blocks);
     // but first, check again just in case it has been created while waiting for mutex
-    if(dynablocks->direct && (addr>=dynablocks->text) && (addr<=(dynablocks->text+dynablocks->textsz)))
-        block = dynablocks->direct[addr-dynablocks->text];
+    block = getDirect(dynablocks, addr);
     if(block) {
         pthread_rwlock_unlock(&dynablocks->rwlock_blocks);
         return block;
@@ -199,8 +254,15 @@ dynablock_t* DBGetBlock(x86emu_t* emu, uintptr_t addr, int create, dynablock_t*
     pthread_rwlock_wrlock(&dynablocks->rwlock_blocks);
     // create and add new block
     dynarec_log(LOG_DEBUG, "Ask for DynaRec Block creation @%p\n", addr);
-    if(dynablocks->direct && (addr>=dynablocks->text) && (addr<=(dynablocks->text+dynablocks->textsz))) {
-        block = dynablocks->direct[addr-dynablocks->text] = (dynablock_t*)calloc(1, sizeof(dynablock_t));
+    if(isInDirect(dynablocks, addr)) {
+        dynablock_t** slot = setDirect(dynablocks->direct, &dynablocks->directleaves, addr-dynablocks->text);
+        if(*slot) {
+            // created by another thread while waiting for the write lock
+            block = *slot;
+            pthread_rwlock_unlock(&dynablocks->rwlock_blocks);
+            return block;
+        }
+        block = *slot = (dynablock_t*)calloc(1, sizeof(dynablock_t));
     } else {
         k = kh_put(dynablocks, dynablocks->blocks, addr-dynablocks->base, &ret);
         if(!ret) {
@@ -224,3 +286,83 @@ dynablock_t* DBGetBlock(x86emu_t* emu, uintptr_t addr, int create, dynablock_t*
 
     return block;
 }
+
+// put db in place of block in the list (write lock must be held), 0 if block is not there anymore
+static int ReplaceDynablock(dynablocklist_t* dynablocks, uintptr_t addr, dynablock_t* block, dynablock_t* db)
+{
+    dynablock_t** slot = NULL;
+    if(isInDirect(dynablocks, addr)) {
+        uintptr_t idx = addr-dynablocks->text;
+        dynablock_t** leaf = dynablocks->direct[idx>>DIRECT_SHIFT];
+        if(leaf)
+            slot = &leaf[idx&DIRECT_MASK];
+    } else {
+        khint_t k = kh_get(dynablocks, dynablocks->blocks, addr-dynablocks->base);
+        if(k!=kh_end(dynablocks->blocks))
+            slot = &kh_value(dynablocks->blocks, k);
+    }
+    if(!slot || *slot!=block)
+        return 0;
+    __sync_synchronize();   // db must be seen complete before being seen in the list (direct is read without lock)
+    *slot = db;
+    return 1;
+}
+
+// make the entry of the old code jump to the new one
+static void RedirectBlock(dynablock_t* old, void* target)
+{
+    uintptr_t entry = (uintptr_t)old->block;
+    intptr_t delta = (intptr_t)target - (intptr_t)(entry+8);
+    if(delta<-(32*1024*1024) || delta>=(32*1024*1024)) {
+        // too far for a B: use the room kept after the code for a LDR pc, [pc, #-4] / .word target, and B to it
+        // (written before the entry is patched, and never executed until then)
+        uint32_t* stub = (uint32_t*)(entry+old->size-REDIRECT_SIZE);
+        stub[0] = 0xe51ff004;
+        stub[1] = (uintptr_t)target;
+        __builtin___clear_cache((char*)stub, (char*)(stub+2));
+        delta = (intptr_t)stub - (intptr_t)(entry+8);
+    }
+    *(uint32_t*)entry = 0xea000000 | ((delta>>2)&0xffffff);   // a single word write, so a thread entering the old code sees one or the other
+    __builtin___clear_cache((char*)entry, (char*)entry+4);
+}
+
+/*
+    Translate the block again (because some instructions did unaligned accesses). The new code is built in a new
+dynablock, published in place of the old one, and the old code entry jumps to the new code (it can still be reached
+from linker tables, or be running on another thread).
+    The old dynablock is then retired, but never freed: the SIGBUS handler reads it without lock, and a thread
+can still be in its code.
+*/
+static dynablock_t* RebuildBlock(x86emu_t* emu, dynablock_t* block, uintptr_t addr)
+{
+    dynablocklist_t* dynablocks = block->parent;
+    dynarec_log(LOG_DEBUG, "Rebuilding DynaRec Block @%p with unaligned safe accesses\n", (void*)addr);
+    dynablock_t* db = (dynablock_t*)calloc(1, sizeof(dynablock_t));
+    db->parent = dynablocks;
+    for(int j=0; j<4; ++j)
+        db->unaligned[j] = block->unaligned[j];
+    FillBlock(emu, db, addr);
+    if(!db->done || !db->block) {
+        FreeDynablock(db, dynablocks->nolinker);
+        return block;
+    }
+    pthread_rwlock_wrlock(&dynablocks->rwlock_blocks);
+    int ok = ReplaceDynablock(dynablocks, addr, block, db);
+    pthread_rwlock_unlock(&dynablocks->rwlock_blocks);
+    if(!ok) {
+        // block has been removed meanwhile
+        FreeDynablock(db, dynablocks->nolinker);
+        return block;
+    }
+    if(block->block)
+        RedirectBlock(block, db->block);
+    return db;
+}
+
+dynablock_t* DBGetBlock(x86emu_t* emu, uintptr_t addr, int create, dynablock_t* current)
+{
+    dynablock_t* block = internalDBGetBlock(emu, addr, create, current);
+    if(block && create && block->done && block->rebuild && __sync_bool_compare_and_swap(&block->rebuild, 1, 0))
+        block = RebuildBlock(emu, block, addr);
+    return block;
+}
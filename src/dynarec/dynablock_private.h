@@ -3,13 +3,22 @@
 
 typedef struct dynablocklist_s dynablocklist_t;
 
+#define REDIRECT_SIZE   8   // room kept after the code of a block, for a far jump to its rebuilt version
+
 typedef struct dynablock_s {
     dynablocklist_t *parent;
     void*       block;
-    int         size;
+    int         size;           // size of the code, with the REDIRECT_SIZE room after it
     uintptr_t*  table;
     int         tablesz;
     int         done;
+    uintptr_t   x86addr;        // x86 address of the block
+    int         x86size;        // size of the x86 code of the block
+    int         ninst;          // number of x86 instructions in the block
+    uint32_t*   instsize;       // for each instruction: x86 size | ARM size<<8 (to find the x86 instruction from an ARM address)
+    uintptr_t   unaligned[4];   // x86 instructions that did an unaligned access (0 for unused entries)
+    int         rebuild;        // block needs to be translated again, with unaligned safe code
+    int         checkable;      // block can be checked against the interpreter (lockstep mode)
 } dynablock_t;
 
 typedef struct kh_dynablocks_s kh_dynablocks_t;
@@ -21,7 +30,8 @@ typedef struct dynablocklist_s {
     uintptr_t           text;
     int                 textsz;
     int                 nolinker;    // in case this dynablock can disapear (also, block memory are allocated with a temporary scheme)
-    dynablock_t         **direct;    // direct mapping (waste of space, so not always there)
+    dynablock_t         ***direct;   // direct mapping: a directory of leaves, allocated on 1st use (not always there)
+    int                 directleaves;// number of allocated leaves
 } dynablocklist_t;
 
 #endif //__DYNABLOCK_PRIVATE_H_
\ No newline at end of file
@@ -14,9 +14,11 @@
 #include "callback.h"
 #include "emu/x86run_private.h"
 #include "x86trace.h"
+#include "profiler.h"
 #ifdef DYNAREC
 #include "dynablock.h"
 #include "dynablock_private.h"
+#include "lockstep.h"
 #endif
 
 #ifdef ARM
@@ -96,6 +98,8 @@ void DynaCall(x86emu_t* emu, uintptr_t addr)
         R_EIP = addr;
         emu->df = d_none;
         dynablock_t* block = NULL;
+        profstate_t prof = ProfilerEnterEmu(emu);
+        emu->gsbase_tlssize = -1;   // the emu may now run on another thread (callbacks), refetch its GS base
         while(!emu->quit) {
             block = DBGetBlock(emu, R_EIP, 1, block);
             if(!block || !block->block || !block->done) {
@@ -108,7 +112,10 @@ void DynaCall(x86emu_t* emu, uintptr_t addr)
                 CHECK_FLAGS(emu);
                 // block is here, let's run it!
                 #ifdef ARM
-                arm_prolog(emu, block->block);
+                if(box86_dynarec_lockstep)
+                    LockstepRun(emu, block);
+                else
+                    arm_prolog(emu, block->block);
                 #endif
             }
             if(emu->fork) {
@@ -118,6 +125,7 @@ void DynaCall(x86emu_t* emu, uintptr_t addr)
                 emu = x86emu_fork(emu, forktype);
             }
         }
+        ProfilerLeaveEmu(prof);
         emu->quit = 0;  // reset Quit flags...
         emu->df = d_none;
         if(emu->quitonlongjmp && emu->longjmp) {
@@ -143,6 +151,8 @@ int DynaRun(x86emu_t* emu)
 #ifdef DYNAREC
     else {
         dynablock_t* block = NULL;
+        profstate_t prof = ProfilerEnterEmu(emu);
+        emu->gsbase_tlssize = -1;   // the emu may now run on another thread (callbacks), refetch its GS base
         while(!emu->quit) {
             block = DBGetBlock(emu, R_EIP, 1, block);
             if(!block || !block->block || !block->done) {
@@ -154,7 +164,10 @@ int DynaRun(x86emu_t* emu)
                 dynarec_log(LOG_DEBUG, "Running DynaRec Block @%p (%p) emu=%p\n", R_EIP, block->block, emu);
                 // block is here, let's run it!
                 #ifdef ARM
-                arm_prolog(emu, block->block);
+                if(box86_dynarec_lockstep)
+                    LockstepRun(emu, block);
+                else
+                    arm_prolog(emu, block->block);
                 #endif
             }
             if(emu->fork) {
@@ -164,6 +177,7 @@ int DynaRun(x86emu_t* emu)
                 emu = x86emu_fork(emu, forktype);
             }
         }
+        ProfilerLeaveEmu(prof);
     }
     return 0;
 #endif
@@ -18,6 +18,9 @@
 #include "dynablock_private.h"
 #include "dynarec_arm.h"
 #include "dynarec_arm_private.h"
+#include "perfmap.h"
+#include "lockstep.h"
+#include "arm_thumb2.h"
 
 void printf_x86_instruction(zydis_dec_t* dec, instruction_x86_t* inst, const char* name) {
     uint8_t *ip = (uint8_t*)inst->addr;
@@ -46,11 +49,95 @@ void arm_pass1(dynarec_arm_t* dyn, uintptr_t addr);
 void arm_pass2(dynarec_arm_t* dyn, uintptr_t addr);
 void arm_pass3(dynarec_arm_t* dyn, uintptr_t addr);
 
+// Jcc ib / Jcc id
+static int isCondJump(uintptr_t addr)
+{
+    uint8_t* ip = (uint8_t*)addr;
+    return (ip[0]>=0x70 && ip[0]<=0x7F) || (ip[0]==0x0F && ip[1]>=0x80 && ip[1]<=0x8F);
+}
+
+// registers used to address memory by the ModRM at ip (none for a register operand)
+static uint8_t addrRegs(uint8_t* ip)
+{
+    uint8_t m = ip[0];
+    if(m>=0xC0)
+        return 0;
+    if((m&7)==4) {
+        uint8_t sib = ip[1];
+        uint8_t regs = 0;
+        if((sib&7)!=5 || (m&0xC0))
+            regs |= 1<<(sib&7);
+        if(((sib>>3)&7)!=4)
+            regs |= 1<<((sib>>3)&7);
+        return regs;
+    }
+    if((m&0xC7)==5)    // disp32
+        return 0;
+    return 1<<(m&7);
+}
+
+// opcodes that can be found in a polling loop: they only read memory and registers (flags apart)
+// written gets the registers loaded, used the registers used to address memory
+static int isPollingOp(uintptr_t addr, uint8_t* written, uint8_t* used)
+{
+    uint8_t* ip = (uint8_t*)addr;
+    if(ip[0]==0x66)
+        ++ip;
+    switch(ip[0]) {
+        case 0x38:  // CMP
+        case 0x39:
+        case 0x3A:
+        case 0x3B:
+        case 0x84:  // TEST
+        case 0x85:
+            *used |= addrRegs(ip+1);
+            return 1;
+        case 0x3C:
+        case 0x3D:
+        case 0x90:  // NOP
+        case 0xA8:  // TEST AL/EAX, imm
+        case 0xA9:
+            return 1;
+        case 0x8A:  // MOV Gb, Eb
+            *used |= addrRegs(ip+1);
+            *written |= 1<<((ip[1]>>3)&3);  // AH..BH are in EAX..EBX
+            return 1;
+        case 0x8B:  // MOV Gd, Ed
+            *used |= addrRegs(ip+1);
+            *written |= 1<<((ip[1]>>3)&7);
+            return 1;
+        case 0xA0:  // MOV AL/EAX, Od
+        case 0xA1:
+            *written |= 1<<_AX;
+            return 1;
+        case 0x80:  // CMP Ex, imm
+        case 0x81:
+        case 0x83:
+            *used |= addrRegs(ip+1);
+            return ((ip[1]>>3)&7)==7;
+        case 0xF6:  // TEST Ex, imm
+        case 0xF7:
+            *used |= addrRegs(ip+1);
+            return ((ip[1]>>3)&7)==0;
+        case 0xF3:
+            return ip[1]==0x90; // PAUSE
+        case 0x0F:
+            if(ip[1]==0xB6 || ip[1]==0xB7 || ip[1]==0xBE || ip[1]==0xBF) {  // MOVZX / MOVSX
+                *used |= addrRegs(ip+2);
+                *written |= 1<<((ip[2]>>3)&7);
+                return 1;
+            }
+            return 0;
+    }
+    return 0;
+}
+
 void FillBlock(x86emu_t* emu, dynablock_t* block, uintptr_t addr) {
     // init the helper
     dynarec_arm_t helper = {0};
     helper.emu = emu;
     helper.nolinker = box86_dynarec_linker?(block->parent->nolinker):1;
+    helper.near = (!block->parent->nolinker && emu->context->dynarec_near)?1:0;  // nolinker blocks are unmapped one by one
     arm_pass0(&helper, addr);
     if(!helper.size) {
         dynarec_log(LOG_DEBUG, "Warning, null-sized dynarec block (%p)\n", (void*)addr);
@@ -81,6 +168,18 @@ void FillBlock(x86emu_t* emu, dynablock_t* block, uintptr_t addr) {
                 helper.insts[i].x86.jmp_insts = k;
             }
         }
+    // detect polling loops (a short loop that only read memory, waiting for another thread)
+    // each pass must read the same locations, so no loaded register can be used as an address
+    for(int i=0; i<helper.size; ++i) {
+        int k = helper.insts[i].x86.jmp_insts;
+        if(helper.insts[i].x86.jmp && k>=0 && k<=i && i-k<=4 && isCondJump(helper.insts[i].x86.addr)) {
+            int spin = 1;
+            uint8_t written = 0, used = 0;
+            for(int i2=k; i2<i && spin; ++i2)
+                spin = isPollingOp(helper.insts[i2].x86.addr, &written, &used);
+            helper.insts[i].spin = spin && !(written&used);
+        }
+    }
     // remove useless flags calulation
     for(int i=0; i<helper.size; ++i)
         if(helper.insts[i].x86.flags==X86_FLAGS_CHANGE) {
@@ -96,11 +195,39 @@ void FillBlock(x86emu_t* emu, dynablock_t* block, uintptr_t addr) {
                 }
             }
         }
+    // lockstep mode: check if the block can be run again by the interpreter
+    if(box86_dynarec_lockstep) {
+        block->checkable = 1;
+        for(int i=0; i<=helper.size && block->checkable; ++i) {
+            if(helper.insts[i].x86.jmp && helper.insts[i].x86.jmp_insts==-1 && i!=helper.size)
+                block->checkable = 0;   // leaving the block in the middle
+            else
+                block->checkable = LockstepCheckable(helper.insts[i].x86.addr, i==helper.size);
+        }
+    }
+    // instructions that already did unaligned accesses will use safe code
+    for(int j=0; j<4 && block->unaligned[j]; ++j)
+        for(int i=0; i<helper.size; ++i)
+            if(helper.insts[i].x86.addr==block->unaligned[j])
+                helper.insts[i].unaligned = 1;
     // pass 2, instruction size
     arm_pass2(&helper, addr);
     // ok, now allocate mapped memory, with executable flag on
     int sz = helper.arm_size;
-    void* p = (void*)AllocDynarecMap(emu->context, sz, block->parent->nolinker);
+    void* p = NULL;
+    if(helper.near) {
+        p = (void*)AllocDynarecNear(emu->context, sz+REDIRECT_SIZE, block);
+        if(p==NULL) {
+            // near arena is full, redo pass 2 with long branches to the helpers
+            helper.near = 0;
+            for(int i=0; i<helper.cap; ++i)
+                helper.insts[i].size = 0;
+            arm_pass2(&helper, addr);
+            sz = helper.arm_size;
+        }
+    }
+    if(p==NULL)
+        p = (void*)AllocDynarecMap(emu->context, sz+REDIRECT_SIZE, block->parent->nolinker, block);
     if(p==NULL) {
         free(helper.insts);
         return;
@@ -113,12 +240,39 @@ void FillBlock(x86emu_t* emu, dynablock_t* block, uintptr_t addr) {
     dynarec_log(LOG_DEBUG, "Emitting %d bytes for %d x86 bytes\n", helper.arm_size, helper.isize);
     helper.arm_size = 0;
     arm_pass3(&helper, addr);
+    if(sz!=helper.arm_size) {
+        // pass 2 and 3 must emit exactly the same thing (the peephole included), or jumps will be wrong
+        printf_log(LOG_NONE, "Warning, size difference in block between pass2 (%d) & pass3 (%d) for %p!\n", sz, helper.arm_size, (void*)addr);
+    }
     // all done...
     __builtin___clear_cache(p, p+helper.arm_size);   // need to clear the cache before execution...
+    __sync_fetch_and_add(&emu->context->dynarec_nblocks, 1);
+    __sync_fetch_and_add(&emu->context->dynarec_x86size, helper.isize);
+    __sync_fetch_and_add(&emu->context->dynarec_armsize, helper.arm_size);
+    if(box86_dynarec_thumb2) {
+        // size of the block if it was emited in Thumb-2 (it still runs as ARM)
+        uint16_t* t2 = (uint16_t*)malloc(helper.arm_size/4*5*sizeof(uint16_t));
+        int untranslated = 0;
+        int t2size = arm_thumb2_block((uint32_t*)p, helper.arm_size/4, (uintptr_t)p, t2, &untranslated);
+        free(t2);
+        __sync_fetch_and_add(&emu->context->dynarec_thumb2size, t2size);
+        __sync_fetch_and_add(&emu->context->dynarec_thumb2untr, untranslated);
+        dynarec_log(LOG_DEBUG, "Block %p: %d ARM bytes, %d Thumb-2 bytes (%d untranslated)\n", (void*)addr, helper.arm_size, t2size, untranslated);
+    }
+    // keep the size of each instruction, to find the x86 instruction of a faulting ARM address
+    uint32_t* instsize = (uint32_t*)malloc((helper.size+1)*sizeof(uint32_t));
+    for(int i=0; i<=helper.size; ++i)
+        instsize[i] = helper.insts[i].x86.size | (helper.insts[i].size<<8);
     free(helper.insts);
+    block->x86addr = addr;
+    block->x86size = helper.isize;
+    block->ninst = helper.size+1;
+    block->instsize = instsize;
     block->table = helper.table;
     block->tablesz = helper.tablesz;
-    block->size = sz;
+    block->size = sz+REDIRECT_SIZE;
     block->block = p;
     block->done = 1;
+    if(box86_dynarec_perfmap)
+        PerfMapAddBlock(emu, addr, helper.isize, p, helper.arm_size);
 }
\ No newline at end of file
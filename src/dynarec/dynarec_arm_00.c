@@ -769,6 +769,16 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     i32 = dyn->insts[ninst+1].address-(dyn->arm_size+8); \
                     Bcond(NO, i32);     \
                     jump_to_linker(dyn, addr+i8, 0, ninst); \
+                } else if(dyn->insts[ninst].spin) {   \
+                    /* polling loop, spin before going back */  \
+                    /* (the spin count is reset when leaving it) */ \
+                    MOVW(x1, 0);        \
+                    STR_IMM9_COND(NO, x1, xEmu, offsetof(x86emu_t, spin)); \
+                    i32 = dyn->insts[ninst+1].address-(dyn->arm_size+8); \
+                    Bcond(NO, i32);     \
+                    SPIN;               \
+                    i32 = dyn->insts[dyn->insts[ninst].x86.jmp_insts].address-(dyn->arm_size+8);    \
+                    Bcond(c__, i32);    \
                 } else {    \
                     /* inside the block */  \
                     i32 = dyn->insts[dyn->insts[ninst].x86.jmp_insts].address-(dyn->arm_size+8);    \
@@ -1322,15 +1332,14 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
         case 0x9C:
             INST_NAME("PUSHF");
             USEFLAG(1);
-            CALL(PackFlags, -1, 0);
-            LDR_IMM9(x1, xEmu, offsetof(x86emu_t, packed_eflags.x32));
+            emit_packflags(dyn, ninst, F_LAST, x1, x2);
             PUSH(xESP, (1<<x1));
             break;
         case 0x9D:
             INST_NAME("POPF");
             UFLAGS(0);
             POP(xESP, (1<<x1));
-            CALL(arm_popf, -1, 0);
+            emit_unpackflags(dyn, ninst, x1, x2);
             MOVW(x1, d_none);
             STR_IMM9(x1, xEmu, offsetof(x86emu_t, df));
             UFLAGS(1);
@@ -1355,8 +1364,7 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
         case 0x9F:
             INST_NAME("LAHF");
             USEFLAG(1);
-            CALL(PackFlags, -1, 0); // could be done here probably
-            LDR_IMM9(x1, xEmu, offsetof(x86emu_t, packed_eflags.x32));
+            emit_packflags(dyn, ninst, 8, x1, x2);
             BFI(xEAX, x1, 8, 8);
             UFLAGS(1);
             break;
@@ -1795,12 +1803,10 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     LDM(xEmu, (1<<4)|(1<<5)|(1<<6)|(1<<7)|(1<<8)|(1<<9)|(1<<10)|(1<<11)|(1<<12));
                     MOV32(x3, ip+1+2+4+4); // expected return address
                     CMPS_REG_LSL_IMM5(xEIP, x3, 0);
-                    B_MARK(cNE);
+                    B_COLD(cNE, 0, 12);
                     LDR_IMM9(x1, xEmu, offsetof(x86emu_t, quit));
                     CMPS_IMM8(x1, 1);
-                    B_NEXT(cNE);
-                    MARK;
-                    jump_to_epilog(dyn, 0, 12, ninst);
+                    B_COLD(cEQ, 0, 12);
                 }
             } else {
                 INST_NAME("INT 3");
@@ -1821,12 +1827,10 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                 LDM(xEmu, (1<<4)|(1<<5)|(1<<6)|(1<<7)|(1<<8)|(1<<9)|(1<<10)|(1<<11)|(1<<12));
                 MOVW(x2, addr);
                 CMPS_REG_LSL_IMM5(x12, x2, 0);
-                B_MARK(cNE);    // jump to epilog, if IP is not what is expected
+                B_COLD(cNE, 0, 12);    // jump to epilog, if IP is not what is expected
                 LDR_IMM9(x1, xEmu, offsetof(x86emu_t, quit));
                 CMPS_IMM8(x1, 1);
-                B_NEXT(cNE);
-                MARK;
-                jump_to_epilog(dyn, 0, 12, ninst);
+                B_COLD(cEQ, 0, 12);
             } else {
                 INST_NAME("INT Ib");
                 *ok = 0;
@@ -2245,19 +2249,17 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                 LDM(xEmu, (1<<4)|(1<<5)|(1<<6)|(1<<7)|(1<<8)|(1<<9)|(1<<10)|(1<<11)|(1<<12));
                 MOV32(x3, natcall+2+4+4);
                 CMPS_REG_LSL_IMM5(xEIP, x3, 0);
-                B_MARK(cNE);    // Not the expected address, exit dynarec block
+                B_COLD(cNE, 0, xEIP);    // Not the expected address, exit dynarec block
                 POP(xESP, (1<<xEIP));   // pop the return address
                 if(retn) {
                     ADD_IMM8(xESP, xESP, retn);
                 }
                 MOV32(x3, addr);
                 CMPS_REG_LSL_IMM5(xEIP, x3, 0);
-                B_MARK(cNE);    // Not the expected address again
+                B_COLD(cNE, 0, xEIP);    // Not the expected address again
                 LDR_IMM9(x1, xEmu, offsetof(x86emu_t, quit));
                 CMPS_IMM8(x1, 1);
-                B_NEXT(cNE);    // not quitting, so lets continue
-                MARK;
-                jump_to_epilog(dyn, 0, xEIP, ninst);
+                B_COLD(cEQ, 0, xEIP);    // quitting
             } else if ((i32==0) && ((PK(0)>=0x58) && (PK(0)<=0x5F))) {
                 MESSAGE(LOG_DUMP, "Hack for Call 0, Pop reg\n");
                 UFLAGS(1);
@@ -2324,39 +2326,14 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     addr = dynarecF20F(dyn, addr, ip, ninst, ok, need_epilog);
                 }
             } else if(nextop==0x66) {
-                nextop = F8;
-                switch(nextop) {
-                    case 0xA5:
-                        INST_NAME("REP MOVSW");
-                        TSTS_REG_LSL_IMM8(xECX, xECX, 0);
-                        B_NEXT(cEQ);    // end of loop
-                        GETDIR(x3, 2);
-                        MARK;
-                        LDRHAI_REG_LSL_IMM5(x1, xESI, x3);
-                        STRHAI_REG_LSL_IMM5(x1, xEDI, x3);
-                        SUBS_IMM8(xECX, xECX, 1);
-                        B_MARK(cNE);
-                        break;
-                    case 0xAB:
-                        INST_NAME("REP STOSW");
-                        TSTS_REG_LSL_IMM8(xECX, xECX, 0);
-                        B_NEXT(cEQ);    // end of loop
-                        GETDIR(x3, 2);
-                        MARK;
-                        STRHAI_REG_LSL_IMM5(xEAX, xEDI, x3);
-                        SUBS_IMM8(xECX, xECX, 1);
-                        B_MARK(cNE);
-                        break;
-                    default:
-                        INST_NAME("F2/F3 66 ...");
-                        *ok = 0;
-                        DEFAULT;
-                }
+                // same as 66 F2/F3, the order of the prefixes doesn't matter
+                addr = dynarec66(dyn, addr-2, ip, ninst, ok, need_epilog);
             } else {
                 // DF=0, increment addresses, DF=1 decrement addresses
                 switch(nextop) {
                     case 0x90:
                         INST_NAME("PAUSE");
+                        SPIN;
                         break;
                     case 0xC3:
                         INST_NAME("(REPZ) RET");
@@ -2653,18 +2630,54 @@ uintptr_t dynarec00(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     INST_NAME("DIV Ed");
                     GETEDH(x1);
                     if(ed!=x1) {MOV_REG(x1, ed);}
+                    if(arm_div) {
+                        // fast path only for EDX==0 and non-0 divisor, so no #DE can happens
+                        CMPS_IMM8(xEDX, 0);
+                        B_MARK(cNE);
+                        TSTS_REG_LSL_IMM8(x1, x1, 0);
+                        B_MARK(cEQ);
+                        UDIV(x2, x1, xEAX);
+                        MLS(xEDX, x2, x1, xEAX);
+                        MOV_REG(xEAX, x2);
+                        MOVW(x2, d_none);   // flags are undefined, but don't let an old defered op come back
+                        STR_IMM9(x2, xEmu, offsetof(x86emu_t, df));
+                        B_MARK2(c__);
+                        MARK;
+                    }
                     STM(xEmu, (1<<xEAX) | (1<<xECX) | (1<<xEDX));
                     CALL(div32, -1, 0);
                     LDM(xEmu, (1<<xEAX) | (1<<xECX) | (1<<xEDX));
+                    if(arm_div) {
+                        MARK2;
+                    }
                     UFLAGS(1);
                     break;
                 case 7:
                     INST_NAME("IDIV Ed");
                     GETEDH(x1);
                     if(ed!=x1) {MOV_REG(x1, ed);}
+                    if(arm_div) {
+                        // fast path only if EDX is the sign extension of EAX and divisor is not 0 or -1, so no #DE can happens
+                        MOV_REG_ASR_IMM5(x2, xEAX, 31);
+                        CMPS_REG_LSL_IMM5(xEDX, x2, 0);
+                        B_MARK(cNE);
+                        ADD_IMM8(x2, x1, 1);
+                        CMPS_IMM8(x2, 1);
+                        B_MARK(cLS);
+                        SDIV(x2, x1, xEAX);
+                        MLS(xEDX, x2, x1, xEAX);
+                        MOV_REG(xEAX, x2);
+                        MOVW(x2, d_none);   // flags are undefined, but don't let an old defered op come back
+                        STR_IMM9(x2, xEmu, offsetof(x86emu_t, df));
+                        B_MARK2(c__);
+                        MARK;
+                    }
                     STM(xEmu, (1<<xEAX) | (1<<xECX) | (1<<xEDX));
                     CALL(idiv32, -1, 0);
                     LDM(xEmu, (1<<xEAX) | (1<<xECX) | (1<<xEDX));
+                    if(arm_div) {
+                        MARK2;
+                    }
                     UFLAGS(1);
                     break;
             }
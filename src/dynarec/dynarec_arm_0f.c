@@ -308,8 +308,12 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
 
         case 0x31:
             INST_NAME("RDTSC");
-            CALL(ReadTSC, xEAX, 0);   // will return the u64 in x1:xEAX
-            MOV_REG(xEDX, x1);
+            if(box86_fastrdtsc) {
+                MRRC_CNTVCT(xEAX, xEDX);    // InitTSC checked it can be read from userspace
+            } else {
+                CALL(ReadTSC, xEAX, 0);   // will return the u64 in x1:xEAX
+                MOV_REG(xEDX, x1);
+            }
             break;
 
         
@@ -583,6 +587,16 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VZIP_32(d0, v0);
             break;
 
+        case 0x63:
+            INST_NAME("PACKSSWB Gm,Em");
+            nextop = F8;
+            GETGM(v0);
+            GETEM(v1);
+            q0 = fpu_get_scratch_quad(dyn);
+            VMOVD(q0+0, v0);
+            VMOVD(q0+1, v1);
+            VQMOVN_S16(v0, q0);
+            break;
         case 0x64:
             INST_NAME("PCMPGTB Gm,Em");
             nextop = F8;
@@ -874,6 +888,13 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             }
             break;
 
+        case 0x74:
+            INST_NAME("PCMPEQB Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VCEQ_8(d0, d0, d1);
+            break;
         case 0x75:
             INST_NAME("PCMPEQW Gm,Em");
             nextop = F8;
@@ -936,6 +957,16 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     i32 = dyn->insts[ninst+1].address-(dyn->arm_size+8); \
                     Bcond(NO, i32);     \
                     jump_to_linker(dyn, addr+i32_, 0, ninst); \
+                } else if(dyn->insts[ninst].spin) {   \
+                    /* polling loop, spin before going back */  \
+                    /* (the spin count is reset when leaving it) */ \
+                    MOVW(x1, 0);        \
+                    STR_IMM9_COND(NO, x1, xEmu, offsetof(x86emu_t, spin)); \
+                    i32 = dyn->insts[ninst+1].address-(dyn->arm_size+8); \
+                    Bcond(NO, i32);     \
+                    SPIN;               \
+                    i32 = dyn->insts[dyn->insts[ninst].x86.jmp_insts].address-(dyn->arm_size+8);    \
+                    Bcond(c__, i32);    \
                 } else {    \
                     /* inside the block */  \
                     i32 = dyn->insts[dyn->insts[ninst].x86.jmp_insts].address-(dyn->arm_size+8);    \
@@ -1180,7 +1211,7 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             MOV32(x12, ip+2);   // EIP is useless, but why not...
             // not purging stuff like x87 here, there is no float math or anything
             STM(xEmu, (1<<4)|(1<<5)|(1<<6)|(1<<7)|(1<<8)|(1<<9)|(1<<10)|(1<<11)|(1<<12));
-            CALL_(arm_cpuid, -1, 0);
+            CALL_(my_cpuid, -1, 0);
             LDM(xEmu, (1<<4)|(1<<5)|(1<<6)|(1<<7)|(1<<8)|(1<<9)|(1<<10)|(1<<11)|(1<<12));
             break;
         case 0xA3:
@@ -1383,7 +1414,7 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             MOVW(x1, 0);
             STR_IMM9(x1, xEmu, offsetof(x86emu_t, flags[F_ZF]));
             UFLAGS(1);
-            MARK3
+            MARK3;
             break;
         case 0xB3:
             INST_NAME("BTR Ed, Gd");
@@ -1496,6 +1527,7 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                         STR_IMM9(ed, wback, fixedaddress);
                     }
                     MARK3;
+                    break;
                 default:
                     *ok = 0;
                     DEFAULT;
@@ -1805,6 +1837,23 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VMUL_16(d0, d0, d1);
             break;
 
+        case 0xD7:
+            INST_NAME("PMOVMSKB Gd, Em");
+            nextop = F8;
+            GETEM(d1);
+            GETGD;
+            v0 = fpu_get_scratch_double(dyn);
+            v1 = fpu_get_scratch_double(dyn);
+            VSHR_S8(v0, d1, 7);     // 0xff or 0x00 for each byte, from the sign bit
+            MOV32(x2, 0x08040201);
+            MOV32(x3, 0x80402010);
+            VMOVtoV_D(v1, x2, x3);
+            VANDD(v0, v0, v1);      // each byte now has its own bit
+            VPADD_8(v0, v0, v0);
+            VPADD_8(v0, v0, v0);
+            VPADD_8(v0, v0, v0);    // and all is summed in the 1st byte
+            VMOVfrDx_U8(gd, v0, 0);
+            break;
         case 0xD8:
             INST_NAME("PSUBUSB Gm,Em");
             nextop = F8;
@@ -1820,6 +1869,13 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VQSUB_U16(d0, d0, d1);
             break;
 
+        case 0xDA:
+            INST_NAME("PMINUB Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VMIN_U8(d0, d0, d1);
+            break;
         case 0xDB:
             INST_NAME("PAND Gm, Em");
             nextop = F8;
@@ -1842,6 +1898,14 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VQADD_U16(d0, d0, d1);
             break;
 
+        case 0xDE:
+            INST_NAME("PMAXUB Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VMAX_U8(d0, d0, d1);
+            break;
+
          case 0xDF:
             INST_NAME("PANDN Gm, Em");
             nextop = F8;
@@ -1850,6 +1914,50 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VBICD(v0, v1, v0);
             break;
 
+        case 0xE0:
+            INST_NAME("PAVGB Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VRHADD_U8(d0, d0, d1);
+            break;
+        case 0xE1:
+            INST_NAME("PSRAW Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VMOVfrV_D(x2, x3, d1);
+            CMPS_IMM8(x3, 0);
+            MOVW_COND(cNE, x2, 16);
+            CMPS_IMM8(x2, 16);
+            MOVW_COND(cHI, x2, 16); // shifting more than the size is the same as a shift of the size
+            RSB_IMM8(x2, x2, 0);    // because we want SHR and not SHL
+            v0 = fpu_get_scratch_double(dyn);
+            VDUPR_16(v0, x2);
+            VSHL_S16(d0, d0, v0);
+            break;
+        case 0xE2:
+            INST_NAME("PSRAD Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VMOVfrV_D(x2, x3, d1);
+            CMPS_IMM8(x3, 0);
+            MOVW_COND(cNE, x2, 32);
+            CMPS_IMM8(x2, 32);
+            MOVW_COND(cHI, x2, 32); // shifting more than the size is the same as a shift of the size
+            RSB_IMM8(x2, x2, 0);    // because we want SHR and not SHL
+            v0 = fpu_get_scratch_double(dyn);
+            VDUPR_32(v0, x2);
+            VSHL_S32(d0, d0, v0);
+            break;
+        case 0xE3:
+            INST_NAME("PAVGW Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VRHADD_U16(d0, d0, d1);
+            break;
        case 0xE4:
             INST_NAME("PMULHUW Gm,Em");
             nextop = F8;
@@ -1871,6 +1979,42 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VMOVD(v0, q0+1);
             break;
 
+        case 0xE7:
+            INST_NAME("MOVNTQ Em, Gm");
+            nextop = F8;
+            if((nextop&0xC0)==0xC0) {
+                *ok = 0;
+                DEFAULT;
+            } else {
+                GETGM(v0);
+                VMOVfrV_D(x2, x3, v0);
+                addr = geted(dyn, addr, ninst, nextop, &ed, x1, &fixedaddress, 255, 0);
+                // there can be some bus error if storing directly the V reg
+                STRD_IMM8(x2, ed, fixedaddress);
+            }
+            break;
+
+        case 0xE8:
+            INST_NAME("PSUBSB Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VQSUB_S8(d0, d0, d1);
+            break;
+        case 0xE9:
+            INST_NAME("PSUBSW Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VQSUB_S16(d0, d0, d1);
+            break;
+        case 0xEA:
+            INST_NAME("PMINSW Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VMIN_S16(d0, d0, d1);
+            break;
         case 0xEB:
             INST_NAME("POR Gm, Em");
             nextop = F8;
@@ -1893,6 +2037,14 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VQADD_S16(d0, d0, d1);
             break;
 
+        case 0xEE:
+            INST_NAME("PMAXSW Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VMAX_S16(d0, d0, d1);
+            break;
+
         case 0xEF:
             INST_NAME("PXOR Gm, Em");
             nextop = F8;
@@ -1951,6 +2103,38 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             VTRN_32(q0, q0+1);
             VADD_32(d0, q0, q0+1);
             break;
+        case 0xF6:
+            INST_NAME("PSADBW Gm,Em");
+            nextop = F8;
+            GETGM(d0);
+            GETEM(d1);
+            VABD_U8(d0, d0, d1);
+            VPADDL_U8(d0, d0);
+            VPADDL_U16(d0, d0);
+            VPADDL_U32(d0, d0);     // the sum is in the low 16bits, the rest is 0
+            break;
+        case 0xF7:
+            INST_NAME("MASKMOVQ Gm, Em");
+            nextop = F8;
+            if((nextop&0xC0)!=0xC0) {
+                *ok = 0;
+                DEFAULT;
+            } else {
+                GETGM(d0);
+                GETEM(d1);
+                // one conditionnal byte store per mask byte, like the interpreter: unselected bytes are not touched
+                VMOVfrV_D(x1, x2, d1);  // mask
+                VMOVfrV_D(x3, x12, d0); // data
+                for(int i=0; i<8; ++i) {
+                    int m = (i<4)?x1:x2;
+                    int v = (i<4)?x3:x12;
+                    TSTS_IMM8_ROR(m, 0x80, (16-4*(i&3))&15);   // sign bit of byte i
+                    STRB_IMM9_COND(cNE, v, xEDI, i);
+                    if((i&3)!=3)
+                        MOV_REG_LSR_IMM5(v, v, 8);
+                }
+            }
+            break;
 
         case 0xF8:
             INST_NAME("PSUBB Gm, Em");
@@ -1973,6 +2157,13 @@ uintptr_t dynarec0F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             GETEM(v1);
             VSUB_32(v0, v0, v1);
             break;
+        case 0xFB:
+            INST_NAME("PSUBQ Gm, Em");
+            nextop = F8;
+            GETGM(v0);
+            GETEM(v1);
+            VSUB_64(v0, v0, v1);
+            break;
 
         case 0xFC:
             INST_NAME("PADDB Gm, Em");
@@ -224,7 +224,8 @@ uintptr_t dynarec66(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             break;
         case 0x26:
             INST_NAME("ES:");
-            // ignored
+            // ignored, but the opcode that follows is still a 16bits one
+            addr = dynarec66(dyn, addr, ip, ninst, ok, need_epilog);
             break;
 
         case 0x29:
@@ -591,6 +592,25 @@ uintptr_t dynarec66(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                 BFI(gd, x1, 0, 16);
             }
             break;
+        case 0x87:
+            INST_NAME("XCHG Ew, Gw");
+            nextop = F8;
+            GETGD;
+            if((nextop&0xC0)==0xC0) {
+                ed = xEAX+(nextop&7);
+                if(ed!=gd) {
+                    UXTH(x1, gd, 0);
+                    BFI(gd, ed, 0, 16);
+                    BFI(ed, x1, 0, 16);
+                }
+            } else {
+                addr = geted(dyn, addr, ninst, nextop, &ed, x2, &fixedaddress, 255, 0);
+                LDRH_IMM8(x1, ed, fixedaddress);
+                STRH_IMM8(gd, ed, fixedaddress);
+                BFI(gd, x1, 0, 16);
+            }
+            break;
+
         case 0x8C:
             INST_NAME("MOV Ew,Seg");
             nextop = F8;
@@ -603,7 +623,18 @@ uintptr_t dynarec66(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                 STRH_IMM8(x1, ed, fixedaddress);
             }
             break;
-
+        case 0x8D:
+            INST_NAME("LEA Gw, Ed");
+            nextop=F8;
+            GETGD;
+            if((nextop&0xC0)==0xC0) {   // reg <= reg? that's an invalid operation
+                *ok = 0;
+                DEFAULT;
+            } else {
+                addr = geted(dyn, addr, ninst, nextop, &ed, x1, &fixedaddress, 0, 0);
+                BFI(gd, ed, 0, 16);
+            }
+            break;
         case 0x8E:
             INST_NAME("MOV Seg,Ew");
             nextop = F8;
@@ -617,15 +648,55 @@ uintptr_t dynarec66(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             }
             break;
 
+        case 0x8F:
+            INST_NAME("POP Ew");
+            nextop = F8;
+            if((nextop&0xC0)==0xC0) {
+                LDRH_IMM8(x1, xESP, 0);
+                ADD_IMM8(xESP, xESP, 2);
+                BFI(xEAX+(nextop&7), x1, 0, 16);
+            } else {
+                addr = geted(dyn, addr, ninst, nextop, &ed, x1, &fixedaddress, 255, 0);
+                LDRH_IMM8(x2, xESP, 0);
+                ADD_IMM8(xESP, xESP, 2);
+                STRH_IMM8(x2, ed, fixedaddress);
+            }
+            break;
         case 0x90:
             INST_NAME("NOP");
             break;
+        case 0x91:
+        case 0x92:
+        case 0x93:
+        case 0x94:
+        case 0x95:
+        case 0x96:
+        case 0x97:
+            INST_NAME("XCHG AX, Reg16");
+            gd = xEAX+(opcode&0x07);
+            UXTH(x2, xEAX, 0);
+            BFI(xEAX, gd, 0, 16);
+            BFI(gd, x2, 0, 16);
+            break;
 
         case 0x98:
             INST_NAME("CBW");
             SXTB(x1, xEAX, 0);
             BFI(xEAX, x1, 0, 16);
             break;
+        case 0x99:
+            INST_NAME("CWD");
+            SXTH(x1, xEAX, 0);
+            MOV_REG_ASR_IMM5(x1, x1, 16);
+            BFI(xEDX, x1, 0, 16);
+            break;
+        case 0x9C:
+            INST_NAME("PUSHFW");
+            USEFLAG(1);
+            emit_packflags(dyn, ninst, 16, x1, x2);
+            SUB_IMM8(xESP, xESP, 2);
+            STRH_IMM8(x1, xESP, 0);
+            break;
 
         case 0xA1:
             INST_NAME("MOV, AX, Od");
@@ -911,6 +982,99 @@ uintptr_t dynarec66(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             }
             break;
 
+        case 0xF2:                      /* REPNZ prefix */
+        case 0xF3:                      /* REPZ prefix */
+            nextop = F8;
+            while(nextop==0x66) nextop = F8;    // F2/F3 66 xx form
+            // DF=0, increment addresses, DF=1 decrement addresses
+            switch(nextop) {
+                case 0xA5:
+                    INST_NAME("REP MOVSW");
+                    TSTS_REG_LSL_IMM8(xECX, xECX, 0);
+                    B_NEXT(cEQ);    // end of loop
+                    GETDIR(x3, 2);
+                    MARK;
+                    LDRHAI_REG_LSL_IMM5(x1, xESI, x3);
+                    STRHAI_REG_LSL_IMM5(x1, xEDI, x3);
+                    SUBS_IMM8(xECX, xECX, 1);
+                    B_MARK(cNE);
+                    break;
+                case 0xA7:
+                    if(opcode==0xF2) {INST_NAME("REPNZ CMPSW");} else {INST_NAME("REPZ CMPSW");}
+                    TSTS_REG_LSL_IMM8(xECX, xECX, 0);
+                    B_NEXT(cEQ);    // end of loop
+                    GETDIR(x3, 2);
+                    MARK;
+                    LDRHAI_REG_LSL_IMM5(x1, xESI, x3);
+                    LDRHAI_REG_LSL_IMM5(x2, xEDI, x3);
+                    CMPS_REG_LSL_IMM5(x1, x2, 0);
+                    if(opcode==0xF2) {
+                        B_MARK2(cEQ);
+                    } else {
+                        B_MARK2(cNE);
+                    }
+                    SUBS_IMM8(xECX, xECX, 1);
+                    B_MARK(cNE);
+                    B_MARK3(c__);   // go past sub ecx, 1
+                    // done, finish with cmp test
+                    MARK2;
+                    SUB_IMM8(xECX, xECX, 1);
+                    MARK3;
+                    emit_cmp16(dyn, ninst, x1, x2, x3, x12);
+                    UFLAGS(0);  // in some case, there is no comp, so cannot use "1"
+                    break;
+                case 0xAB:
+                    INST_NAME("REP STOSW");
+                    TSTS_REG_LSL_IMM8(xECX, xECX, 0);
+                    B_NEXT(cEQ);    // end of loop
+                    GETDIR(x3, 2);
+                    MARK;
+                    STRHAI_REG_LSL_IMM5(xEAX, xEDI, x3);
+                    SUBS_IMM8(xECX, xECX, 1);
+                    B_MARK(cNE);
+                    break;
+                case 0xAD:
+                    INST_NAME("REP LODSW");
+                    TSTS_REG_LSL_IMM8(xECX, xECX, 0);
+                    B_NEXT(cEQ);    // end of loop
+                    GETDIR(x3, 2);
+                    MARK;
+                    LDRHAI_REG_LSL_IMM5(x1, xESI, x3);
+                    SUBS_IMM8(xECX, xECX, 1);
+                    B_MARK(cNE);
+                    BFI(xEAX, x1, 0, 16);
+                    break;
+                case 0xAF:
+                    if(opcode==0xF2) {INST_NAME("REPNZ SCASW");} else {INST_NAME("REPZ SCASW");}
+                    TSTS_REG_LSL_IMM8(xECX, xECX, 0);
+                    B_NEXT(cEQ);    // end of loop
+                    GETDIR(x3, 2);
+                    UXTH(x1, xEAX, 0);
+                    MARK;
+                    LDRHAI_REG_LSL_IMM5(x2, xEDI, x3);
+                    CMPS_REG_LSL_IMM5(x1, x2, 0);
+                    if(opcode==0xF2) {
+                        B_MARK2(cEQ);
+                    } else {
+                        B_MARK2(cNE);
+                    }
+                    SUBS_IMM8(xECX, xECX, 1);
+                    B_MARK(cNE);
+                    B_MARK3(c__);   // go past sub ecx, 1
+                    // done, finish with cmp test
+                    MARK2;
+                    SUB_IMM8(xECX, xECX, 1);
+                    MARK3;
+                    emit_cmp16(dyn, ninst, x1, x2, x3, x12);
+                    UFLAGS(0);  // in some case, there is no comp, so cannot use "1"
+                    break;
+                default:
+                    INST_NAME("66 F2/F3 ...");
+                    *ok = 0;
+                    DEFAULT;
+            }
+            break;
+
         case 0xF7:
             nextop = F8;
             switch((nextop>>3)&7) {
@@ -1000,6 +1164,12 @@ uintptr_t dynarec66(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     UFLAG_DF(x1, d_dec16);
                     UFLAGS(0);
                     break;
+                case 6:
+                    INST_NAME("PUSH Ew");
+                    GETEW(x1);
+                    SUB_IMM8(xESP, xESP, 2);
+                    STRH_IMM8(ed, xESP, 0);
+                    break;
                 default:
                     *ok = 0;
                     DEFAULT;
@@ -201,25 +201,388 @@ uintptr_t dynarec660F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             UFLAGS(1);
             break;
 
-        case 0x3A:  // these are some SSE3 opcodes
+        case 0x38:  // SSSE3 / SSE4.1 opcodes
             opcode = F8;
             switch(opcode) {
+                case 0x00:
+                    INST_NAME("PSHUFB Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    // bit 7 set gives an out of range index, so a 0
+                    v0 = fpu_get_scratch_quad(dyn);
+                    v1 = fpu_get_scratch_quad(dyn);
+                    VMOVQ_I8(v0, 0x8F);
+                    VANDQ(v0, v0, q1);
+                    VTBL2_8(v1, q0, v0);
+                    VTBL2_8(v1+1, q0, v0+1);
+                    VMOVQ(q0, v1);
+                    break;
+                case 0x01:
+                case 0x02:
+                case 0x03:
+                case 0x05:
+                case 0x06:
+                case 0x07:
+                    switch(opcode) {
+                        case 0x01: INST_NAME("PHADDW Gx, Ex"); break;
+                        case 0x02: INST_NAME("PHADDD Gx, Ex"); break;
+                        case 0x03: INST_NAME("PHADDSW Gx, Ex"); break;
+                        case 0x05: INST_NAME("PHSUBW Gx, Ex"); break;
+                        case 0x06: INST_NAME("PHSUBD Gx, Ex"); break;
+                        case 0x07: INST_NAME("PHSUBSW Gx, Ex"); break;
+                    }
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    // even elements of Gx:Ex in v0, odd ones in v1
+                    v0 = fpu_get_scratch_quad(dyn);
+                    v1 = fpu_get_scratch_quad(dyn);
+                    VMOVQ(v0, q0);
+                    VMOVQ(v1, q1);
+                    if(opcode==0x02 || opcode==0x06) {
+                        VUZPQ_32(v0, v1);
+                    } else {
+                        VUZPQ_16(v0, v1);
+                    }
+                    switch(opcode) {
+                        case 0x01: VADDQ_16(q0, v0, v1); break;
+                        case 0x02: VADDQ_32(q0, v0, v1); break;
+                        case 0x03: VQADDQ_S16(q0, v0, v1); break;
+                        case 0x05: VSUBQ_16(q0, v0, v1); break;
+                        case 0x06: VSUBQ_32(q0, v0, v1); break;
+                        case 0x07: VQSUBQ_S16(q0, v0, v1); break;
+                    }
+                    break;
+
+                case 0x10:
+                case 0x14:
+                case 0x15:
+                    switch(opcode) {
+                        case 0x10: INST_NAME("PBLENDVB Gx, Ex"); break;
+                        case 0x14: INST_NAME("BLENDVPS Gx, Ex"); break;
+                        case 0x15: INST_NAME("BLENDVPD Gx, Ex"); break;
+                    }
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    // the mask is the sign of each element of xmm0
+                    v1 = sse_get_reg(dyn, ninst, x1, 0);
+                    v0 = fpu_get_scratch_quad(dyn);
+                    switch(opcode) {
+                        case 0x10: VSHRQ_S8(v0, v1, 7); break;
+                        case 0x14: VSHRQ_S32(v0, v1, 31); break;
+                        case 0x15: VSHRQ_S64(v0, v1, 63); break;
+                    }
+                    VBITQ(q0, q1, v0);
+                    break;
+
+                case 0x1C:
+                    INST_NAME("PABSB Gx, Ex");
+                    nextop = F8;
+                    GETEX(q1);
+                    gd = (nextop&0x38)>>3;
+                    q0 = sse_get_reg_empty(dyn, ninst, x1, gd);
+                    VABSQ_8(q0, q1);
+                    break;
+                case 0x1D:
+                    INST_NAME("PABSW Gx, Ex");
+                    nextop = F8;
+                    GETEX(q1);
+                    gd = (nextop&0x38)>>3;
+                    q0 = sse_get_reg_empty(dyn, ninst, x1, gd);
+                    VABSQ_16(q0, q1);
+                    break;
+                case 0x1E:
+                    INST_NAME("PABSD Gx, Ex");
+                    nextop = F8;
+                    GETEX(q1);
+                    gd = (nextop&0x38)>>3;
+                    q0 = sse_get_reg_empty(dyn, ninst, x1, gd);
+                    VABSQ_32(q0, q1);
+                    break;
+
+                case 0x20:
+                case 0x21:
+                case 0x22:
+                case 0x23:
+                case 0x24:
+                case 0x25:
+                case 0x30:
+                case 0x31:
+                case 0x32:
+                case 0x33:
+                case 0x34:
+                case 0x35:
+                    switch(opcode) {
+                        case 0x20: INST_NAME("PMOVSXBW Gx, Ex"); break;
+                        case 0x21: INST_NAME("PMOVSXBD Gx, Ex"); break;
+                        case 0x22: INST_NAME("PMOVSXBQ Gx, Ex"); break;
+                        case 0x23: INST_NAME("PMOVSXWD Gx, Ex"); break;
+                        case 0x24: INST_NAME("PMOVSXWQ Gx, Ex"); break;
+                        case 0x25: INST_NAME("PMOVSXDQ Gx, Ex"); break;
+                        case 0x30: INST_NAME("PMOVZXBW Gx, Ex"); break;
+                        case 0x31: INST_NAME("PMOVZXBD Gx, Ex"); break;
+                        case 0x32: INST_NAME("PMOVZXBQ Gx, Ex"); break;
+                        case 0x33: INST_NAME("PMOVZXWD Gx, Ex"); break;
+                        case 0x34: INST_NAME("PMOVZXWQ Gx, Ex"); break;
+                        case 0x35: INST_NAME("PMOVZXDQ Gx, Ex"); break;
+                    }
+                    nextop = F8;
+                    if((nextop&0xC0)==0xC0) {
+                        d0 = sse_get_reg(dyn, ninst, x1, nextop&7);
+                    } else {
+                        // only load the bytes used
+                        addr = geted(dyn, addr, ninst, nextop, &ed, x1, &fixedaddress, 0, 0);
+                        d0 = fpu_get_scratch_double(dyn);
+                        switch(opcode&0x0F) {
+                            case 0x2: VLD1LANE_16(d0, ed, 0); break;
+                            case 0x1:
+                            case 0x4: VLD1LANE_32(d0, ed, 0); break;
+                            default:  VLD1_64(d0, ed); break;
+                        }
+                    }
+                    gd = (nextop&0x38)>>3;
+                    q0 = sse_get_reg_empty(dyn, ninst, x1, gd);
+                    // widen in place, as much as needed
+                    if(opcode&0x10) {
+                        switch(opcode&0x0F) {
+                            case 0x0: VMOVL_U8(q0, d0); break;
+                            case 0x1: VMOVL_U8(q0, d0); VMOVL_U16(q0, q0); break;
+                            case 0x2: VMOVL_U8(q0, d0); VMOVL_U16(q0, q0); VMOVL_U32(q0, q0); break;
+                            case 0x3: VMOVL_U16(q0, d0); break;
+                            case 0x4: VMOVL_U16(q0, d0); VMOVL_U32(q0, q0); break;
+                            case 0x5: VMOVL_U32(q0, d0); break;
+                        }
+                    } else {
+                        switch(opcode&0x0F) {
+                            case 0x0: VMOVL_S8(q0, d0); break;
+                            case 0x1: VMOVL_S8(q0, d0); VMOVL_S16(q0, q0); break;
+                            case 0x2: VMOVL_S8(q0, d0); VMOVL_S16(q0, q0); VMOVL_S32(q0, q0); break;
+                            case 0x3: VMOVL_S16(q0, d0); break;
+                            case 0x4: VMOVL_S16(q0, d0); VMOVL_S32(q0, q0); break;
+                            case 0x5: VMOVL_S32(q0, d0); break;
+                        }
+                    }
+                    break;
+
+                case 0x2B:
+                    INST_NAME("PACKUSDW Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    if((nextop&0xC0)==0xC0 && (nextop&7)==gd) {
+                        VQMOVUN_S32(q0, q0);
+                        VMOVD(q0+1, q0);
+                    } else {
+                        GETEX(q1);
+                        VQMOVUN_S32(q0, q0);
+                        VQMOVUN_S32(q0+1, q1);
+                    }
+                    break;
+
+                case 0x38:
+                    INST_NAME("PMINSB Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMINQ_S8(q0, q0, q1);
+                    break;
+                case 0x39:
+                    INST_NAME("PMINSD Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMINQ_S32(q0, q0, q1);
+                    break;
+                case 0x3A:
+                    INST_NAME("PMINUW Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMINQ_U16(q0, q0, q1);
+                    break;
+                case 0x3B:
+                    INST_NAME("PMINUD Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMINQ_U32(q0, q0, q1);
+                    break;
+                case 0x3C:
+                    INST_NAME("PMAXSB Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMAXQ_S8(q0, q0, q1);
+                    break;
+                case 0x3D:
+                    INST_NAME("PMAXSD Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMAXQ_S32(q0, q0, q1);
+                    break;
+                case 0x3E:
+                    INST_NAME("PMAXUW Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMAXQ_U16(q0, q0, q1);
+                    break;
+                case 0x3F:
+                    INST_NAME("PMAXUD Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMAXQ_U32(q0, q0, q1);
+                    break;
+                case 0x40:
+                    INST_NAME("PMULLD Gx, Ex");
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    VMULQ_32(q0, q0, q1);
+                    break;
+
+                default:
+                    // PSIGNx, PMADDUBSW, PMULHRSW, PTEST, PCMPEQQ... are left to the interpreter
+                    *ok = 0;
+                    DEFAULT;
+            }
+            break;
+
+        case 0x3A:  // SSSE3 / SSE4.1 opcodes
+            opcode = F8;
+            switch(opcode) {
+                case 0x0C:
+                case 0x0D:
+                case 0x0E:
+                    switch(opcode) {
+                        case 0x0C: INST_NAME("BLENDPS Gx, Ex, Ib"); break;
+                        case 0x0D: INST_NAME("BLENDPD Gx, Ex, Ib"); break;
+                        case 0x0E: INST_NAME("PBLENDW Gx, Ex, Ib"); break;
+                    }
+                    nextop = F8;
+                    GETGX(q0);
+                    GETEX(q1);
+                    u8 = F8;
+                    // build a byte mask for each half
+                    switch(opcode) {
+                        case 0x0C: i32 = (u8&3); i32_ = (u8>>2)&3; break;
+                        case 0x0D: i32 = (u8&1); i32_ = (u8>>1)&1; break;
+                        default:   i32 = u8&15; i32_ = (u8>>4)&15; break;
+                    }
+                    {
+                        int bytes = (opcode==0x0C)?4:((opcode==0x0D)?8:2);
+                        int m1 = 0, m2 = 0;
+                        for(int i=0; i<8/bytes; ++i) {
+                            if((i32>>i)&1)  m1 |= ((1<<bytes)-1)<<(i*bytes);
+                            if((i32_>>i)&1) m2 |= ((1<<bytes)-1)<<(i*bytes);
+                        }
+                        if(m1==0xff && m2==0xff) {
+                            VMOVQ(q0, q1);
+                        } else if(m1 || m2) {
+                            v0 = fpu_get_scratch_quad(dyn);
+                            VMOV_I64(v0, m1);
+                            VMOV_I64(v0+1, m2);
+                            VBITQ(q0, q1, v0);
+                        }
+                    }
+                    break;
+
                 case 0x0F:
                     INST_NAME("PALIGNR Gx, Ex, Ib");
                     nextop = F8;
                     GETGX(q0);
                     GETEX(q1);
                     u8 = F8;
+                    // Gx:Ex >> u8 bytes
                     if(u8>31) {
-                        VEORQ(q0, q0, q0);    
-                    } else if(u8>15) {
                         VEORQ(q0, q0, q0);
-                        VEXTQ_8(q0, q1, q0, u8-16);
+                    } else if(u8>15) {
+                        v0 = fpu_get_scratch_quad(dyn);
+                        VEORQ(v0, v0, v0);
+                        VEXTQ_8(q0, q0, v0, u8-16);
+                    } else {
+                        VEXTQ_8(q0, q1, q0, u8);
+                    }
+                    break;
+
+                case 0x14:
+                    INST_NAME("PEXTRB Ed, Gx, Ib");
+                    nextop = F8;
+                    GETGX(q0);
+                    if((nextop&0xC0)==0xC0) {
+                        ed = xEAX+(nextop&7);
+                        u8 = F8&15;
+                        VMOVfrDx_U8(ed, q0+(u8>>3), u8&7);
+                    } else {
+                        addr = geted(dyn, addr, ninst, nextop, &ed, x2, &fixedaddress, 0, 0);
+                        u8 = F8&15;
+                        VST1LANE_8(q0+(u8>>3), ed, u8&7);
+                    }
+                    break;
+                case 0x15:
+                    INST_NAME("PEXTRW Ed, Gx, Ib");
+                    nextop = F8;
+                    GETGX(q0);
+                    if((nextop&0xC0)==0xC0) {
+                        ed = xEAX+(nextop&7);
+                        u8 = F8&7;
+                        VMOVfrDx_U16(ed, q0+(u8>>2), u8&3);
+                    } else {
+                        addr = geted(dyn, addr, ninst, nextop, &ed, x2, &fixedaddress, 0, 0);
+                        u8 = F8&7;
+                        VST1LANE_16(q0+(u8>>2), ed, u8&3);
+                    }
+                    break;
+                case 0x16:
+                case 0x17:
+                    if(opcode==0x16) {INST_NAME("PEXTRD Ed, Gx, Ib");} else {INST_NAME("EXTRACTPS Ed, Gx, Ib");}
+                    nextop = F8;
+                    GETGX(q0);
+                    if((nextop&0xC0)==0xC0) {
+                        ed = xEAX+(nextop&7);
+                        u8 = F8&3;
+                        VMOVfrDx_32(ed, q0+(u8>>1), u8&1);
+                    } else {
+                        addr = geted(dyn, addr, ninst, nextop, &ed, x2, &fixedaddress, 0, 0);
+                        u8 = F8&3;
+                        VST1LANE_32(q0+(u8>>1), ed, u8&1);
+                    }
+                    break;
+
+                case 0x20:
+                    INST_NAME("PINSRB Gx, Ed, Ib");
+                    nextop = F8;
+                    GETGX(q0);
+                    if((nextop&0xC0)==0xC0) {
+                        ed = xEAX+(nextop&7);
+                        u8 = F8&15;
+                        VMOVtoDx_8(q0+(u8>>3), u8&7, ed);
+                    } else {
+                        addr = geted(dyn, addr, ninst, nextop, &ed, x2, &fixedaddress, 0, 0);
+                        u8 = F8&15;
+                        VLD1LANE_8(q0+(u8>>3), ed, u8&7);
+                    }
+                    break;
+                case 0x22:
+                    INST_NAME("PINSRD Gx, Ed, Ib");
+                    nextop = F8;
+                    GETGX(q0);
+                    if((nextop&0xC0)==0xC0) {
+                        ed = xEAX+(nextop&7);
+                        u8 = F8&3;
+                        VMOVtoDx_32(q0+(u8>>1), u8&1, ed);
                     } else {
-                        VEXTQ_8(q0, q0, q1, u8);
+                        addr = geted(dyn, addr, ninst, nextop, &ed, x2, &fixedaddress, 0, 0);
+                        u8 = F8&3;
+                        VLD1LANE_32(q0+(u8>>1), ed, u8&1);
                     }
                     break;
+
                 default:
+                    // ROUNDxx (no VRINT on ARMv7), INSERTPS, DPPx, MPSADBW... are left to the interpreter
                     *ok = 0;
                     DEFAULT;
             }
@@ -865,6 +1228,27 @@ uintptr_t dynarec660F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             VCEQQ_32(v0, v0, q0);
             break;
 
+        case 0x7C:
+            INST_NAME("HADDPD Gx, Ex");
+            nextop = F8;
+            GETGX(v0);
+            GETEX(q0);
+            d0 = fpu_get_scratch_double(dyn);
+            VADD_F64(d0, v0, v0+1);
+            VADD_F64(v0+1, q0, q0+1);
+            VMOVD(v0, d0);
+            break;
+        case 0x7D:
+            INST_NAME("HSUBPD Gx, Ex");
+            nextop = F8;
+            GETGX(v0);
+            GETEX(q0);
+            d0 = fpu_get_scratch_double(dyn);
+            VSUB_F64(d0, v0, v0+1);
+            VSUB_F64(v0+1, q0, q0+1);
+            VMOVD(v0, d0);
+            break;
+
         case 0x7E:
             INST_NAME("MOVD Ed,Gx");
             nextop = F8;
@@ -977,6 +1361,27 @@ uintptr_t dynarec660F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             UFLAGS(0);
             break;
 
+        case 0xB1:
+            INST_NAME("CMPXCHG Ew, Gw");
+            nextop = F8;
+            UFLAGS(0);
+            GETGD;
+            GETEW(x12);
+            UXTH(x1, xEAX, 0);
+            CMPS_REG_LSL_IMM5(x1, ed, 0);
+            B_MARK(cNE);
+            // AX == Ew
+            EWBACKW(gd);
+            B_MARK2(c__);
+            MARK;
+            // AX != Ew
+            BFI(xEAX, ed, 0, 16);
+            MARK2;
+            // x1 and ed still have the original values
+            emit_cmp16(dyn, ninst, x1, ed, x2, x3);
+            UFLAGS(1);
+            break;
+
         case 0xB3:
             INST_NAME("BTR Ew, Gw");
             nextop = F8;
@@ -1009,6 +1414,39 @@ uintptr_t dynarec660F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             BFI(gd, x1, 0, 16);
             break;
 
+        case 0xBA:
+            nextop = F8;
+            switch((nextop>>3)&7) {
+                case 4:
+                case 5:
+                case 6:
+                case 7:
+                    switch((nextop>>3)&7) {
+                        case 4: INST_NAME("BT Ew, Ib"); break;
+                        case 5: INST_NAME("BTS Ew, Ib"); break;
+                        case 6: INST_NAME("BTR Ew, Ib"); break;
+                        case 7: INST_NAME("BTC Ew, Ib"); break;
+                    }
+                    USEFLAG(1);
+                    GETEW(x1);
+                    u8 = F8&15;
+                    UBFX(x2, ed, u8, 1);
+                    STR_IMM9(x2, xEmu, offsetof(x86emu_t, flags[F_CF]));
+                    if(((nextop>>3)&7)!=4) {
+                        MOVW(x2, 1<<u8);
+                        switch((nextop>>3)&7) {
+                            case 5: ORR_REG_LSL_IMM8(ed, ed, x2, 0); break;
+                            case 6: BIC_REG_LSL_IMM8(ed, ed, x2, 0); break;
+                            case 7: XOR_REG_LSL_IMM8(ed, ed, x2, 0); break;
+                        }
+                        EWBACK;
+                    }
+                    break;
+                default:
+                    *ok = 0;
+                    DEFAULT;
+            }
+            break;
         case 0xBB:
             INST_NAME("BTC Ew, Gw");
             nextop = F8;
@@ -1074,6 +1512,20 @@ uintptr_t dynarec660F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             BFI(gd, x1, 0, 16);
             break;
         
+        case 0xC1:
+            INST_NAME("XADD Gw, Ew");
+            nextop = F8;
+            GETGW(x1);
+            GETEW(x12);
+            UFLAG_OP12(ed, gd);
+            ADD_REG_LSL_IMM5(x2, ed, gd, 0);
+            UFLAG_RES(x2);
+            BFI(xEAX+((nextop&0x38)>>3), ed, 0, 16);
+            EWBACKW(x2);
+            UFLAG_DF(x1, d_add16);
+            UFLAGS(0);
+            break;
+
         case 0xC4:
             INST_NAME("PINSRW Gx,Ed,Ib");
             nextop = F8;
@@ -1118,6 +1570,14 @@ uintptr_t dynarec660F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             }
             break;
 
+        case 0xD0:
+            INST_NAME("ADDSUBPD Gx, Ex");
+            nextop = F8;
+            GETGX(v0);
+            GETEX(q0);
+            VSUB_F64(v0, v0, q0);
+            VADD_F64(v0+1, v0+1, q0+1);
+            break;
         case 0xD4:
             INST_NAME("PADDQ Gx,Ex");
             nextop = F8;
@@ -35,7 +35,40 @@ uintptr_t dynarec67(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
     uint8_t wback, wb1, wb2;
     int fixedaddress;
     switch(opcode) {
-       
+
+        case 0x66:
+            opcode = F8;
+            switch(opcode) {
+                case 0x8D:
+                    INST_NAME("LEA Gw, Ew (16bits)");
+                    nextop=F8;
+                    if((nextop&0xC0)==0xC0) {
+                        *ok = 0;
+                        DEFAULT;
+                    } else {
+                        GETGD;
+                        addr = geted16(dyn, addr, ninst, nextop, &ed, x1);
+                        BFI(gd, ed, 0, 16);
+                    }
+                    break;
+                default:
+                    *ok = 0;
+                    DEFAULT;
+            }
+            break;
+
+        case 0x8D:
+            INST_NAME("LEA Gd, Ew (16bits)");
+            nextop=F8;
+            if((nextop&0xC0)==0xC0) {
+                *ok = 0;
+                DEFAULT;
+            } else {
+                GETGD;
+                addr = geted16(dyn, addr, ninst, nextop, &ed, gd);
+            }
+            break;
+
 
         #define GO(NO, YES)   \
             BARRIER(2); \
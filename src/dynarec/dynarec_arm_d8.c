@@ -131,7 +131,7 @@ uintptr_t dynarecD8(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             INST_NAME("FDIV ST0, STx");
             v1 = x87_get_st(dyn, ninst, x1, x2, 0);
             v2 = x87_get_st(dyn, ninst, x1, x2, nextop&7);
-            VDIV_F64(v1, v1, v2);
+            x87_div(dyn, ninst, v1, v1, v2);
             break;
         case 0xF8:
         case 0xF9:
@@ -144,7 +144,7 @@ uintptr_t dynarecD8(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             INST_NAME("FDIVR ST0, STx");
             v1 = x87_get_st(dyn, ninst, x1, x2, 0);
             v2 = x87_get_st(dyn, ninst, x1, x2, nextop&7);
-            VDIV_F64(v1, v2, v1);
+            x87_div(dyn, ninst, v1, v2, v1);
             break;
       
         default:
@@ -219,8 +219,14 @@ uintptr_t dynarecD8(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     s0 = fpu_get_scratch_single(dyn);
                     d1 = fpu_get_scratch_double(dyn);
                     VMOVtoV(s0, ed);
-                    VCVT_F64_F32(d1, s0);
-                    VDIV_F64(v1, v1, d1);
+                    if(box86_x87_precision==X87_FLOAT) {
+                        VCVT_F32_F64(d1*2, v1);
+                        VDIV_F32(d1*2, d1*2, s0);
+                        VCVT_F64_F32(v1, d1*2);
+                    } else {
+                        VCVT_F64_F32(d1, s0);
+                        VDIV_F64(v1, v1, d1);
+                    }
                     break;
                 case 7:
                     INST_NAME("FDIVR ST0, float[ED]");
@@ -229,8 +235,14 @@ uintptr_t dynarecD8(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     s0 = fpu_get_scratch_single(dyn);
                     d1 = fpu_get_scratch_double(dyn);
                     VMOVtoV(s0, ed);
-                    VCVT_F64_F32(d1, s0);
-                    VDIV_F64(v1, d1, v1);
+                    if(box86_x87_precision==X87_FLOAT) {
+                        VCVT_F32_F64(d1*2, v1);
+                        VDIV_F32(d1*2, s0, d1*2);
+                        VCVT_F64_F32(v1, d1*2);
+                    } else {
+                        VCVT_F64_F32(d1, s0);
+                        VDIV_F64(v1, d1, v1);
+                    }
                     break;
                 default:
                     *ok = 0;
@@ -44,6 +44,7 @@ uintptr_t dynarecD9(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
     int fixedaddress;
     int v1, v2, v3;
     int s0, s1, s2;
+    int d0;
     int i1, i2, i3;
     switch(nextop) {
 
@@ -151,51 +152,74 @@ uintptr_t dynarecD9(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
         case 0xFA:
             INST_NAME("FSQRT");
             v1 = x87_get_st(dyn, ninst, x1, x2, 0);
-            VSQRT_F64(v1, v1);
+            if(box86_x87_precision==X87_FLOAT) {
+                s0 = fpu_get_scratch_single(dyn);
+                VCVT_F32_F64(s0, v1);
+                VSQRT_F32(s0, s0);
+                VCVT_F64_F32(v1, s0);
+            } else {
+                VSQRT_F64(v1, v1);
+            }
             break;
 
         case 0xFC:
             INST_NAME("FRNDINT");
-            // use C helper for now, nothing staightforward is available
-            x87_forget(dyn, ninst, x1, x2, 0);
-            CALL(arm_frndint, -1, 0);
-            /*
             v1 = x87_get_st(dyn, ninst, x1, x2, 0);
-            VCMP_F64_0(v1);
-            VMRS_APSR();
-            B_NEXT(cVS);    // Unordered, skip
-            B_NEXT(cEQ);    // Zero, skip
+            // |ST0| >= 2^52 (and Inf / NaN) are already integers
+            VMOVfrV_D(x1, x2, v1);
+            UBFX(x3, x2, 20, 11);
+            MOVW(x1, 1023+52);
+            CMPS_REG_LSL_IMM5(x3, x1, 0);
+            B_NEXT(cGE);
+            // adding and substracting 2^52 (with the sign of ST0) rounds to an integer with the current rounding mode
+            d0 = fpu_get_scratch_double(dyn);
+            MOV_REG_LSR_IMM5(x2, x2, 31);
+            MOV32(x1, 0x43300000);
+            ORR_REG_LSL_IMM8(x2, x1, x2, 31);
+            MOVW(x1, 0);
+            VMOVtoV_D(d0, x1, x2);
             u8 = x87_setround(dyn, ninst, x1, x2, x3);
-            VCVT_S32_F64(x1, v1);   // limit to 32bits....
-            VCVT_F64_S32(v1, x1);
+            VADD_F64(v1, v1, d0);
+            VSUB_F64(v1, v1, d0);
             x87_restoreround(dyn, ninst, u8);
-            */
+            // a result of 0 keeps the sign of ST0
+            VABS_F64(v1, v1);
+            VCMP_F64_0(d0);
+            VMRS_APSR();
+            B_NEXT(cGT);
+            VNEG_F64(v1, v1);
             break;
         case 0xF0:
             INST_NAME("F2XM1");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            CALL(arm_f2xm1, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            CALL_D1(exp2, v1, v1);
+            MOV32(x2, (&d_1));
+            d0 = fpu_get_scratch_double(dyn);
+            VLDR_64(d0, x2, 0);
+            VSUB_F64(v1, v1, d0);
             break;
         case 0xF1:
             INST_NAME("FYL2X");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            x87_forget(dyn, ninst, x1, x2, 1);
-            CALL(arm_fyl2x, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            v2 = x87_get_st(dyn, ninst, x1, x2, 1);
+            d0 = fpu_get_scratch_double(dyn);
+            CALL_D1(log2, d0, v1);
+            VMUL_F64(v2, v2, d0);
             x87_do_pop(dyn, ninst);
             break;
         case 0xF2:
             INST_NAME("FTAN");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            CALL(arm_ftan, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            CALL_D1(tan, v1, v1);
             v1 = x87_do_push(dyn, ninst);
             MOV32(x2, (&d_1));
             VLDR_64(v1, x2, 0);
             break;
         case 0xF3:
             INST_NAME("FPATAN");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            x87_forget(dyn, ninst, x1, x2, 1);
-            CALL(arm_fpatan, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            v2 = x87_get_st(dyn, ninst, x1, x2, 1);
+            CALL_D2(atan2, v2, v2, v1);
             x87_do_pop(dyn, ninst);
             break;
         case 0xF4:
@@ -212,32 +236,78 @@ uintptr_t dynarecD9(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             break;
         case 0xF9:
             INST_NAME("FYL2XP1");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            x87_forget(dyn, ninst, x1, x2, 1);
-            CALL(arm_fyl2xp1, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            v2 = x87_get_st(dyn, ninst, x1, x2, 1);
+            MOV32(x2, (&d_1));
+            d0 = fpu_get_scratch_double(dyn);
+            VLDR_64(d0, x2, 0);
+            VADD_F64(d0, v1, d0);
+            CALL_D1(log2, d0, d0);
+            VMUL_F64(v2, v2, d0);
             x87_do_pop(dyn, ninst);
             break;
         case 0xFB:
             INST_NAME("FSINCOS");
-            x87_do_push_empty(dyn, ninst, 0);
-            x87_forget(dyn, ninst, x1, x2, 1);
-            CALL(arm_fsincos, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            v2 = x87_do_push(dyn, ninst);
+            CALL_D1(cos, v2, v1);
+            CALL_D1(sin, v1, v1);
             break;
         case 0xFD:
             INST_NAME("FSCALE");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            x87_forget(dyn, ninst, x1, x2, 1);
-            CALL(arm_fscale, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            v2 = x87_get_st(dyn, ninst, x1, x2, 1);
+            // ST1 Inf or NaN
+            VMOVfrV_D(x2, x3, v2);
+            UBFX(x3, x3, 20, 11);
+            MOVW(x2, 0x7ff);
+            CMPS_REG_LSL_IMM5(x3, x2, 0);
+            B_MARK(cNE);
+            VMOV_64(0, v2);
+            CALL(exp2, -1, 0);
+            VMUL_F64(v1, v1, 0);
+            B_NEXT(c__);
+            MARK;
+            // 2^trunc(ST1) is built directly in the exponent, as 3 factors in 2^[-1022..1022] to cover the whole double range
+            s0 = fpu_get_scratch_single(dyn);
+            d0 = fpu_get_scratch_double(dyn);
+            VCVT_S32_F64(s0, v2);   // truncate and saturate
+            VMOVfrV(x1, s0);
+            MOVW(x2, 0);
+            VMOVtoV(d0*2, x2);      // low part of the factors
+            MOVW(x3, 3066);
+            RSB_IMM8(x12, x3, 0);
+            CMPS_REG_LSL_IMM5(x1, x3, 0);
+            MOV_REG_COND(cGT, x1, x3);
+            CMPS_REG_LSL_IMM5(x1, x12, 0);
+            MOV_REG_COND(cLT, x1, x12);
+            MOVW(x3, 1022);
+            RSB_IMM8(x12, x3, 0);
+            for(int i=0; i<3; ++i) {
+                MOV_REG(x2, x1);
+                if(i<2) {
+                    CMPS_REG_LSL_IMM5(x2, x3, 0);
+                    MOV_REG_COND(cGT, x2, x3);
+                    CMPS_REG_LSL_IMM5(x2, x12, 0);
+                    MOV_REG_COND(cLT, x2, x12);
+                    SUB_REG_LSL_IMM8(x1, x1, x2, 0);
+                }
+                ADD_REG_LSL_IMM5(x2, x2, x3, 0);
+                ADD_IMM8(x2, x2, 1);    // exponent bias is 1023
+                MOV_REG_LSL_IMM5(x2, x2, 20);
+                VMOVtoV(d0*2+1, x2);
+                VMUL_F64(v1, v1, d0);
+            }
             break;
         case 0xFE:
             INST_NAME("FSIN");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            CALL(arm_fsin, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            CALL_D1(sin, v1, v1);
             break;
         case 0xFF:
             INST_NAME("FCOS");
-            x87_forget(dyn, ninst, x1, x2, 0);
-            CALL(arm_fcos, -1, 0);
+            v1 = x87_get_st(dyn, ninst, x1, x2, 0);
+            CALL_D1(cos, v1, v1);
             break;
 
 
@@ -305,7 +375,7 @@ uintptr_t dynarecD9(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                 case 5:
                     INST_NAME("FLDCW Ew");
                     GETEW(x1);
-                    STRH_IMM8(x1, xEmu, offsetof(x86emu_t, cw));    // hopefully cw is not too far for an imm8
+                    STRH_IMM8(x1, xEmu, offsetof(x86emu_t, cw));    // cw is in the imm8 reachable part of x86emu_t
                     UBFX(x1, x1, 10, 2);    // extract round
                     STR_IMM9(x1, xEmu, offsetof(x86emu_t, round));
                     break;
@@ -200,7 +200,7 @@ uintptr_t dynarecDA(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     s0 = fpu_get_scratch_single(dyn);
                     VMOVtoV(s0, ed);
                     VCVT_F64_S32(d0, s0);
-                    VDIV_F64(v1, v1, d0);
+                    x87_div(dyn, ninst, v1, v1, d0);
                     break;
                 case 7:
                     INST_NAME("FIDIVR ST0, Ed");
@@ -210,7 +210,7 @@ uintptr_t dynarecDA(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     s0 = fpu_get_scratch_single(dyn);
                     VMOVtoV(s0, ed);
                     VCVT_F64_S32(d0, s0);
-                    VDIV_F64(v1, d0, v1);
+                    x87_div(dyn, ninst, v1, d0, v1);
                     break;
             }
     }
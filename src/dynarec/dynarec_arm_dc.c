@@ -130,7 +130,7 @@ uintptr_t dynarecDC(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             INST_NAME("FDIVR STx, ST0");
             v2 = x87_get_st(dyn, ninst, x1, x2, 0);
             v1 = x87_get_st(dyn, ninst, x1, x2, nextop&7);
-            VDIV_F64(v1, v2, v1);
+            x87_div(dyn, ninst, v1, v2, v1);
             break;       
         case 0xF8:
         case 0xF9:
@@ -143,7 +143,7 @@ uintptr_t dynarecDC(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             INST_NAME("FDIV STx, ST0");
             v2 = x87_get_st(dyn, ninst, x1, x2, 0);
             v1 = x87_get_st(dyn, ninst, x1, x2, nextop&7);
-            VDIV_F64(v1, v1, v2);
+            x87_div(dyn, ninst, v1, v1, v2);
             break;
         default:
             switch((nextop>>3)&7) {
@@ -204,7 +204,7 @@ uintptr_t dynarecDC(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     addr = geted(dyn, addr, ninst, nextop, &wback, x3, &fixedaddress, 1023, 3);
                     d1 = fpu_get_scratch_double(dyn);
                     VLDR_64(d1, wback, fixedaddress);
-                    VDIV_F64(v1, v1, d1);
+                    x87_div(dyn, ninst, v1, v1, d1);
                     break;
                 case 7:
                     INST_NAME("FDIVR ST0, double[ED]");
@@ -212,7 +212,7 @@ uintptr_t dynarecDC(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
                     addr = geted(dyn, addr, ninst, nextop, &wback, x3, &fixedaddress, 1023, 3);
                     d1 = fpu_get_scratch_double(dyn);
                     VLDR_64(d1, wback, fixedaddress);
-                    VDIV_F64(v1, d1, v1);
+                    x87_div(dyn, ninst, v1, d1, v1);
                     break;
             }
     }
@@ -113,7 +113,7 @@ uintptr_t dynarecDE(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             INST_NAME("FDIVRP STx, ST0");
             v1 = x87_get_st(dyn, ninst, x1, x2, 0);
             v2 = x87_get_st(dyn, ninst, x1, x2, nextop&7);
-            VDIV_F64(v2, v1, v2);
+            x87_div(dyn, ninst, v2, v1, v2);
             x87_do_pop(dyn, ninst);
             break;
         case 0xF8:
@@ -127,7 +127,7 @@ uintptr_t dynarecDE(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst,
             INST_NAME("FDIVP STx, ST0");
             v1 = x87_get_st(dyn, ninst, x1, x2, 0);
             v2 = x87_get_st(dyn, ninst, x1, x2, nextop&7);
-            VDIV_F64(v2, v2, v1);
+            x87_div(dyn, ninst, v2, v2, v1);
             x87_do_pop(dyn, ninst);
             break;
 
@@ -31,6 +31,15 @@
         a = fpu_get_scratch_double(dyn);            \
         VLDR_64(a, ed, fixedaddress);               \
     }
+// Get Ex as a quad
+#define GETEXQ(a) \
+    if((nextop&0xC0)==0xC0) { \
+        a = sse_get_reg(dyn, ninst, x1, nextop&7); \
+    } else {    \
+        addr = geted(dyn, addr, ninst, nextop, &ed, x1, &fixedaddress, 0, 0); \
+        a = fpu_get_scratch_quad(dyn);              \
+        VLD1Q_64(a, ed);                            \
+    }
 
 uintptr_t dynarecF20F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst, int* ok, int* need_epilog)
 {
@@ -256,6 +265,32 @@ uintptr_t dynarecF20F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             }
             break;
 
+        case 0x7C:
+            INST_NAME("HADDPS Gx, Ex");
+            nextop = F8;
+            gd = (nextop&0x38)>>3;
+            v0 = sse_get_reg(dyn, ninst, x1, gd);
+            GETEXQ(q0);
+            d0 = fpu_get_scratch_double(dyn);
+            VPADD_F32(d0, v0, v0+1);
+            VPADD_F32(v0+1, q0, q0+1);
+            VMOVD(v0, d0);
+            break;
+        case 0x7D:
+            INST_NAME("HSUBPS Gx, Ex");
+            nextop = F8;
+            gd = (nextop&0x38)>>3;
+            v0 = sse_get_reg(dyn, ninst, x1, gd);
+            GETEXQ(q0);
+            // even elements of Gx:Ex in q1, odd ones in v1
+            q1 = fpu_get_scratch_quad(dyn);
+            v1 = fpu_get_scratch_quad(dyn);
+            VMOVQ(q1, v0);
+            VMOVQ(v1, q0);
+            VUZPQ_32(q1, v1);
+            VSUBQ_F32(v0, q1, v1);
+            break;
+
         case 0xC2:
             INST_NAME("CMPSD Gx, Ex");
             nextop = F8;
@@ -279,6 +314,36 @@ uintptr_t dynarecF20F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             VMOVtoV_D(v0, x2, x2);
             break;
 
+        case 0xD0:
+            INST_NAME("ADDSUBPS Gx, Ex");
+            nextop = F8;
+            gd = (nextop&0x38)>>3;
+            v0 = sse_get_reg(dyn, ninst, x1, gd);
+            GETEXQ(q0);
+            q1 = fpu_get_scratch_quad(dyn);
+            v1 = fpu_get_scratch_quad(dyn);
+            VSUBQ_F32(q1, v0, q0);
+            VADDQ_F32(v0, v0, q0);
+            // elements 0 and 2 are the substractions
+            VMOV_I64(v1, 0x0F);
+            VMOV_I64(v1+1, 0x0F);
+            VBITQ(v0, q1, v1);
+            break;
+
+        case 0xF0:
+            INST_NAME("LDDQU Gx, Ed");
+            nextop = F8;
+            if((nextop&0xC0)==0xC0) {
+                *ok = 0;
+                DEFAULT;
+            } else {
+                gd = (nextop&0x38)>>3;
+                v0 = sse_get_reg_empty(dyn, ninst, x1, gd);
+                addr = geted(dyn, addr, ninst, nextop, &ed, x1, &fixedaddress, 0, 0);
+                VLD1Q_8(v0, ed);
+            }
+            break;
+
         default:
             *ok = 0;
             DEFAULT;
@@ -38,6 +38,15 @@
         a = fpu_get_scratch_single(dyn);            \
         VLDR_32(a, ed, fixedaddress);               \
     }
+// Get Ex as a quad
+#define GETEXQ(a) \
+    if((nextop&0xC0)==0xC0) { \
+        a = sse_get_reg(dyn, ninst, x1, nextop&7); \
+    } else {    \
+        addr = geted(dyn, addr, ninst, nextop, &ed, x1, &fixedaddress, 0, 0); \
+        a = fpu_get_scratch_quad(dyn);              \
+        VLD1Q_64(a, ed);                            \
+    }
 
 uintptr_t dynarecF30F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int ninst, int* ok, int* need_epilog)
 {
@@ -118,6 +127,25 @@ uintptr_t dynarecF30F(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t ip, int nins
             }
             break;
 
+        case 0x12:
+            INST_NAME("MOVSLDUP Gx, Ex");
+            nextop = F8;
+            GETEXQ(q0);
+            gd = (nextop&0x38)>>3;
+            v0 = sse_get_reg_empty(dyn, ninst, x1, gd);
+            VDUP_32(v0, q0, 0);
+            VDUP_32(v0+1, q0+1, 0);
+            break;
+        case 0x16:
+            INST_NAME("MOVSHDUP Gx, Ex");
+            nextop = F8;
+            GETEXQ(q0);
+            gd = (nextop&0x38)>>3;
+            v0 = sse_get_reg_empty(dyn, ninst, x1, gd);
+            VDUP_32(v0, q0, 1);
+            VDUP_32(v0+1, q0+1, 1);
+            break;
+
         case 0x2A:
             INST_NAME("CVTSI2SS Gx, Ed");
             nextop = F8;
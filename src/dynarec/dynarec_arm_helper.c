@@ -180,6 +180,71 @@ uintptr_t fakeed(dynarec_arm_t* dyn, uintptr_t addr, int ninst, uint8_t nextop)
     return addr;
 }
 
+/* setup hint (or r2) to the 16bits address pointed by Ew (67 prefixed, only the offset part, segment is ignored) */
+uintptr_t geted16(dynarec_arm_t* dyn, uintptr_t addr, int ninst, uint8_t nextop, uint8_t* ed, uint8_t hint)
+{
+    uint8_t ret = (hint>0)?hint:2;
+    int32_t offset = 0;
+    switch(nextop&0xC0) {
+        case 0x00: if((nextop&7)==6) offset = F16S; break;
+        case 0x40: offset = F8S; break;
+        case 0x80: offset = F16S; break;
+    }
+    if(!(nextop&0xC0) && (nextop&7)==6) {
+        MOVW(ret, (uint16_t)offset);
+        *ed = ret;
+        return addr;
+    }
+    switch(nextop&7) {
+        case 0: ADD_REG_LSL_IMM5(ret, xEBX, xESI, 0); break;
+        case 1: ADD_REG_LSL_IMM5(ret, xEBX, xEDI, 0); break;
+        case 2: ADD_REG_LSL_IMM5(ret, xEBP, xESI, 0); break;
+        case 3: ADD_REG_LSL_IMM5(ret, xEBP, xEDI, 0); break;
+        case 4: MOV_REG(ret, xESI); break;
+        case 5: MOV_REG(ret, xEDI); break;
+        case 6: MOV_REG(ret, xEBP); break;
+        case 7: MOV_REG(ret, xEBX); break;
+    }
+    if(offset) {
+        if(offset<0 && offset>-256) {
+            SUB_IMM8(ret, ret, -offset);
+        } else if(offset>0 && offset<256) {
+            ADD_IMM8(ret, ret, offset);
+        } else {
+            // the address wraps at 64K anyway
+            uint8_t scratch = (ret==x2)?x1:x2;
+            MOVW(scratch, (uint16_t)offset);
+            ADD_REG_LSL_IMM5(ret, ret, scratch, 0);
+        }
+    }
+    UXTH(ret, ret, 0);
+    *ed = ret;
+    return addr;
+}
+
+// is target in range of a B/BL from the block?
+static int is_near(dynarec_arm_t* dyn, uintptr_t target)
+{
+    return dyn->near && IsDynarecNear(dyn->emu->context, target);
+}
+
+// offset of target for a B/BL emited now (only meaningfull in pass 3)
+static int32_t near_offset(dynarec_arm_t* dyn, uintptr_t target)
+{
+    return (int32_t)(target - ((uintptr_t)dyn->block + 8));
+}
+
+// jump to target, using reg as scratch if it's out of range
+static void jump_to(dynarec_arm_t* dyn, int ninst, void* target, int reg)
+{
+    if(is_near(dyn, (uintptr_t)target)) {
+        Bcond(c__, near_offset(dyn, (uintptr_t)target));
+    } else {
+        MOV32(reg, (uintptr_t)target);
+        BX(reg);
+    }
+}
+
 void jump_to_epilog(dynarec_arm_t* dyn, uintptr_t ip, int reg, int ninst)
 {
     MESSAGE(LOG_DUMP, "Jump to epilog\n");
@@ -190,9 +255,7 @@ void jump_to_epilog(dynarec_arm_t* dyn, uintptr_t ip, int reg, int ninst)
     } else {
         MOV32(xEIP, ip);
     }
-    void* epilog = arm_epilog;
-    MOV32(2, (uintptr_t)epilog);
-    BX(2);
+    jump_to(dyn, ninst, arm_epilog, x2);
 }
 
 void jump_to_linker(dynarec_arm_t* dyn, uintptr_t ip, int reg, int ninst)
@@ -249,9 +312,7 @@ void ret_to_epilog(dynarec_arm_t* dyn, int ninst)
 #endif
         MESSAGE(LOG_DUMP, "Ret epilog\n");
         POP(xESP, 1<<xEIP);
-        void* epilog = arm_epilog;
-        MOV32(x2, (uintptr_t)epilog);
-        BX(x2);
+        jump_to(dyn, ninst, arm_epilog, x2);
 #if 0
     } else {
         MESSAGE(LOG_DUMP, "Ret epilog with linker\n");
@@ -287,9 +348,7 @@ void retn_to_epilog(dynarec_arm_t* dyn, int ninst, int n)
         MESSAGE(LOG_DUMP, "Retn epilog\n");
         POP(xESP, 1<<xEIP);
         ADD_IMM8(xESP, xESP, n);
-        void* epilog = arm_epilog;
-        MOV32(x2, (uintptr_t)epilog);
-        BX(x2);
+        jump_to(dyn, ninst, arm_epilog, x2);
     } else {
         MESSAGE(LOG_DUMP, "Retn epilog with linker\n");
         POP(xESP, 1<<xEIP);
@@ -321,8 +380,12 @@ void call_c(dynarec_arm_t* dyn, int ninst, void* fnc, int reg, int ret, uint32_t
 {
     PUSH(xSP, (1<<xEmu) | mask);
     fpu_pushcache(dyn, ninst, reg);
-    MOV32(reg, (uintptr_t)fnc);
-    BLX(reg);
+    if(is_near(dyn, (uintptr_t)fnc)) {
+        BLcond(c__, near_offset(dyn, (uintptr_t)fnc));
+    } else {
+        MOV32(reg, (uintptr_t)fnc);
+        BLX(reg);
+    }
     fpu_popcache(dyn, ninst, reg);
     if(ret>=0) {
         MOV_REG(ret, 0);
@@ -333,7 +396,16 @@ void call_c(dynarec_arm_t* dyn, int ninst, void* fnc, int reg, int ret, uint32_t
 void grab_tlsdata(dynarec_arm_t* dyn, uintptr_t addr, int ninst, int reg)
 {
     MESSAGE(LOG_DUMP, "Get TLSData\n");
-    call_c(dyn, ninst, GetGSBaseEmu, 12, reg, 0);
+    int32_t i32;
+    // use the GS base cached in emu, unless the TLS size changed since it was cached
+    LDR_IMM9(x2, xEmu, offsetof(x86emu_t, context));
+    LDR_IMM9(x2, x2, offsetof(box86context_t, tlssize));
+    LDR_IMM9(x3, xEmu, offsetof(x86emu_t, gsbase_tlssize));
+    LDR_IMM9(reg, xEmu, offsetof(x86emu_t, gsbase));
+    CMPS_REG_LSL_IMM5(x2, x3, 0);
+    B_MARKSEG(cEQ);
+    call_c(dyn, ninst, GetGSBaseEmu, 12, reg, 0);   // refresh the cache
+    MARKSEG;
     MESSAGE(LOG_DUMP, "----TLSData\n");
 }
 
@@ -375,6 +447,51 @@ void emit_unlock(dynarec_arm_t* dyn, uintptr_t addr, int ninst)
     POP(xSP, (1<<xEmu));
 }
 
+// emit a spin wait: yield hint, and give the CPU back after box86_pause_spin spins. x1, x2, x3 and x12 are lost
+void emit_spin(dynarec_arm_t* dyn, uintptr_t addr, int ninst)
+{
+    int32_t i32;
+    MESSAGE(LOG_DUMP, "Spin wait\n");
+    YIELD;
+    if(box86_pause_spin) {
+        LDR_IMM9(x1, xEmu, offsetof(x86emu_t, spin));
+        ADD_IMM8(x1, x1, 1);
+        STR_IMM9(x1, xEmu, offsetof(x86emu_t, spin));
+        MOV32(x2, box86_pause_spin);
+        CMPS_REG_LSL_IMM5(x1, x2, 0);
+        B_MARK3(cLO);
+        CALL(SpinWait, -1, 0);
+        MARK3;
+    }
+    MESSAGE(LOG_DUMP, "----Spin wait\n");
+}
+
+// pack flags[0..n-1] in s1 (flags[i] is EFLAGS bit i, IOPL is 2 bits wide), s2 is lost. Deferred flags must be updated before
+void emit_packflags(dynarec_arm_t* dyn, int ninst, int n, int s1, int s2)
+{
+    MOVW(s1, 0);
+    for(int i=0; i<n; ++i) {
+        if(i==F_IOPL+1)
+            continue;
+        LDR_IMM9(s2, xEmu, offsetof(x86emu_t, flags[i]));
+        BFI(s1, s2, i, (i==F_IOPL)?2:1);
+    }
+}
+
+// unpack the EFLAGS value in s1 (POPF) to flags[], s1 is masked like the interpreter does, s2 is lost
+void emit_unpackflags(dynarec_arm_t* dyn, int ninst, int s1, int s2)
+{
+    MOV32(s2, 0x3F7FD7);    // mask off res2, res3 and dummy
+    AND_REG_LSL_IMM5(s1, s1, s2, 0);
+    ORR_IMM8(s1, s1, 0x2, 0);   // and on res1
+    for(int i=0; i<F_LAST; ++i) {
+        if(i==F_IOPL+1)
+            continue;
+        UBFX(s2, s1, i, (i==F_IOPL)?2:1);
+        STR_IMM9(s2, xEmu, offsetof(x86emu_t, flags[i]));
+    }
+}
+
 // x87 stuffs
 static void x87_reset(dynarec_arm_t* dyn, int ninst)
 {
@@ -691,7 +808,7 @@ static int round_map[] = {0, 2, 1, 3};  // map x86 -> arm round flag
 // Set rounding according to cw flags, return reg to restore flags
 int x87_setround(dynarec_arm_t* dyn, int ninst, int s1, int s2, int s3)
 {
-    LDRH_IMM8(s1, xEmu, offsetof(x86emu_t, cw));    // hopefully cw is not too far for an imm8
+    LDRH_IMM8(s1, xEmu, offsetof(x86emu_t, cw));    // cw is in the imm8 reachable part of x86emu_t
     UBFX(s2, s1, 10, 2);    // extract round...
     MOV32(s1, round_map);
     LDR_REG_LSL_IMM5(s2, s1, s2, 2);
@@ -708,6 +825,20 @@ void x87_restoreround(dynarec_arm_t* dyn, int ninst, int s1)
     VMSR(s1);               // put back fpscr
 }
 
+// x87 division, VDIV.F32 is about twice faster than VDIV.F64
+void x87_div(dynarec_arm_t* dyn, int ninst, int vd, int vn, int vm)
+{
+    if(box86_x87_precision==X87_FLOAT) {
+        int s0 = fpu_get_scratch_double(dyn)*2;
+        VCVT_F32_F64(s0, vn);
+        VCVT_F32_F64(s0+1, vm);
+        VDIV_F32(s0, s0, s0+1);
+        VCVT_F64_F32(vd, s0);
+    } else {
+        VDIV_F64(vd, vn, vm);
+    }
+}
+
 // MMX helpers
 static void mmx_reset(dynarec_arm_t* dyn, int ninst)
 {
@@ -868,9 +999,9 @@ void fpu_pushcache(dynarec_arm_t* dyn, int ninst, int s1)
         SUB_IMM8(xSP, xSP, n*8);
     }
     MOV_REG(s1, xSP);
-    for (int i=0; i<n; ++i) {   // should use VSTM?
-        if(dyn->fpuused[i+8]) {
-            int a = 16+i;
+    for (int i=8; i<24; ++i) {   // should use VSTM?
+        if(dyn->fpuused[i]) {
+            int a = 8+i;
             VST1_32_W(a, s1);
         }
     }
@@ -888,9 +1019,9 @@ void fpu_popcache(dynarec_arm_t* dyn, int ninst, int s1)
         return;
     MESSAGE(LOG_DUMP, "\tPop FPU Cache (%d)------\n", n);
     MOV_REG(s1, xSP);
-    for (int i=0; i<n; ++i) {
-        if(dyn->fpuused[i+8]) {
-            int a = 16+i;
+    for (int i=8; i<24; ++i) {
+        if(dyn->fpuused[i]) {
+            int a = 8+i;
             VLD1_32_W(a, s1);
         }
     }
@@ -13,6 +13,9 @@
 
 #include "debug.h"
 #include "arm_emitter.h"
+#include "arm_peephole.h"
+#include "arm_memorder.h"
+#include "arm_unaligned.h"
 #include "../emu/x86primop.h"
 
 #define F8      *(uint8_t*)(addr++)
@@ -174,14 +177,34 @@
 #define CALL(F, ret, M) call_c(dyn, ninst, F, x12, ret, M)
 // CALL_ will use x3 for the call address. Return value can be put in ret (unless ret is -1)
 #define CALL_(F, ret, M) call_c(dyn, ninst, F, x3, ret, M)
-#define MARK    if(dyn->insts) {dyn->insts[ninst].mark = (uintptr_t)dyn->arm_size;}
+// CALL_D1 / CALL_D2 call a libm function on x87 cache regs, without flushing the cache: Dd = F(Dn[, Dm])
+// (args go in D0/D1 and the result comes back in D0, hard-float ABI. D8-D15 are callee saved, D16-D31 are pushed by call_c)
+// With x87 precision set to float, the float version of F is used instead (args and result in S0/S1)
+#define CALL_D1(F, Dd, Dn)                                                      \
+    if(box86_x87_precision==X87_FLOAT) {                                        \
+        VCVT_F32_F64(0, Dn); CALL(F##f, -1, 0); VCVT_F64_F32(Dd, 0);            \
+    } else {                                                                    \
+        VMOV_64(0, Dn); CALL(F, -1, 0); VMOV_64(Dd, 0);                         \
+    }
+#define CALL_D2(F, Dd, Dn, Dm)                                                  \
+    if(box86_x87_precision==X87_FLOAT) {                                        \
+        VCVT_F32_F64(0, Dn); VCVT_F32_F64(1, Dm); CALL(F##f, -1, 0);            \
+        VCVT_F64_F32(Dd, 0);                                                    \
+    } else {                                                                    \
+        VMOV_64(0, Dn); VMOV_64(1, Dm); CALL(F, -1, 0); VMOV_64(Dd, 0);         \
+    }
+// all MARKx are labels, so the peephole (and memory ordering) need to forget everything there
+#define MARK    if(dyn->insts) {dyn->insts[ninst].mark = (uintptr_t)dyn->arm_size;} arm_peephole_reset(dyn); arm_memorder_label(dyn, 1)
 #define GETMARK ((dyn->insts)?dyn->insts[ninst].mark:(dyn->arm_size+4))
-#define MARK2   if(dyn->insts) {dyn->insts[ninst].mark2 = (uintptr_t)dyn->arm_size;}
+#define MARK2   if(dyn->insts) {dyn->insts[ninst].mark2 = (uintptr_t)dyn->arm_size;} arm_peephole_reset(dyn); arm_memorder_label(dyn, 1)
 #define GETMARK2 ((dyn->insts)?dyn->insts[ninst].mark2:(dyn->arm_size+4))
-#define MARK3   if(dyn->insts) {dyn->insts[ninst].mark3 = (uintptr_t)dyn->arm_size;}
+#define MARK3   if(dyn->insts) {dyn->insts[ninst].mark3 = (uintptr_t)dyn->arm_size;} arm_peephole_reset(dyn); arm_memorder_label(dyn, 1)
 #define GETMARK3 ((dyn->insts)?dyn->insts[ninst].mark3:(dyn->arm_size+4))
-#define MARKF   if(dyn->insts) {dyn->insts[ninst].markf = (uintptr_t)dyn->arm_size;}
+#define MARKF   if(dyn->insts) {dyn->insts[ninst].markf = (uintptr_t)dyn->arm_size;} arm_peephole_reset(dyn); arm_memorder_label(dyn, 1)
 #define GETMARKF ((dyn->insts)?dyn->insts[ninst].markf:(dyn->arm_size+4))
+#define MARKSEG if(dyn->insts) {dyn->insts[ninst].markseg = (uintptr_t)dyn->arm_size;} arm_peephole_reset(dyn); arm_memorder_label(dyn, 1)
+#define GETMARKSEG ((dyn->insts)?dyn->insts[ninst].markseg:(dyn->arm_size+4))
+#define GETMARKCOLD ((dyn->insts)?dyn->insts[ninst].markcold:(dyn->arm_size+4))
 
 // Branch to MARK if cond (use i32)
 #define B_MARK(cond)    \
@@ -195,6 +218,15 @@
 #define B_MARK3(cond)    \
     i32 = GETMARK3-(dyn->arm_size+8);   \
     Bcond(cond, i32)
+// Branch to MARKSEG if cond (use i32)
+#define B_MARKSEG(cond)    \
+    i32 = GETMARKSEG-(dyn->arm_size+8);    \
+    Bcond(cond, i32)
+// Branch to the cold exit stub of current instruction if cond. The stub does a jump_to_epilog(ip, reg) and is emited after the block (use i32)
+#define B_COLD(cond, ip, reg)   \
+    if(dyn->insts) {dyn->insts[ninst].cold = 1; dyn->insts[ninst].coldip = ip; dyn->insts[ninst].coldreg = reg;} \
+    i32 = GETMARKCOLD-(dyn->arm_size+8);    \
+    Bcond(cond, i32)
 // Branch to next instruction if cond (use i32)
 #define B_NEXT(cond)     \
     i32 = (dyn->insts)?(dyn->insts[ninst].epilog-(dyn->arm_size+8)):0; \
@@ -266,6 +298,8 @@
 #define LOCK        emit_lock(dyn, addr, ninst)
 // Emit the UNLOCK mutex (x1, x2 and x3 are lost)
 #define UNLOCK      emit_unlock(dyn, addr, ninst)
+// Emit a spin wait (PAUSE or polling loop), x1, x2, x3 and x12 are lost, MARK3 is used
+#define SPIN        emit_spin(dyn, addr, ninst)
 
 
 void arm_epilog();
@@ -299,6 +333,7 @@ void* arm_linker(x86emu_t* emu, void** table, uintptr_t addr);
 
 #define geted           STEPNAME(geted_)
 #define fakeed          STEPNAME(fakeed_)
+#define geted16         STEPNAME(geted16_)
 #define jump_to_epilog  STEPNAME(jump_to_epilog_)
 #define jump_to_linker  STEPNAME(jump_to_linker_)
 #define ret_to_epilog   STEPNAME(ret_to_epilog_)
@@ -308,6 +343,9 @@ void* arm_linker(x86emu_t* emu, void** table, uintptr_t addr);
 #define isNativeCall    STEPNAME(isNativeCall_)
 #define emit_lock       STEPNAME(emit_lock)
 #define emit_unlock     STEPNAME(emit_unlock)
+#define emit_spin       STEPNAME(emit_spin)
+#define emit_packflags  STEPNAME(emit_packflags)
+#define emit_unpackflags STEPNAME(emit_unpackflags)
 #define emit_cmp8       STEPNAME(emit_cmp8)
 #define emit_cmp16      STEPNAME(emit_cmp16)
 #define emit_cmp32      STEPNAME(emit_cmp32)
@@ -329,6 +367,7 @@ void* arm_linker(x86emu_t* emu, void** table, uintptr_t addr);
 #define x87_stackcount  STEPNAME(x87_stackcount)
 #define x87_setround    STEPNAME(x87_setround)
 #define x87_restoreround STEPNAME(x87_restoreround)
+#define x87_div         STEPNAME(x87_div)
 #define mmx_get_reg     STEPNAME(mmx_get_reg)
 #define mmx_get_reg_empty STEPNAME(mmx_get_reg_empty)
 #define sse_get_reg     STEPNAME(sse_get_reg)
@@ -353,6 +392,9 @@ uintptr_t geted(dynarec_arm_t* dyn, uintptr_t addr, int ninst, uint8_t nextop, u
 // Do the GETED, but don't emit anything...
 uintptr_t fakeed(dynarec_arm_t* dyn, uintptr_t addr, int ninst, uint8_t nextop);
 
+/* setup hint (or r2) to the 16bits address pointed by Ew (67 prefixed) */
+uintptr_t geted16(dynarec_arm_t* dyn, uintptr_t addr, int ninst, uint8_t nextop, uint8_t* ed, uint8_t hint);
+
 // generic x86 helper
 void jump_to_epilog(dynarec_arm_t* dyn, uintptr_t ip, int reg, int ninst);
 void jump_to_linker(dynarec_arm_t* dyn, uintptr_t ip, int reg, int ninst);
@@ -363,6 +405,9 @@ void grab_tlsdata(dynarec_arm_t* dyn, uintptr_t addr, int ninst, int reg);
 int isNativeCall(dynarec_arm_t* dyn, uintptr_t addr, uintptr_t* calladdress, int* retn);
 void emit_lock(dynarec_arm_t* dyn, uintptr_t addr, int ninst);
 void emit_unlock(dynarec_arm_t* dyn, uintptr_t addr, int ninst);
+void emit_spin(dynarec_arm_t* dyn, uintptr_t addr, int ninst);
+void emit_packflags(dynarec_arm_t* dyn, int ninst, int n, int s1, int s2);
+void emit_unpackflags(dynarec_arm_t* dyn, int ninst, int s1, int s2);
 void emit_cmp8(dynarec_arm_t* dyn, int ninst, int s1, int s2, int s3, int s4);
 void emit_cmp16(dynarec_arm_t* dyn, int ninst, int s1, int s2, int s3, int s4);
 void emit_cmp32(dynarec_arm_t* dyn, int ninst, int s1, int s2, int s3, int s4);
@@ -396,6 +441,8 @@ void x87_reget_st(dynarec_arm_t* dyn, int ninst, int s1, int s2, int st);
 int x87_setround(dynarec_arm_t* dyn, int ninst, int s1, int s2, int s3);
 // Restore round flag
 void x87_restoreround(dynarec_arm_t* dyn, int ninst, int s1);
+// vd = vn / vm (all Dx), in single precision if BOX86_X87_PRECISION is 0
+void x87_div(dynarec_arm_t* dyn, int ninst, int vd, int vn, int vm);
 
 //MMX helpers
 // get neon register for a MMX reg, create the entry if needed
@@ -47,6 +47,7 @@ void arm_pass(dynarec_arm_t* dyn, uintptr_t addr)
     // Clean up (because there are multiple passes)
     dyn->cleanflags = 0;
     fpu_reset(dyn, ninst);
+    arm_memorder_label(dyn, 1); // the block can be entered just after some shared accesses
     // ok, go now
     INIT;
     while(ok) {
@@ -84,5 +85,14 @@ void arm_pass(dynarec_arm_t* dyn, uintptr_t addr)
         fpu_purgecache(dyn, ninst, x1, x2, x3);
         jump_to_epilog(dyn, ip, 0, ninst);  // no linker here, it's an unknow instruction
     }
+    // cold exit stubs are grouped after the block, so the hot path stays contiguous
+    if(dyn->insts)
+        for(int i=0; i<ninst; ++i)
+            if(dyn->insts[i].cold) {
+                dyn->insts[i].markcold = dyn->arm_size;
+                arm_peephole_reset(dyn);
+                arm_memorder_label(dyn, 1);
+                jump_to_epilog(dyn, dyn->insts[i].coldip, dyn->insts[i].coldreg, ninst);
+            }
     FINI;
 }
\ No newline at end of file
@@ -2,7 +2,18 @@
 #define FINI        if(ninst) {dyn->insts[ninst].address = (dyn->insts[ninst-1].address+dyn->insts[ninst-1].size);}
 
 #define MESSAGE(A, ...)  
-#define EMIT(A)     dyn->insts[ninst].size+=4; dyn->arm_size+=4
-#define NEW_INST    if(ninst) {dyn->insts[ninst].address = (dyn->insts[ninst-1].address+dyn->insts[ninst-1].size);}
-#define INST_EPILOG dyn->insts[ninst].epilog = dyn->arm_size; 
+#define EMIT(A)     \
+    do {                                                \
+        uint32_t op_ = (A);                             \
+        if(arm_peephole(dyn, &op_)) {                   \
+            uint32_t ops_[3];                           \
+            int n_ = arm_unaligned(dyn, ninst, op_, ops_);  \
+            for(int i_=0; i_<n_; ++i_) {                \
+                if(arm_memorder(dyn, ops_[i_])) {dyn->insts[ninst].size+=4; dyn->arm_size+=4;} \
+                dyn->insts[ninst].size+=4; dyn->arm_size+=4; \
+            }                                           \
+        }                                               \
+    } while(0)
+#define NEW_INST    arm_peephole_reset(dyn); arm_memorder_label(dyn, dyn->insts[ninst].x86.barrier); if(ninst) {dyn->insts[ninst].address = (dyn->insts[ninst-1].address+dyn->insts[ninst-1].size);}
+#define INST_EPILOG dyn->insts[ninst].epilog = dyn->arm_size; arm_peephole_reset(dyn); arm_memorder_label(dyn, 1);
 #define INST_NAME(name) 
@@ -1,12 +1,26 @@
 #define INIT    
 #define FINI
 #define EMIT(A)     \
-    if(box86_dynarec_dump) {dynarec_log(LOG_NONE, "\t%08x\t%s\n", (A), arm_print(A));} \
-    *(uint32_t*)(dyn->block) = A;   \
-    dyn->block += 4; dyn->arm_size += 4
+    do {                                                \
+        uint32_t op_ = (A);                             \
+        if(arm_peephole(dyn, &op_)) {                   \
+            uint32_t ops_[3];                           \
+            int n_ = arm_unaligned(dyn, ninst, op_, ops_);  \
+            for(int i_=0; i_<n_; ++i_) {                \
+                if(arm_memorder(dyn, ops_[i_])) {       \
+                    if(box86_dynarec_dump) {dynarec_log(LOG_NONE, "\t%08x\t%s\n", ARM_DMB_ISH, arm_print(ARM_DMB_ISH));} \
+                    *(uint32_t*)(dyn->block) = ARM_DMB_ISH; \
+                    dyn->block += 4; dyn->arm_size += 4;    \
+                }                                       \
+                if(box86_dynarec_dump) {dynarec_log(LOG_NONE, "\t%08x\t%s\n", ops_[i_], arm_print(ops_[i_]));} \
+                *(uint32_t*)(dyn->block) = ops_[i_];    \
+                dyn->block += 4; dyn->arm_size += 4;    \
+            }                                           \
+        }                                               \
+    } while(0)
 
 #define MESSAGE(A, ...)  dynarec_log(A, __VA_ARGS__);
-#define NEW_INST        
-#define INST_EPILOG     
+#define NEW_INST        arm_peephole_reset(dyn); arm_memorder_label(dyn, dyn->insts[ninst].x86.barrier)
+#define INST_EPILOG     arm_peephole_reset(dyn); arm_memorder_label(dyn, 1)
 #define INST_NAME(name) if(box86_dynarec_dump) printf_x86_instruction(dyn->emu->dec, &dyn->insts[ninst].x86, name)
 
@@ -12,6 +12,13 @@ typedef struct instruction_arm_s {
     int                 size;       // size of the arm emited instruction
     uintptr_t           mark, mark2, mark3;
     uintptr_t           markf;
+    uintptr_t           markseg;
+    uintptr_t           markcold;   // address of the cold exit stub, emited after the block
+    int                 cold;       // instruction has a cold exit stub
+    uintptr_t           coldip;     // ip for the cold exit stub (0 if coldreg is used)
+    int                 coldreg;    // reg with ip for the cold exit stub
+    int                 unaligned;  // instruction did unaligned accesses, use safe code
+    int                 spin;       // conditionnal jump closing a polling loop
 } instruction_arm_t;
 
 typedef struct dynarec_arm_s {
@@ -36,6 +43,11 @@ typedef struct dynarec_arm_s {
     int                 fpu_scratch;// scratch counter
     int                 fpu_reg;    // x87/sse/mmx reg counter
     int                 nolinker;   // disable use of (smart) linker in the block
+    int                 near;       // block goes in the near arena, helpers in range can be reached with B/BL
+    uint32_t            peep_known; // peephole: bitmask of ARM regs with a known constant
+    uint32_t            peep_const[16]; // peephole: known constant of ARM regs
+    int                 peep_emu[16];   // peephole: offset in x86emu_t of the field copied in ARM regs (-1 if none)
+    int                 mem_pending;    // memory ordering: shared loads/stores not yet followed by a barrier
 } dynarec_arm_t;
 
 
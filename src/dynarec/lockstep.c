@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "debug.h"
+#include "box86context.h"
+#include "emu/x86emu_private.h"
+#include "emu/x86run_private.h"
+#include "x86run.h"
+#include "x86trace.h"
+#include "dynablock.h"
+#include "dynablock_private.h"
+#include "lockstep.h"
+
+/*
+    Lockstep verification
+
+With BOX86_DYNAREC_LOCKSTEP=N, 1 block execution every N is checked against the interpreter:
+    - x86emu_t and a window of the stack are saved
+    - the block is run (the linker is disabled, so only this block runs)
+    - the stack window is put back, and the interpreter runs the same x86 code on a copy of the saved x86emu_t
+    - registers, flags, x87 / MMX / SSE registers and the stack window are compared, and every divergence is
+      printed with the x86 code of the block
+Because the code runs twice, only blocks that can safely be run again are checked: the only memory writes
+allowed are in the stack window ([ESP+disp] or push), ESP must not be written (other than push / pop, so the
+window stays around it), and there must be no native call, syscall, lock or segment override. The interpreter only stops on call / ret / jmp, so the block must also end with one of
+those, and not leave in the middle with a conditionnal jump. Other threads can still change the memory
+read by the block between the 2 runs, so single threaded programs give the most meaningful results.
+*/
+
+#define LOCKSTEP_BELOW  4096    // stack window, below ESP (push and call)
+#define LOCKSTEP_ABOVE  8192    // stack window, above ESP (locals and args)
+#define LOCKSTEP_MAXRUN (1<<20) // maximum interpreter runs (loops inside the block)
+
+// ModRM at p write only in the stack window
+static int stackModRM(uint8_t* p)
+{
+    uint8_t m = p[0];
+    if((m>>6)==3)
+        return (m&7)!=4;    // register, but not ESP
+    if((m&7)!=4)
+        return 0;
+    uint8_t sib = p[1];
+    if((sib&7)!=4 || ((sib>>3)&7)!=4)
+        return 0;   // only [ESP+disp], without index
+    int32_t disp = 0;
+    if((m>>6)==1)
+        disp = (int8_t)p[2];
+    else if((m>>6)==2)
+        disp = *(int32_t*)(p+2);
+    return (disp>=0) && (disp<LOCKSTEP_ABOVE-16);
+}
+
+#define READ    return 1
+#define READG   return ((ip[1]>>3)&7)!=4  // read Ex, write Gd (that must not be ESP)
+#define WRITE   return stackModRM(ip+1)
+#define NOMEM   return 1
+#define NO      return 0
+
+static int checkable0F(uint8_t* ip)
+{
+    uint8_t nextop = ip[1];
+    uint8_t reg = (ip[2]>>3)&7;
+    ++ip;   // ModRM is at ip+1 now
+    switch(nextop) {
+        case 0x11:  // MOVUPS/MOVSS/MOVSD Ex, Gx
+        case 0x13:  // MOVLPS Ex, Gx
+        case 0x17:  // MOVHPS Ex, Gx
+        case 0x29:  // MOVAPS Ex, Gx
+        case 0x2B:  // MOVNTPS Ex, Gx
+        case 0x7E:  // MOVD Ed, Gm/Gx
+        case 0x7F:  // MOVQ/MOVDQA/MOVDQU Ex, Gx
+        case 0xA4:  // SHLD
+        case 0xA5:
+        case 0xAB:  // BTS
+        case 0xAC:  // SHRD
+        case 0xAD:
+        case 0xB3:  // BTR
+        case 0xBB:  // BTC
+        case 0xC0:  // XADD
+        case 0xC1:
+        case 0xC3:  // MOVNTI
+        case 0xD6:  // MOVQ Ex, Gx
+        case 0xE7:  // MOVNTQ / MOVNTDQ
+            WRITE;
+        case 0xBA:
+            if(reg==4) {READ;}  // BT Ed, Ib
+            WRITE;
+        case 0x50:  // MOVMSKPS Gd
+        case 0xAF:  // IMUL
+        case 0xB6:  // MOVZX / MOVSX
+        case 0xB7:
+        case 0xBC:  // BSF / BSR
+        case 0xBD:
+        case 0xBE:
+        case 0xBF:
+        case 0xC5:  // PEXTRW Gd
+        case 0xD7:  // PMOVMSKB Gd
+            READG;
+        case 0x10:
+        case 0x12:
+        case 0x14:
+        case 0x15:
+        case 0x16:
+        case 0x18:  // prefetch
+        case 0x1F:  // NOP
+        case 0x28:
+        case 0x2A:
+        case 0x2C:
+        case 0x2D:
+        case 0x2E:
+        case 0x2F:
+        case 0xA3:  // BT
+        case 0xC2:
+        case 0xC4:
+        case 0xC6:
+            READ;
+        case 0xA2:  // CPUID
+        case 0x77:  // EMMS
+            NOMEM;
+    }
+    if(nextop>=0x40 && nextop<=0x4F) {READG;}   // CMOVcc
+    if(nextop>=0x50 && nextop<=0x7F) {READ;}    // MMX / SSE
+    if(nextop>=0x80 && nextop<=0x8F) {NOMEM;}   // Jcc
+    if(nextop>=0x90 && nextop<=0x9F) {WRITE;}   // SETcc
+    if(nextop>=0xC8 && nextop<=0xCF) {NOMEM;}   // BSWAP
+    if(nextop>=0xD0) {READ;}                    // MMX / SSE
+    NO; // RDTSC, CMPXCHG, and all the unknown
+}
+
+static int checkableF2F3(uint8_t* ip)
+{
+    if(ip[1]==0x0F) {
+        // SSE scalar
+        if(ip[2]==0x11 || ip[2]==0x7F)
+            return stackModRM(ip+3);
+        if(ip[2]==0x2C || ip[2]==0x2D)  // CVT(T)SS2SI / CVT(T)SD2SI Gd
+            return ((ip[3]>>3)&7)!=4;
+        return 1;
+    }
+    if(ip[0]==0xF3 && ip[1]==0x90)  // PAUSE
+        return 1;
+    return 0;   // string operations
+}
+
+int LockstepCheckable(uintptr_t addr, int last)
+{
+    uint8_t* ip = (uint8_t*)addr;
+    if(ip[0]==0x66)
+        ++ip;
+    uint8_t reg = (ip[1]>>3)&7;
+    switch(ip[0]) {
+        // the interpreter stops on those, they must end the block
+        case 0xC2:  // RET
+        case 0xC3:
+        case 0xE9:  // JMP
+        case 0xEB:
+            return last;
+        case 0xE8:  // CALL, but not native calls or get_pc_thunk, inlined by the dynarec
+            {
+                uint8_t* target = ip + 5 + *(int32_t*)(ip+1);
+                if(!last || target==ip+5 || target[0]==0xCC || (target[0]==0x8B && target[3]==0xC3))
+                    return 0;
+                return 1;
+            }
+        case 0xFF:
+            if(reg==2 || reg==4) return last;   // CALL / JMP Ed
+            if(reg==6) {READ;}  // PUSH Ed
+            if(reg<2) {WRITE;}  // INC / DEC Ed
+            NO;
+    }
+    if(last)
+        return 0;   // the interpreter would not stop at the end of the block
+    switch(ip[0]) {
+        case 0x00: case 0x01: case 0x08: case 0x09: case 0x10: case 0x11: case 0x18: case 0x19:
+        case 0x20: case 0x21: case 0x28: case 0x29: case 0x30: case 0x31:
+        case 0x87:
+            if(reg==4) {NO;}    // XCHG ESP, Ed
+            WRITE;
+        case 0x86: case 0x88: case 0x89: case 0x8F:
+        case 0xC0: case 0xC1: case 0xC6: case 0xC7:
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3:
+        case 0xFE:
+            WRITE;
+        case 0x03: case 0x0B: case 0x13: case 0x1B: case 0x23: case 0x2B: case 0x33:
+        case 0x69: case 0x6B: case 0x8B: case 0x8D:
+            READG;
+        case 0x02: case 0x0A: case 0x12: case 0x1A: case 0x22: case 0x2A: case 0x32:
+        case 0x38: case 0x39: case 0x3A: case 0x3B:
+        case 0x84: case 0x85: case 0x8A:
+        case 0xD8: case 0xDA: case 0xDC: case 0xDE:
+            READ;
+        case 0x04: case 0x05: case 0x0C: case 0x0D: case 0x14: case 0x15: case 0x1C: case 0x1D:
+        case 0x24: case 0x25: case 0x27: case 0x2C: case 0x2D: case 0x2F: case 0x34: case 0x35: case 0x37:
+        case 0x3C: case 0x3D: case 0x3F:
+        case 0x60: case 0x61: case 0x68: case 0x6A:
+        case 0x98: case 0x99: case 0x9B: case 0x9C: case 0x9D: case 0x9E: case 0x9F:
+        case 0xA0: case 0xA1: case 0xA6: case 0xA7: case 0xA8: case 0xA9: case 0xAC: case 0xAD: case 0xAE: case 0xAF:
+        case 0xD4: case 0xD5: case 0xD7:
+        case 0xE3: case 0xF5: case 0xF8: case 0xF9: case 0xFC: case 0xFD:
+            NOMEM;
+        case 0x80: case 0x81: case 0x82: case 0x83:
+            if(reg==7) {READ;}  // CMP
+            WRITE;
+        case 0xF6: case 0xF7:
+            if(reg==2 || reg==3) {WRITE;}   // NOT / NEG
+            READ;
+        case 0xD9:
+            if(reg==2 || reg==3 || reg==6 || reg==7) {WRITE;}
+            READ;
+        case 0xDB:
+            if(reg==1 || reg==2 || reg==3 || reg==7) {WRITE;}
+            READ;
+        case 0xDD:
+            if(reg==1 || reg==2 || reg==3 || reg==6 || reg==7) {WRITE;}
+            READ;
+        case 0xDF:
+            if(reg==1 || reg==2 || reg==3 || reg==6 || reg==7) {WRITE;}
+            READ;
+        case 0x0F:
+            return checkable0F(ip);
+        case 0xF2:
+        case 0xF3:
+            return checkableF2F3(ip);
+    }
+    if(ip[0]==0x44 || ip[0]==0x4C || ip[0]==0x5C || ip[0]==0x94 || ip[0]==0xBC)
+        NO; // INC / DEC / POP / XCHG / MOV ESP
+    if(ip[0]>=0x40 && ip[0]<=0x5F) {NOMEM;} // INC / DEC / PUSH / POP reg
+    if(ip[0]>=0x70 && ip[0]<=0x7F) {NOMEM;} // Jcc
+    if(ip[0]>=0x90 && ip[0]<=0x97) {NOMEM;} // XCHG reg
+    if(ip[0]>=0xB0 && ip[0]<=0xBF) {NOMEM;} // MOV reg, imm
+    NO; // ENTER / LEAVE, native calls, syscalls, lock, segments, string operations, and all the unknown
+}
+
+#undef READ
+#undef READG
+#undef WRITE
+#undef NOMEM
+#undef NO
+
+static void printBlock(x86emu_t* emu, dynablock_t* block)
+{
+    uintptr_t addr = block->x86addr;
+    for(int i=0; i<block->ninst; ++i) {
+        int sz = block->instsize[i]&0xff;
+        printf_log(LOG_NONE, "    %p: ", (void*)addr);
+        #ifdef HAVE_TRACE
+        if(emu->dec) {
+            printf_log(LOG_NONE, "%s\n", DecodeX86Trace(emu->dec, addr));
+            addr += sz;
+            continue;
+        }
+        #endif
+        for(int j=0; j<sz; ++j)
+            printf_log(LOG_NONE, "%02X ", ((uint8_t*)addr)[j]);
+        printf_log(LOG_NONE, "\n");
+        addr += sz;
+    }
+}
+
+static int compare(x86emu_t* emu, x86emu_t* ref, uintptr_t start)
+{
+    static const char* regname[] = {"EAX", "ECX", "EDX", "EBX", "ESP", "EBP", "ESI", "EDI"};
+    static const int flags[] = {F_CF, F_PF, F_AF, F_ZF, F_SF, F_DF, F_OF};
+    static const char* flagname[] = {"CF", "PF", "AF", "ZF", "SF", "DF", "OF"};
+    int diff = 0;
+    #define DIFF(...) do {if(!diff++) printf_log(LOG_NONE, "Lockstep divergence in block @%p:\n", (void*)start); printf_log(LOG_NONE, "  " __VA_ARGS__);} while(0)
+    if(emu->ip.dword[0]!=ref->ip.dword[0])
+        DIFF("EIP: dynarec=%08x interpreter=%08x\n", emu->ip.dword[0], ref->ip.dword[0]);
+    for(int i=0; i<8; ++i)
+        if(emu->regs[i].dword[0]!=ref->regs[i].dword[0])
+            DIFF("%s: dynarec=%08x interpreter=%08x\n", regname[i], emu->regs[i].dword[0], ref->regs[i].dword[0]);
+    CHECK_FLAGS(emu);
+    CHECK_FLAGS(ref);
+    for(int i=0; i<sizeof(flags)/sizeof(flags[0]); ++i)
+        if(!emu->flags[flags[i]]!=!ref->flags[flags[i]])
+            DIFF("%s: dynarec=%d interpreter=%d\n", flagname[i], emu->flags[flags[i]]?1:0, ref->flags[flags[i]]?1:0);
+    if(emu->top!=ref->top)
+        DIFF("x87 top: dynarec=%d interpreter=%d\n", emu->top, ref->top);
+    for(int i=0; i<8; ++i)
+        if(ref->p_regs[i].tag!=0b11 && emu->fpu[i].ll!=ref->fpu[i].ll)
+            DIFF("x87 reg %d: dynarec=%g interpreter=%g\n", i, emu->fpu[i].d, ref->fpu[i].d);
+    for(int i=0; i<8; ++i)
+        if(emu->mmx[i].q!=ref->mmx[i].q)
+            DIFF("MM%d: dynarec=%016llx interpreter=%016llx\n", i, emu->mmx[i].q, ref->mmx[i].q);
+    for(int i=0; i<8; ++i)
+        if(emu->xmm[i].q[0]!=ref->xmm[i].q[0] || emu->xmm[i].q[1]!=ref->xmm[i].q[1])
+            DIFF("XMM%d: dynarec=%016llx%016llx interpreter=%016llx%016llx\n", i, emu->xmm[i].q[1], emu->xmm[i].q[0], ref->xmm[i].q[1], ref->xmm[i].q[0]);
+    if(emu->mxcsr!=ref->mxcsr)
+        DIFF("MXCSR: dynarec=%08x interpreter=%08x\n", emu->mxcsr, ref->mxcsr);
+    #undef DIFF
+    return diff;
+}
+
+static int compareStack(uintptr_t start, uintptr_t window, uint8_t* dynstack, int stacksz, int diff)
+{
+    for(int i=0; i<stacksz; i+=4)
+        if(*(uint32_t*)(dynstack+i)!=*(uint32_t*)(window+i)) {
+            if(!diff++)
+                printf_log(LOG_NONE, "Lockstep divergence in block @%p:\n", (void*)start);
+            printf_log(LOG_NONE, "  [%p]: dynarec=%08x interpreter=%08x\n", (void*)(window+i), *(uint32_t*)(dynstack+i), *(uint32_t*)(window+i));
+        }
+    return diff;
+}
+
+void arm_prolog(x86emu_t* emu, void* addr);
+
+static __thread int lockstep_count = 0;
+// per thread buffers, allocated on 1st check and kept (a block never runs a nested LockstepRun)
+static __thread uint8_t* lockstep_before = NULL;
+static __thread uint8_t* lockstep_dynstack = NULL;
+static __thread x86emu_t* lockstep_ref = NULL;
+
+void LockstepRun(x86emu_t* emu, dynablock_t* block)
+{
+    if(!block->checkable || ++lockstep_count<box86_dynarec_lockstep || !emu->init_stack) {
+        arm_prolog(emu, block->block);
+        return;
+    }
+    lockstep_count = 0;
+    // stack window
+    uintptr_t stack_start = (uintptr_t)emu->init_stack;
+    uintptr_t stack_end = stack_start + emu->size_stack;
+    uintptr_t window = R_ESP - LOCKSTEP_BELOW;
+    uintptr_t window_end = R_ESP + LOCKSTEP_ABOVE;
+    if(window<stack_start) window = stack_start;
+    if(window_end>stack_end) window_end = stack_end;
+    if(window_end<=window) {
+        arm_prolog(emu, block->block);
+        return;
+    }
+    int stacksz = (window_end-window)&~3;
+    if(!lockstep_ref) {
+        x86emu_t* ref = NULL;
+        if(posix_memalign((void**)&ref, __alignof__(x86emu_t), sizeof(x86emu_t))) {
+            arm_prolog(emu, block->block);
+            return;
+        }
+        lockstep_before = (uint8_t*)malloc(LOCKSTEP_BELOW+LOCKSTEP_ABOVE);
+        lockstep_dynstack = (uint8_t*)malloc(LOCKSTEP_BELOW+LOCKSTEP_ABOVE);
+        lockstep_ref = ref;
+    }
+    uint8_t* before = lockstep_before;
+    uint8_t* dynstack = lockstep_dynstack;
+    x86emu_t* ref = lockstep_ref;
+    // save, and run the block
+    memcpy(before, (void*)window, stacksz);
+    memcpy(ref, emu, sizeof(x86emu_t));
+    for(int i=0; i<8; ++i)
+        ref->sbiidx[i] = (i==4)?&ref->zero:&ref->regs[i];
+    uintptr_t start = R_EIP;
+    arm_prolog(emu, block->block);
+    memcpy(dynstack, (void*)window, stacksz);
+    // run the same code again, with the interpreter
+    memcpy((void*)window, before, stacksz);
+    uintptr_t end = block->x86addr + block->x86size;   // the interpreter stops on call / jmp / ret, run it until it leaves the block
+    int n = 0;
+    do {
+        Run(ref, 1);
+    } while(!ref->quit && ref->ip.dword[0]>=block->x86addr && ref->ip.dword[0]<end && ++n<LOCKSTEP_MAXRUN);
+    int diff = compare(emu, ref, start);
+    diff = compareStack(start, window, dynstack, stacksz, diff);
+    if(diff) {
+        printf_log(LOG_NONE, "  x86 code of the block:\n");
+        printBlock(emu, block);
+    }
+    // keep going with the dynarec state
+    memcpy((void*)window, dynstack, stacksz);
+}
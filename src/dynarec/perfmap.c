@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <elf.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "debug.h"
+#include "box86context.h"
+#include "elfloader.h"
+#include "x86emu.h"
+#include "emu/x86emu_private.h"
+#include "emu/x86run_private.h"
+#include "tools/bridge_private.h"
+#include "perfmap.h"
+
+/*
+    Perf map / jitdump
+
+So `perf record` can make sense of the generated code:
+    - /tmp/perf-<pid>.map get one "start size name" line per block (perf report uses it directly)
+    - /tmp/jit-<pid>.dump get a JIT_CODE_LOAD record per block, with the ARM code (for perf inject --jit, so perf annotate works)
+Each line / record is written with a single write() on a file opened in O_APPEND, so there is no lock to take
+while translating. Blocks are never unregistered: when the memory of a freed block is reused, perf map
+readers will see 2 entries (the newest is the right one), while jitdump records are timestamped so
+perf inject picks the code that was there at sample time.
+*/
+
+static int perfmap_fd = -1;
+static int jitdump_fd = -1;
+static uint64_t jitdump_index = 0;
+
+#define JITDUMP_MAGIC   0x4A695444
+#define JIT_CODE_LOAD   0
+
+typedef struct jitdump_header_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t total_size;
+    uint32_t elf_mach;
+    uint32_t pad1;
+    uint32_t pid;
+    uint64_t timestamp;
+    uint64_t flags;
+} jitdump_header_t;
+
+typedef struct jitdump_codeload_s {
+    uint32_t id;
+    uint32_t total_size;
+    uint64_t timestamp;
+    uint32_t pid;
+    uint32_t tid;
+    uint64_t vma;
+    uint64_t code_addr;
+    uint64_t code_size;
+    uint64_t code_index;
+    // followed by the 0 terminated name and the code
+} jitdump_codeload_t;
+
+static uint64_t perf_timestamp()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);    // perf record needs "-k mono" to use the same clock
+    return (uint64_t)ts.tv_sec*1000000000LL + ts.tv_nsec;
+}
+
+void PerfMapInit()
+{
+    char name[100];
+    sprintf(name, "/tmp/perf-%d.map", getpid());
+    perfmap_fd = open(name, O_WRONLY|O_CREAT|O_TRUNC|O_APPEND, 0644);
+    if(perfmap_fd==-1)
+        printf_log(LOG_INFO, "Cannot create perf map file %s\n", name);
+    if(box86_dynarec_perfmap<2)
+        return;
+    sprintf(name, "/tmp/jit-%d.dump", getpid());
+    jitdump_fd = open(name, O_RDWR|O_CREAT|O_TRUNC|O_APPEND, 0644);
+    if(jitdump_fd==-1) {
+        printf_log(LOG_INFO, "Cannot create jitdump file %s\n", name);
+        return;
+    }
+    jitdump_header_t header = {0};
+    header.magic = JITDUMP_MAGIC;
+    header.version = 1;
+    header.total_size = sizeof(header);
+    header.elf_mach = EM_ARM;
+    header.pid = getpid();
+    header.timestamp = perf_timestamp();
+    if(write(jitdump_fd, &header, sizeof(header))!=sizeof(header)) {
+        close(jitdump_fd);
+        jitdump_fd = -1;
+        return;
+    }
+    // perf finds the jitdump file thanks to this (executable) mapping of it
+    if(mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ|PROT_EXEC, MAP_PRIVATE, jitdump_fd, 0)==MAP_FAILED)
+        printf_log(LOG_INFO, "Cannot mmap jitdump file %s, perf will not find it\n", name);
+}
+
+void PerfMapAddBlock(x86emu_t* emu, uintptr_t x86addr, int x86size, void* code, int codesize)
+{
+    if(perfmap_fd==-1 && jitdump_fd==-1)
+        return;
+    char name[300];
+    onebridge_t* b = (onebridge_t*)x86addr;
+    elfheader_t* h = FindElfAddress(emu->context, x86addr);
+    uintptr_t start = 0;
+    const char* symbname = FindNearestSymbolName(h, (void*)x86addr, &start, NULL);
+    if(b->CC==0xCC && b->S=='S' && b->C=='C' && b->w!=(wrapper_t)0)
+        snprintf(name, sizeof(name), "native:%s", GetNativeName(emu, (void*)b->f));
+    else if(symbname && symbname[0])
+        snprintf(name, sizeof(name), "x86:%s+0x%x", symbname, x86addr-start);
+    else if(h)
+        snprintf(name, sizeof(name), "x86:%s:%p", ElfName(h), (void*)x86addr);
+    else
+        snprintf(name, sizeof(name), "x86:%p", (void*)x86addr);
+    if(perfmap_fd!=-1) {
+        char line[400];
+        int l = snprintf(line, sizeof(line), "%x %x %s\n", (uint32_t)(uintptr_t)code, codesize, name);
+        if(write(perfmap_fd, line, l)!=l) {}
+    }
+    if(jitdump_fd!=-1) {
+        int namelen = strlen(name)+1;
+        int total = sizeof(jitdump_codeload_t)+namelen+codesize;
+        jitdump_codeload_t* rec = (jitdump_codeload_t*)malloc(total);
+        rec->id = JIT_CODE_LOAD;
+        rec->total_size = total;
+        rec->timestamp = perf_timestamp();
+        rec->pid = getpid();
+        rec->tid = syscall(SYS_gettid);
+        rec->vma = rec->code_addr = (uintptr_t)code;
+        rec->code_size = codesize;
+        rec->code_index = __sync_fetch_and_add(&jitdump_index, 1);
+        memcpy(rec+1, name, namelen);
+        memcpy((char*)(rec+1)+namelen, code, codesize);
+        if(write(jitdump_fd, rec, total)!=total) {}
+        free(rec);
+    }
+}
@@ -138,101 +138,196 @@
             R_EDX = tmp64u>>32;
             R_EAX = tmp64u&0xFFFFFFFF;
             NEXT;
+
+        _0f_0x38:                   /* SSSE3 opcodes, MMX version */
+            opcode = F8;
+            switch(opcode) {
+                case 0x00:  /* PSHUFB Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    pshufb_64(&GM, EM);
+                    break;
+                case 0x01:  /* PHADDW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    phaddw_64(&GM, EM);
+                    break;
+                case 0x02:  /* PHADDD Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    phaddd_64(&GM, EM);
+                    break;
+                case 0x03:  /* PHADDSW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    phaddsw_64(&GM, EM);
+                    break;
+                case 0x04:  /* PMADDUBSW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    pmaddubsw_64(&GM, EM);
+                    break;
+                case 0x05:  /* PHSUBW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    phsubw_64(&GM, EM);
+                    break;
+                case 0x06:  /* PHSUBD Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    phsubd_64(&GM, EM);
+                    break;
+                case 0x07:  /* PHSUBSW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    phsubsw_64(&GM, EM);
+                    break;
+                case 0x08:  /* PSIGNB Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    psignb_64(&GM, EM);
+                    break;
+                case 0x09:  /* PSIGNW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    psignw_64(&GM, EM);
+                    break;
+                case 0x0A:  /* PSIGND Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    psignd_64(&GM, EM);
+                    break;
+                case 0x0B:  /* PMULHRSW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    pmulhrsw_64(&GM, EM);
+                    break;
+                case 0x1C:  /* PABSB Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    pabsb_64(&GM, EM);
+                    break;
+                case 0x1D:  /* PABSW Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    pabsw_64(&GM, EM);
+                    break;
+                case 0x1E:  /* PABSD Gm, Em */
+                    nextop = F8;
+                    GET_EM;
+                    pabsd_64(&GM, EM);
+                    break;
+                default:
+                    goto _default;
+            }
+            NEXT;
+        _0f_0x3A:                   /* SSSE3 opcodes, MMX version */
+            opcode = F8;
+            switch(opcode) {
+                case 0x0F:  /* PALIGNR Gm, Em, Ib */
+                    nextop = F8;
+                    GET_EM;
+                    tmp8u = F8;
+                    palignr_64(&GM, EM, tmp8u);
+                    break;
+                default:
+                    goto _default;
+            }
+            NEXT;
         
         #define GOCOND(BASE, PREFIX, CONDITIONAL) \
         _0f_##BASE##_0:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_OF))               \
+            if(EvalCond(emu, 0x0))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_1:                          \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_OF))              \
+            if(EvalCond(emu, 0x1))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_2:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_CF))               \
+            if(EvalCond(emu, 0x2))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_3:                          \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_CF))              \
+            if(EvalCond(emu, 0x3))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_4:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_ZF))               \
+            if(EvalCond(emu, 0x4))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_5:                          \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_ZF))              \
+            if(EvalCond(emu, 0x5))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_6:                          \
             PREFIX                              \
-            if((ACCESS_FLAG(F_ZF) || ACCESS_FLAG(F_CF)))  \
+            if(EvalCond(emu, 0x6))                        \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_7:                          \
             PREFIX                              \
-            if(!(ACCESS_FLAG(F_ZF) || ACCESS_FLAG(F_CF))) \
+            if(EvalCond(emu, 0x7))                        \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_8:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_SF))               \
+            if(EvalCond(emu, 0x8))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_9:                          \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_SF))              \
+            if(EvalCond(emu, 0x9))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_A:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_PF))               \
+            if(EvalCond(emu, 0xA))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_B:                          \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_PF))              \
+            if(EvalCond(emu, 0xB))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_C:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF))  \
+            if(EvalCond(emu, 0xC))                      \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_D:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_SF) == ACCESS_FLAG(F_OF)) \
+            if(EvalCond(emu, 0xD))                     \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_E:                          \
             PREFIX                              \
-            if(ACCESS_FLAG(F_ZF) || (ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF))) \
+            if(EvalCond(emu, 0xE))                                            \
                 CONDITIONAL                     \
             NEXT;                              \
         _0f_##BASE##_F:                          \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_ZF) && (ACCESS_FLAG(F_SF) == ACCESS_FLAG(F_OF))) \
+            if(EvalCond(emu, 0xF))                                             \
                 CONDITIONAL                     \
             NEXT;
 
         GOCOND(0x40
             , nextop = F8;
             GET_ED;
-            CHECK_FLAGS(emu);
             , GD.dword[0] = ED->dword[0];
         )                               /* 0x40 -> 0x4F CMOVxx Gd,Ed */ // conditional move, no sign
         GOCOND(0x80
-            , tmp32s = F32S; CHECK_FLAGS(emu);
+            , tmp32s = F32S;
             , ip += tmp32s;
         )                               /* 0x80 -> 0x8F Jxx */
         GOCOND(0x90
-            , nextop = F8; CHECK_FLAGS(emu);
+            , nextop = F8;
             GET_EB;
             , EB->byte[0]=1; else EB->byte[0]=0;
         )                               /* 0x90 -> 0x9F SETxx Eb */
@@ -267,38 +362,32 @@
         _0f_0x54:                      /* ANDPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.ud[i] &= EX->ud[i];
+            pand_128(&GX, EX);
             NEXT;
         _0f_0x55:                      /* ANDNPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.ud[i] = (~GX.ud[i]) & EX->ud[i];
+            pandn_128(&GX, EX);
             NEXT;
         _0f_0x56:                      /* ORPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.ud[i] |= EX->ud[i];
+            por_128(&GX, EX);
             NEXT;
         _0f_0x57:                      /* XORPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.ud[i] ^= EX->ud[i];
+            pxor_128(&GX, EX);
             NEXT;
         _0f_0x58:                      /* ADDPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.f[i] += EX->f[i];
+            addps(&GX, EX);
             NEXT;
         _0f_0x59:                      /* MULPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.f[i] *= EX->f[i];
+            mulps(&GX, EX);
             NEXT;
         _0f_0x5A:                      /* CVTPS2PD Gx, Ex */
             nextop = F8;
@@ -317,8 +406,7 @@
         _0f_0x5C:                      /* SUBPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.f[i] -= EX->f[i];
+            subps(&GX, EX);
             NEXT;
         _0f_0x5D:                      /* MINPS Gx, Ex */
             nextop = F8;
@@ -331,8 +419,7 @@
         _0f_0x5E:                      /* DIVPS Gx, Ex */
             nextop = F8;
             GET_EX;
-            for(int i=0; i<4; ++i)
-                GX.f[i] /= EX->f[i];
+            divps(&GX, EX);
             NEXT;
         _0f_0x5F:                      /* MAXPS Gx, Ex */
             nextop = F8;
@@ -380,23 +467,17 @@
         _0f_0x64:                       /* PCMPGTB Gm,Em */
             nextop = F8;
             GET_EM;
-            for (int i = 0; i < 8; i++) {
-                GM.ub[i] = (GM.sb[i] > EM->sb[i]) ? 0xFF : 0;
-            }
+            pcmpgtb_64(&GM, EM);
             NEXT;
         _0f_0x65:                       /* PCMPGTW Gm,Em */
             nextop = F8;
             GET_EM;
-            for (int i = 0; i < 4; i++) {
-                GM.uw[i] = (GM.sw[i] > EM->sw[i]) ? 0xFFFF : 0;
-            }
+            pcmpgtw_64(&GM, EM);
             NEXT;
         _0f_0x66:                       /* PCMPGTD Gm,Em */
             nextop = F8;
             GET_EM;
-            for (int i = 0; i < 2; i++) {
-                GM.ud[i] = (GM.sd[i] > EM->sd[i]) ? 0xFFFFFFFF : 0;
-            }
+            pcmpgtd_64(&GM, EM);
             NEXT;
         _0f_0x67:                       /* PACKUSWB Gm, Em */
             nextop = F8;
@@ -536,23 +617,17 @@
         _0f_0x74:                       /* PCMPEQB Gm,Em */
             nextop = F8;
             GET_EM;
-            for (int i = 0; i < 8; i++) {
-                GM.ub[i] = (GM.sb[i] == EM->sb[i]) ? 0xFF : 0;
-            }
+            pcmpeqb_64(&GM, EM);
             NEXT;
         _0f_0x75:                       /* PCMPEQW Gm,Em */
             nextop = F8;
             GET_EM;
-            for (int i = 0; i < 4; i++) {
-                GM.uw[i] = (GM.sw[i] == EM->sw[i]) ? 0xFFFF : 0;
-            }
+            pcmpeqw_64(&GM, EM);
             NEXT;
         _0f_0x76:                       /* PCMPEQD Gm,Em */
             nextop = F8;
             GET_EM;
-            for (int i = 0; i < 2; i++) {
-                GM.ud[i] = (GM.sd[i] == EM->sd[i]) ? 0xFFFFFFFF : 0;
-            }
+            pcmpeqd_64(&GM, EM);
             NEXT;
         _0f_0x77:                      /* EMMS */
             // empty MMX, FPU now usable
@@ -573,95 +648,7 @@
 
         _0f_0xA2:                      /* CPUID */
             tmp32u = R_EAX;
-            switch(tmp32u) {
-                case 0x0:
-                    // emulate a P4
-                    R_EAX = 0x80000004;
-                    // return GenuineIntel
-                    R_EBX = 0x756E6547;
-                    R_EDX = 0x49656E69;
-                    R_ECX = 0x6C65746E;
-                    break;
-                case 0x1:
-                    R_EAX = 0x00000101; // familly and all
-                    R_EBX = 0;          // Brand indexe, CLFlush, Max APIC ID, Local APIC ID
-                    R_EDX =   1         // fpu 
-                            | 1<<8      // cmpxchg8
-                            | 1<<11     // sep (sysenter & sysexit)
-                            | 1<<15     // cmov
-                            | 1<<19     // clflush (seems to be with SSE2)
-                            | 1<<23     // mmx
-                            //| 1<<24     // fxsr (fxsave, fxrestore)
-                            | 1<<25     // SSE
-                            | 1<<26     // SSE2
-                            ;
-                    R_ECX =   1<<0      // SSE3
-                            | 1<<9      // SSSE3
-                            | 1<<12     // fma
-                            | 1<<13     // cx16 (cmpxchg16)
-                            ;           
-                    break;
-                case 0x2:   // TLB and Cache info. Sending 1st gen P4 info...
-                    R_EAX = 0x665B5001;
-                    R_EBX = 0x00000000;
-                    R_ECX = 0x00000000;
-                    R_EDX = 0x007A7000;
-                    break;
-                
-                case 0x4:   // Cache info
-                    switch (R_ECX) {
-                        case 0: // L1 data cache
-                            R_EAX = (1 | (1<<5) | (1<<8));   //type
-                            R_EBX = (63 | (7<<22)); // size
-                            R_ECX = 63;
-                            R_EDX = 1;
-                            break;
-                        case 1: // L1 inst cache
-                            R_EAX = (2 | (1<<5) | (1<<8)); //type
-                            R_EBX = (63 | (7<<22)); // size
-                            R_ECX = 63;
-                            R_EDX = 1;
-                            break;
-                        case 2: // L2 cache
-                            R_EAX = (3 | (2<<5) | (1<<8)); //type
-                            R_EBX = (63 | (15<<22));    // size
-                            R_ECX = 4095;
-                            R_EDX = 1;
-                            break;
-
-                        default:
-                            R_EAX = 0x00000000;
-                            R_EBX = 0x00000000;
-                            R_ECX = 0x00000000;
-                            R_EDX = 0x00000000;
-                            break;
-                    }
-                    break;
-                case 0x5:   //mwait info
-                    R_EAX = 0;
-                    R_EBX = 0;
-                    R_ECX = 1 | 2;
-                    R_EDX = 0;
-                    break;
-                case 0x6:   // thermal
-                case 0x9:   // direct cache access
-                case 0xA:   // Architecture performance monitor
-                    R_EAX = 0;
-                    R_EBX = 0;
-                    R_ECX = 0;
-                    R_EDX = 0;
-                    break;
-                case 0x7:   // extended bits...
-                    /*if(R_ECX==0)    R_EAX = 0;
-                    else*/ R_EAX = R_ECX = R_EBX = R_EDX = 0;
-                    break;
-
-                case 0x80000000:        // max extended
-                    break;              // no extended, so return same value as beeing the max value!
-                default:
-                    printf_log(LOG_INFO, "Warning, CPUID command %X unsupported (ECX=%08x)\n", tmp32u, R_ECX);
-                    R_EAX = 0;
-            }
+            my_cpuid(emu, tmp32u);
             NEXT;
         _0f_0xA3:                      /* BT Ed,Gd */
             CHECK_FLAGS(emu);
@@ -1017,29 +1004,32 @@
         _0f_0xD5:                   /* PMULLW Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<4; ++i) {
-                tmp32s = (int32_t)GM.sw[i] * EM->sw[i];
-                GM.sw[i] = tmp32s;
-            }
+            pmullw_64(&GM, EM);
             NEXT;
 
+        _0f_0xD7:                   /* PMOVMSKB Gd, Em */
+            nextop = F8;
+            GET_EM;
+            GD.dword[0] = 0;
+            for (int i=0; i<8; ++i)
+                if(EM->ub[i]&0x80)
+                    GD.dword[0] |= (1<<i);
+            NEXT;
         _0f_0xD8:                   /* PSUBUSB Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<8; ++i) {
-                tmp32s = (int32_t)GM.ub[i] - EM->ub[i];
-                GM.ub[i] = (tmp32s < 0) ? 0 : tmp32s;
-            }
+            psubusb_64(&GM, EM);
             NEXT;
         _0f_0xD9:                   /* PSUBUSW Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<4; ++i) {
-                tmp32s = (int32_t)GM.uw[i] - EM->uw[i];
-                GM.uw[i] = (tmp32s < 0) ? 0 : tmp32s;
-            }
+            psubusw_64(&GM, EM);
+            NEXT;
+        _0f_0xDA:                   /* PMINUB Gm,Em */
+            nextop = F8;
+            GET_EM;
+            pminub_64(&GM, EM);
             NEXT;
-
         _0f_0xDB:                   /* PAND Gm,Em */
             nextop = F8;
             GET_EM;
@@ -1048,20 +1038,18 @@
         _0f_0xDC:                   /* PADDUSB Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<8; ++i) {
-                tmp32u = (uint32_t)GM.ub[i] + EM->ub[i];
-                GM.ub[i] = (tmp32u>255) ? 255 : tmp32u;
-            }
+            paddusb_64(&GM, EM);
             NEXT;
         _0f_0xDD:                   /* PADDUSW Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<4; ++i) {
-                tmp32u = (uint32_t)GM.uw[i] + EM->uw[i];
-                GM.uw[i] = (tmp32u>65535) ? 65535 : tmp32u;
-            }
+            paddusw_64(&GM, EM);
+            NEXT;
+        _0f_0xDE:                   /* PMAXUB Gm,Em */
+            nextop = F8;
+            GET_EM;
+            pmaxub_64(&GM, EM);
             NEXT;
-
         _0f_0xDF:                   /* PANDN Gm,Em */
             nextop = F8;
             GET_EM;
@@ -1070,8 +1058,7 @@
         _0f_0xE0:                   /* PAVGB Gm, Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<8; ++i)
-                    GM.ub[i] = ((uint32_t)GM.ub[i]+EM->ub[i]+1)>>1;
+            pavgb_64(&GM, EM);
             NEXT;
         _0f_0xE1:                   /* PSRAW Gm, Em */
             nextop = F8;
@@ -1095,14 +1082,10 @@
                     GM.sd[i] >>= tmp8u;
             }
             NEXT;
-        _0f_0xE3:                   /* PSRAQ Gm, Em */
+        _0f_0xE3:                   /* PAVGW Gm, Em */
             nextop = F8;
             GET_EM;
-            if(EM->q>63)
-                tmp8u = 64;
-            else
-                tmp8u = EM->ub[0];
-            GM.sq >>= tmp8u;
+            pavgw_64(&GM, EM);
             NEXT;
         _0f_0xE4:                   /* PMULHUW Gm, Em */
             nextop = F8;
@@ -1121,23 +1104,27 @@
             }
             NEXT;
 
+        _0f_0xE7:                   /* MOVNTQ Em, Gm */
+            nextop = F8;
+            GET_EM;
+            EM->q = GM.q;
+            NEXT;
+
         _0f_0xE8:                   /* PSUBSB Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<8; ++i) {
-                tmp32s = (int32_t)GM.sb[i] - EM->sb[i];
-                GM.sb[i] = (tmp32s>127)?127:((tmp32s<-128)?-128:tmp32s);
-            }
+            psubsb_64(&GM, EM);
             NEXT;
         _0f_0xE9:                   /* PSUBSW Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<4; ++i) {
-                tmp32s = (int32_t)GM.sw[i] - EM->sw[i];
-                GM.sw[i] = (tmp32s>32767)?32767:((tmp32s<-32768)?-32768:tmp32s);
-            }
+            psubsw_64(&GM, EM);
+            NEXT;
+        _0f_0xEA:                   /* PMINSW Gm,Em */
+            nextop = F8;
+            GET_EM;
+            pminsw_64(&GM, EM);
             NEXT;
-
         _0f_0xEB:                   /* POR Gm, Em */
             nextop = F8;
             GET_EM;
@@ -1146,20 +1133,18 @@
         _0f_0xEC:                   /* PADDSB Gm, Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<8; ++i) {
-                tmp32s = (int32_t)GM.sb[i] + EM->sb[i];
-                GM.sb[i] = (tmp32s>127)?127:((tmp32s<-128)?-128:tmp32s);
-            }
+            paddsb_64(&GM, EM);
             NEXT;
         _0f_0xED:                   /* PADDSW Gm, Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<4; ++i) {
-                tmp32s = (int32_t)GM.sw[i] + EM->sw[i];
-                GM.sw[i] = (tmp32s>32767)?32767:((tmp32s<-32768)?-32768:tmp32s);
-            }
+            paddsw_64(&GM, EM);
+            NEXT;
+        _0f_0xEE:                   /* PMAXSW Gm,Em */
+            nextop = F8;
+            GET_EM;
+            pmaxsw_64(&GM, EM);
             NEXT;
-
         _0f_0xEF:                   /* PXOR Gm, Em */
             nextop = F8;
             GET_EM;
@@ -1217,41 +1202,47 @@
                 tmp32u += (GM.ub[i]>EM->ub[i])?(GM.ub[i] - EM->ub[i]):(EM->ub[i] - GM.ub[i]);
             GM.q = tmp32u;
             NEXT;
+        _0f_0xF7:                   /* MASKMOVQ Gm, Em */
+            nextop = F8;
+            GET_EM;
+            for (int i=0; i<8; ++i)
+                if(EM->ub[i]&0x80)
+                    ((uint8_t*)(R_EDI))[i] = GM.ub[i];
+            NEXT;
 
         _0f_0xF8:                   /* PSUBB Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<8; ++i)
-                GM.sb[i] -= EM->sb[i];
+            psubb_64(&GM, EM);
             NEXT;
         _0f_0xF9:                   /* PSUBW Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<4; ++i)
-                GM.sw[i] -= EM->sw[i];
+            psubw_64(&GM, EM);
             NEXT;
         _0f_0xFA:                   /* PSUBD Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<2; ++i)
-                GM.sd[i] -= EM->sd[i];
+            psubd_64(&GM, EM);
+            NEXT;
+        _0f_0xFB:                   /* PSUBQ Gm,Em */
+            nextop = F8;
+            GET_EM;
+            psubq_64(&GM, EM);
             NEXT;
 
         _0f_0xFC:                   /* PADDB Gm, Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<8; ++i)
-                GM.sb[i] += EM->sb[i];
+            paddb_64(&GM, EM);
             NEXT;
         _0f_0xFD:                   /* PADDW Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<4; ++i)
-                GM.sw[i] += EM->sw[i];
+            paddw_64(&GM, EM);
             NEXT;
         _0f_0xFE:                   /* PADDD Gm,Em */
             nextop = F8;
             GET_EM;
-            for(int i=0; i<2; ++i)
-                GM.sd[i] += EM->sd[i];
+            paddd_64(&GM, EM);
             NEXT;
@@ -36,23 +36,21 @@
         #include "run660f.h"
         
     _66_0x26:                      /* ES: */
-        // ignored
-        NEXT;
     _66_0x2E:                      /* CS: */
-        // ignored
-        NEXT;
+        // ignored, but the opcode that follows is still a 16bits one
+        goto _0x66;
     _66_0x39:
         nextop = F8;
         GET_EW;
-        cmp16(emu, EW->word[0], GW.word[0]);
+        lazycmp16(emu, EW->word[0], GW.word[0]);
         NEXT;
     _66_0x3B:
         nextop = F8;
         GET_EW;
-        cmp16(emu, GW.word[0], EW->word[0]);
+        lazycmp16(emu, GW.word[0], EW->word[0]);
         NEXT;
     _66_0x3D:
-        cmp16(emu, R_AX, F16);
+        lazycmp16(emu, R_AX, F16);
         NEXT;
     
     _66_0x40:
@@ -142,14 +140,14 @@
             case 4: EW->word[0] = and16(emu, EW->word[0], tmp16u); break;
             case 5: EW->word[0] = sub16(emu, EW->word[0], tmp16u); break;
             case 6: EW->word[0] = xor16(emu, EW->word[0], tmp16u); break;
-            case 7:               cmp16(emu, EW->word[0], tmp16u); break;
+            case 7:               lazycmp16(emu, EW->word[0], tmp16u); break;
         }
         NEXT;
 
     _66_0x85:                              /* TEST Ew,Gw */
         nextop = F8;
         GET_EW;
-        test16(emu, EW->word[0], GW.word[0]);
+        lazytest16(emu, EW->word[0], GW.word[0]);
         NEXT;
 
     _66_0x87:                              /* XCHG Ew,Gw */
@@ -177,6 +175,12 @@
         EW->word[0] = emu->segs[(nextop&38)>>3];
         NEXT;
     
+    _66_0x8D:                              /* LEA Gw,M */
+        nextop = F8;
+        GET_EW;
+        GW.word[0] = (uint16_t)(uintptr_t)EW;
+        NEXT;
+
     _66_0x8E:                               /* MOV Seg,Ew */
         nextop = F8;
         GET_EW;
@@ -190,10 +194,16 @@
     _66_0x90:                              /* NOP */
         NEXT;
 
+    _66_0x91:                              /* XCHG CX,AX */
     _66_0x92:                              /* XCHG DX,AX */
+    _66_0x93:                              /* XCHG BX,AX */
+    _66_0x94:                              /* XCHG SP,AX */
+    _66_0x95:                              /* XCHG BP,AX */
+    _66_0x96:                              /* XCHG SI,AX */
+    _66_0x97:                              /* XCHG DI,AX */
         tmp16u = R_AX;
-        R_AX = R_DX;
-        R_DX = tmp16u;
+        R_AX = emu->regs[opcode&7].word[0];
+        emu->regs[opcode&7].word[0] = tmp16u;
         NEXT;
 
     _66_0x98:                               /* CBW */
@@ -204,9 +214,7 @@
         NEXT;
 
     _66_0x9C:                              /* PUSHFW */
-        CHECK_FLAGS(emu);
-        PackFlags(emu);
-        Push16(emu, (uint16_t)emu->packed_eflags.x32);
+        Push16(emu, (uint16_t)GetPackedFlags(emu));
         NEXT;
 
     _66_0xA1:                              /* MOV AX,Ow */
@@ -228,11 +236,11 @@
         tmp16u2 = *(uint16_t*)R_ESI;
         R_EDI += tmp8s;
         R_ESI += tmp8s;
-        cmp16(emu, tmp16u2, tmp16u);
+        lazycmp16(emu, tmp16u2, tmp16u);
         NEXT;
 
     _66_0xA9:                             /* TEST AX,Iw */
-        test16(emu, R_AX, F16);
+        lazytest16(emu, R_AX, F16);
         NEXT;
 
     _66_0xAB:                              /* STOSW */
@@ -247,7 +255,7 @@
         NEXT;
     _66_0xAF:                              /* SCASW */
         tmp8s = ACCESS_FLAG(F_DF)?-2:+2;
-        cmp16(emu, R_AX, *(uint16_t*)R_EDI);
+        lazycmp16(emu, R_AX, *(uint16_t*)R_EDI);
         R_EDI += tmp8s;
         NEXT;
 
@@ -344,7 +352,7 @@
                     if((tmp16u==tmp16u2)==(opcode==0xF2))
                         break;
                 }
-                if(R_ECX) cmp16(emu, tmp16u2, tmp16u);
+                if(R_ECX) lazycmp16(emu, tmp16u2, tmp16u);
                 break;
             case 0xAB:              /* REP STOSW */
                 while(tmp32u) {
@@ -369,7 +377,7 @@
                     if((R_AX==tmp16u)==(opcode==0xF2))
                         break;
                 }
-                if(R_ECX) cmp16(emu, R_AX, tmp16u);
+                if(R_ECX) lazycmp16(emu, R_AX, tmp16u);
                 break;
             default:
                 goto _default;
@@ -383,7 +391,7 @@
         switch((nextop>>3)&7) {
             case 0: 
             case 1:                 /* TEST Ew,Iw */
-                test16(emu, EW->word[0], F16);
+                lazytest16(emu, EW->word[0], F16);
                 break;
             case 2:                 /* NOT Ew */
                 EW->word[0] = not16(emu, EW->word[0]);
@@ -416,6 +424,9 @@
             case 1:                 /* DEC Ed */
                 EW->word[0] = dec16(emu, EW->word[0]);
                 break;
+            case 6:                 /* PUSH Ew */
+                Push16(emu, EW->word[0]);
+                break;
             default:
                 emu->old_ip = old_ip;
                 R_EIP = ip;
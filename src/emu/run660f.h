@@ -4,88 +4,87 @@
     #define GOCOND(BASE, PREFIX, CONDITIONAL) \
     _6f_##BASE##_0:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_OF))               \
+        if(EvalCond(emu, 0x0))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_1:                          \
         PREFIX                              \
-        if(!ACCESS_FLAG(F_OF))              \
+        if(EvalCond(emu, 0x1))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_2:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_CF))               \
+        if(EvalCond(emu, 0x2))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_3:                          \
         PREFIX                              \
-        if(!ACCESS_FLAG(F_CF))              \
+        if(EvalCond(emu, 0x3))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_4:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_ZF))               \
+        if(EvalCond(emu, 0x4))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_5:                          \
         PREFIX                              \
-        if(!ACCESS_FLAG(F_ZF))              \
+        if(EvalCond(emu, 0x5))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_6:                          \
         PREFIX                              \
-        if((ACCESS_FLAG(F_ZF) || ACCESS_FLAG(F_CF)))  \
+        if(EvalCond(emu, 0x6))                        \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_7:                          \
         PREFIX                              \
-        if(!(ACCESS_FLAG(F_ZF) || ACCESS_FLAG(F_CF))) \
+        if(EvalCond(emu, 0x7))                        \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_8:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_SF))               \
+        if(EvalCond(emu, 0x8))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_9:                          \
         PREFIX                              \
-        if(!ACCESS_FLAG(F_SF))              \
+        if(EvalCond(emu, 0x9))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_A:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_PF))               \
+        if(EvalCond(emu, 0xA))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_B:                          \
         PREFIX                              \
-        if(!ACCESS_FLAG(F_PF))              \
+        if(EvalCond(emu, 0xB))              \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_C:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF))  \
+        if(EvalCond(emu, 0xC))                      \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_D:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_SF) == ACCESS_FLAG(F_OF)) \
+        if(EvalCond(emu, 0xD))                     \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_E:                          \
         PREFIX                              \
-        if(ACCESS_FLAG(F_ZF) || (ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF))) \
+        if(EvalCond(emu, 0xE))                                            \
             CONDITIONAL                     \
         NEXT;                              \
     _6f_##BASE##_F:                          \
         PREFIX                              \
-        if(!ACCESS_FLAG(F_ZF) && (ACCESS_FLAG(F_SF) == ACCESS_FLAG(F_OF))) \
+        if(EvalCond(emu, 0xF))                                             \
             CONDITIONAL                     \
         NEXT;
 
     GOCOND(0x40
         , nextop = F8;
-        CHECK_FLAGS(emu);
         GET_EW;
         , GW.word[0] = EW->word[0];
     )                               /* 0x40 -> 0x4F CMOVxx Gw,Ew */ // conditional move, no sign
@@ -204,53 +203,444 @@
         CLEAR_FLAG(F_OF); CLEAR_FLAG(F_AF); CLEAR_FLAG(F_SF);
         NEXT;
 
-    _6f_0x38:  // these are some SSE3 opcodes
+    _6f_0x38:  // SSSE3 and SSE4.1 opcodes
         opcode = F8;
         switch(opcode) {
-            case 0x00:  // PSHUFB
+            case 0x00:  /* PSHUFB Gx, Ex */
                 nextop = F8;
                 GET_EX;
-                eax1 = GX;
-                for (int i=0; i<15; ++i) {
-                    if(EX->ub[i]&128)
-                        GX.ub[i] = 0;
-                    else
-                        GX.ub[i] = eax1.ub[EX->ub[i]&15];
-                }
+                pshufb_128(&GX, EX);
+                break;
+            case 0x01:  /* PHADDW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                phaddw_128(&GX, EX);
+                break;
+            case 0x02:  /* PHADDD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                phaddd_128(&GX, EX);
+                break;
+            case 0x03:  /* PHADDSW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                phaddsw_128(&GX, EX);
+                break;
+            case 0x04:  /* PMADDUBSW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                pmaddubsw_128(&GX, EX);
+                break;
+            case 0x05:  /* PHSUBW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                phsubw_128(&GX, EX);
+                break;
+            case 0x06:  /* PHSUBD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                phsubd_128(&GX, EX);
+                break;
+            case 0x07:  /* PHSUBSW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                phsubsw_128(&GX, EX);
+                break;
+            case 0x08:  /* PSIGNB Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                psignb_128(&GX, EX);
+                break;
+            case 0x09:  /* PSIGNW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                psignw_128(&GX, EX);
+                break;
+            case 0x0A:  /* PSIGND Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                psignd_128(&GX, EX);
+                break;
+            case 0x0B:  /* PMULHRSW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                pmulhrsw_128(&GX, EX);
+                break;
+
+            case 0x10:  /* PBLENDVB Gx, Ex, XMM0 */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<16; ++i)
+                    if(emu->xmm[0].ub[i]&0x80)
+                        GX.ub[i] = EX->ub[i];
+                break;
+            case 0x14:  /* BLENDVPS Gx, Ex, XMM0 */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<4; ++i)
+                    if(emu->xmm[0].ud[i]&0x80000000)
+                        GX.ud[i] = EX->ud[i];
+                break;
+            case 0x15:  /* BLENDVPD Gx, Ex, XMM0 */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<2; ++i)
+                    if(emu->xmm[0].q[i]&0x8000000000000000LL)
+                        GX.q[i] = EX->q[i];
+                break;
+            case 0x17:  /* PTEST Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                RESET_FLAGS(emu);
+                CONDITIONAL_SET_FLAG(!((GX.q[0]&EX->q[0])|(GX.q[1]&EX->q[1])), F_ZF);
+                CONDITIONAL_SET_FLAG(!(((~GX.q[0])&EX->q[0])|((~GX.q[1])&EX->q[1])), F_CF);
+                CLEAR_FLAG(F_OF); CLEAR_FLAG(F_AF); CLEAR_FLAG(F_SF); CLEAR_FLAG(F_PF);
+                break;
+
+            case 0x1C:  /* PABSB Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                pabsb_128(&GX, EX);
+                break;
+            case 0x1D:  /* PABSW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                pabsw_128(&GX, EX);
+                break;
+            case 0x1E:  /* PABSD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                pabsd_128(&GX, EX);
+                break;
+
+            case 0x20:  /* PMOVSXBW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<8; ++i)
+                    GX.sw[i] = eax1.sb[i];
+                break;
+            case 0x21:  /* PMOVSXBD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<4; ++i)
+                    GX.sd[i] = eax1.sb[i];
+                break;
+            case 0x22:  /* PMOVSXBQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<2; ++i)
+                    GX.sq[i] = eax1.sb[i];
+                break;
+            case 0x23:  /* PMOVSXWD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<4; ++i)
+                    GX.sd[i] = eax1.sw[i];
+                break;
+            case 0x24:  /* PMOVSXWQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<2; ++i)
+                    GX.sq[i] = eax1.sw[i];
+                break;
+            case 0x25:  /* PMOVSXDQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<2; ++i)
+                    GX.sq[i] = eax1.sd[i];
+                break;
+
+            case 0x28:  /* PMULDQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                GX.sq[1] = (int64_t)GX.sd[2] * EX->sd[2];
+                GX.sq[0] = (int64_t)GX.sd[0] * EX->sd[0];
+                break;
+            case 0x29:  /* PCMPEQQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<2; ++i)
+                    GX.q[i] = (GX.q[i]==EX->q[i])?0xffffffffffffffffLL:0;
+                break;
+            case 0x2A:  /* MOVNTDQA Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                GX = *EX;
+                break;
+            case 0x2B:  /* PACKUSDW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<4; ++i)
+                    GX.uw[i] = (GX.sd[i]<0)?0:((GX.sd[i]>65535)?65535:GX.sd[i]);
+                for(int i=0; i<4; ++i)
+                    GX.uw[4+i] = (eax1.sd[i]<0)?0:((eax1.sd[i]>65535)?65535:eax1.sd[i]);
+                break;
+
+            case 0x30:  /* PMOVZXBW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<8; ++i)
+                    GX.uw[i] = eax1.ub[i];
+                break;
+            case 0x31:  /* PMOVZXBD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<4; ++i)
+                    GX.ud[i] = eax1.ub[i];
+                break;
+            case 0x32:  /* PMOVZXBQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<2; ++i)
+                    GX.q[i] = eax1.ub[i];
+                break;
+            case 0x33:  /* PMOVZXWD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<4; ++i)
+                    GX.ud[i] = eax1.uw[i];
+                break;
+            case 0x34:  /* PMOVZXWQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<2; ++i)
+                    GX.q[i] = eax1.uw[i];
+                break;
+            case 0x35:  /* PMOVZXDQ Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                eax1 = *EX;
+                for(int i=0; i<2; ++i)
+                    GX.q[i] = eax1.ud[i];
+                break;
+
+            case 0x38:  /* PMINSB Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<16; ++i)
+                    if(EX->sb[i]<GX.sb[i]) GX.sb[i] = EX->sb[i];
+                break;
+            case 0x39:  /* PMINSD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<4; ++i)
+                    if(EX->sd[i]<GX.sd[i]) GX.sd[i] = EX->sd[i];
+                break;
+            case 0x3A:  /* PMINUW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<8; ++i)
+                    if(EX->uw[i]<GX.uw[i]) GX.uw[i] = EX->uw[i];
+                break;
+            case 0x3B:  /* PMINUD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<4; ++i)
+                    if(EX->ud[i]<GX.ud[i]) GX.ud[i] = EX->ud[i];
+                break;
+            case 0x3C:  /* PMAXSB Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<16; ++i)
+                    if(EX->sb[i]>GX.sb[i]) GX.sb[i] = EX->sb[i];
+                break;
+            case 0x3D:  /* PMAXSD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<4; ++i)
+                    if(EX->sd[i]>GX.sd[i]) GX.sd[i] = EX->sd[i];
+                break;
+            case 0x3E:  /* PMAXUW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<8; ++i)
+                    if(EX->uw[i]>GX.uw[i]) GX.uw[i] = EX->uw[i];
+                break;
+            case 0x3F:  /* PMAXUD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<4; ++i)
+                    if(EX->ud[i]>GX.ud[i]) GX.ud[i] = EX->ud[i];
+                break;
+            case 0x40:  /* PMULLD Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                for(int i=0; i<4; ++i)
+                    GX.ud[i] *= EX->ud[i];
+                break;
+            case 0x41:  /* PHMINPOSUW Gx, Ex */
+                nextop = F8;
+                GET_EX;
+                tmp8u = 0;
+                for(int i=1; i<8; ++i)
+                    if(EX->uw[i]<EX->uw[tmp8u]) tmp8u = i;
+                GX.uw[0] = EX->uw[tmp8u];
+                GX.uw[1] = tmp8u;
+                GX.ud[1] = 0;
+                GX.q[1] = 0;
                 break;
             default:
                 goto _default;
         }
         NEXT;
 
-    _6f_0x3A:  // these are some SSE3 opcodes
+    _6f_0x3A:  // SSSE3 and SSE4.1 opcodes
         opcode = F8;
         switch(opcode) {
-            case 0x0F:          // PALIGNR
+            case 0x08:  /* ROUNDPS Gx, Ex, Ib */
+            case 0x0A:  /* ROUNDSS Gx, Ex, Ib */
                 nextop = F8;
                 GET_EX;
                 tmp8u = F8;
-                if(tmp8u>31)
-                    {EX->q[0] = EX->q[1] = 0;}
-                else if(tmp8u>15) {
-                    tmp8u=(tmp8u-16)*8;
-                    if (tmp8u < 64) {
-                        GX.q[0] = (EX->q[0] >> tmp8u) | (EX->q[1] << (64 - tmp8u));
-                        GX.q[1] = (EX->q[1] >> tmp8u);
-                    } else {
-                        GX.q[0] = EX->q[1] >> (tmp8u - 64);
-                        GX.q[1] = 0;
-                    }                    
-                } else {
-                    tmp8u*=8;
-                    if (tmp8u < 64) {
-                        GX.q[0] = (GX.q[0] >> tmp8u) | (GX.q[1] << (64 - tmp8u));
-                        GX.q[1] = (GX.q[1] >> tmp8u) | (EX->q[0] << (64-tmp8u));
-                    } else {
-                        GX.q[0] = GX.q[1] >> (tmp8u - 64) | (EX->q[0] << (tmp8u));
-                        GX.q[1] = (EX->q[0] << (64-tmp8u)) | (EX->q[1] >> (tmp8u - 64));
-                    }                    
+                tmp8u = (tmp8u&4)?((emu->mxcsr>>13)&3):(tmp8u&3);   // MXCSR.RC or imm8
+                for(int i=0; i<((opcode==0x08)?4:1); ++i)
+                    switch(tmp8u) {
+                        case ROUND_Nearest: GX.f[i] = nearbyintf(EX->f[i]); break;
+                        case ROUND_Down:    GX.f[i] = floorf(EX->f[i]); break;
+                        case ROUND_Up:      GX.f[i] = ceilf(EX->f[i]); break;
+                        case ROUND_Chop:    GX.f[i] = truncf(EX->f[i]); break;
+                    }
+                break;
+            case 0x09:  /* ROUNDPD Gx, Ex, Ib */
+            case 0x0B:  /* ROUNDSD Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                tmp8u = (tmp8u&4)?((emu->mxcsr>>13)&3):(tmp8u&3);   // MXCSR.RC or imm8
+                for(int i=0; i<((opcode==0x09)?2:1); ++i)
+                    switch(tmp8u) {
+                        case ROUND_Nearest: GX.d[i] = nearbyint(EX->d[i]); break;
+                        case ROUND_Down:    GX.d[i] = floor(EX->d[i]); break;
+                        case ROUND_Up:      GX.d[i] = ceil(EX->d[i]); break;
+                        case ROUND_Chop:    GX.d[i] = trunc(EX->d[i]); break;
+                    }
+                break;
+            case 0x0C:  /* BLENDPS Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                for(int i=0; i<4; ++i)
+                    if(tmp8u&(1<<i))
+                        GX.ud[i] = EX->ud[i];
+                break;
+            case 0x0D:  /* BLENDPD Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                for(int i=0; i<2; ++i)
+                    if(tmp8u&(1<<i))
+                        GX.q[i] = EX->q[i];
+                break;
+            case 0x0E:  /* PBLENDW Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                for(int i=0; i<8; ++i)
+                    if(tmp8u&(1<<i))
+                        GX.uw[i] = EX->uw[i];
+                break;
+            case 0x0F:  /* PALIGNR Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                palignr_128(&GX, EX, tmp8u);
+                break;
+
+            case 0x14:  /* PEXTRB Ed, Gx, Ib */
+                nextop = F8;
+                GET_ED;
+                tmp8u = F8;
+                if((nextop&0xC0)==0xC0)
+                    ED->dword[0] = GX.ub[tmp8u&15];
+                else
+                    ED->byte[0] = GX.ub[tmp8u&15];
+                break;
+            case 0x15:  /* PEXTRW Ew, Gx, Ib */
+                nextop = F8;
+                GET_ED;
+                tmp8u = F8;
+                if((nextop&0xC0)==0xC0)
+                    ED->dword[0] = GX.uw[tmp8u&7];
+                else
+                    ED->word[0] = GX.uw[tmp8u&7];
+                break;
+            case 0x16:  /* PEXTRD Ed, Gx, Ib */
+            case 0x17:  /* EXTRACTPS Ed, Gx, Ib */
+                nextop = F8;
+                GET_ED;
+                tmp8u = F8;
+                ED->dword[0] = GX.ud[tmp8u&3];
+                break;
+
+            case 0x20:  /* PINSRB Gx, Eb, Ib */
+                nextop = F8;
+                GET_ED;
+                tmp8u = F8;
+                GX.ub[tmp8u&15] = ED->byte[0];
+                break;
+            case 0x21:  /* INSERTPS Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                if((nextop&0xC0)==0xC0)
+                    tmp32u = EX->ud[(tmp8u>>6)&3];
+                else
+                    tmp32u = EX->ud[0];
+                GX.ud[(tmp8u>>4)&3] = tmp32u;
+                for(int i=0; i<4; ++i)
+                    if(tmp8u&(1<<i))
+                        GX.ud[i] = 0;
+                break;
+            case 0x22:  /* PINSRD Gx, Ed, Ib */
+                nextop = F8;
+                GET_ED;
+                tmp8u = F8;
+                GX.ud[tmp8u&3] = ED->dword[0];
+                break;
+
+            case 0x40:  /* DPPS Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                for(int i=0; i<4; ++i)
+                    eax1.f[i] = (tmp8u&(16<<i))?(GX.f[i]*EX->f[i]):0.0f;
+                f = (eax1.f[0]+eax1.f[1])+(eax1.f[2]+eax1.f[3]);
+                for(int i=0; i<4; ++i)
+                    GX.f[i] = (tmp8u&(1<<i))?f:0.0f;
+                break;
+            case 0x41:  /* DPPD Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                for(int i=0; i<2; ++i)
+                    eax1.d[i] = (tmp8u&(16<<i))?(GX.d[i]*EX->d[i]):0.0;
+                d = eax1.d[0]+eax1.d[1];
+                for(int i=0; i<2; ++i)
+                    GX.d[i] = (tmp8u&(1<<i))?d:0.0;
+                break;
+            case 0x42:  /* MPSADBW Gx, Ex, Ib */
+                nextop = F8;
+                GET_EX;
+                tmp8u = F8;
+                for(int i=0; i<8; ++i) {
+                    tmp16u = 0;
+                    for(int j=0; j<4; ++j)
+                        tmp16u += abs(GX.ub[((tmp8u>>2)&1)*4+i+j] - EX->ub[(tmp8u&3)*4+j]);
+                    eax1.uw[i] = tmp16u;
                 }
+                GX = eax1;
                 break;
             default:
                 goto _default;
@@ -274,38 +664,32 @@
     _6f_0x54:                      /* ANDPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.q[0] &= EX->q[0];
-        GX.q[1] &= EX->q[1];
+        pand_128(&GX, EX);
         NEXT;
     _6f_0x55:                      /* ANDNPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.q[0] = (~GX.q[0]) & EX->q[0];
-        GX.q[1] = (~GX.q[1]) & EX->q[1];
+        pandn_128(&GX, EX);
         NEXT;
     _6f_0x56:                      /* ORPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.q[0] |= EX->q[0];
-        GX.q[1] |= EX->q[1];
+        por_128(&GX, EX);
         NEXT;
     _6f_0x57:                      /* XORPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.q[0] ^= EX->q[0];
-        GX.q[1] ^= EX->q[1];
+        pxor_128(&GX, EX);
         NEXT;
     _6f_0x58:                      /* ADDPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.d[0] += EX->d[0];
-        GX.d[1] += EX->d[1];
+        addpd(&GX, EX);
         NEXT;
     _6f_0x59:                      /* MULPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.d[0] *= EX->d[0];
-        GX.d[1] *= EX->d[1];
+        mulpd(&GX, EX);
         NEXT;
     _6f_0x5A:                      /* CVTPD2PS Gx, Ex */
         nextop = F8;
@@ -325,8 +709,7 @@
     _6f_0x5C:                      /* SUBPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.d[0] -= EX->d[0];
-        GX.d[1] -= EX->d[1];
+        subpd(&GX, EX);
         NEXT;
     _6f_0x5D:                      /* MINPD Gx, Ex */
         nextop = F8;
@@ -339,8 +722,7 @@
     _6f_0x5E:                      /* DIVPD Gx, Ex */
         nextop = F8;
         GET_EX;
-        GX.d[0] /= EX->d[0];
-        GX.d[1] /= EX->d[1];
+        divpd(&GX, EX);
         NEXT;
     _6f_0x5F:                      /* MAXPD Gx, Ex */
         nextop = F8;
@@ -385,20 +767,17 @@
     _6f_0x64:  /* PCMPGTB Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<16; ++i)
-            GX.ub[i] = (GX.sb[i]>EX->sb[i])?0xFF:0x00;
+        pcmpgtb_128(&GX, EX);
         NEXT;
     _6f_0x65:  /* PCMPGTW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i)
-            GX.uw[i] = (GX.sw[i]>EX->sw[i])?0xFFFF:0x0000;
+        pcmpgtw_128(&GX, EX);
         NEXT;
     _6f_0x66:  /* PCMPGTD Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<4; ++i)
-            GX.ud[i] = (GX.sd[i]>EX->sd[i])?0xFFFFFFFF:0x00000000;
+        pcmpgtd_128(&GX, EX);
         NEXT;
     _6f_0x67:  /* PACKUSWB */
         nextop = F8;
@@ -582,22 +961,33 @@
     _6f_0x74:  /* PCMPEQB Gx,Ex */
         nextop = F8;
         GET_EX;
-        for (int i=0; i<16; ++i)
-            GX.ub[i] = (GX.ub[i]==EX->ub[i])?0xff:0;
+        pcmpeqb_128(&GX, EX);
         NEXT;
     _6f_0x75:  /* PCMPEQW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for (int i=0; i<8; ++i)
-            GX.uw[i] = (GX.uw[i]==EX->uw[i])?0xffff:0;
+        pcmpeqw_128(&GX, EX);
         NEXT;
     _6f_0x76:  /* PCMPEQD Gx,Ex */
         nextop = F8;
         GET_EX;
-        for (int i=0; i<4; ++i)
-            GX.ud[i] = (GX.ud[i]==EX->ud[i])?0xffffffff:0;
+        pcmpeqd_128(&GX, EX);
         NEXT;
 
+    _6f_0x7C:  /* HADDPD Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        eax1 = *EX;
+        GX.d[0] += GX.d[1];
+        GX.d[1] = eax1.d[0] + eax1.d[1];
+        NEXT;
+    _6f_0x7D:  /* HSUBPD Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        eax1 = *EX;
+        GX.d[0] -= GX.d[1];
+        GX.d[1] = eax1.d[0] - eax1.d[1];
+        NEXT;
     _6f_0x7E:  /* MOVD Ed, Gx */
         nextop = F8;
         GET_ED;
@@ -680,6 +1070,32 @@
         GW.word[0] = EB->byte[0];
         NEXT;
 
+    _6f_0xBA:                      /* GRP8 Ew,Ib */
+        nextop = F8;
+        if(!(nextop&0x20))          // only BT, BTS, BTR and BTC
+            goto _default;
+        CHECK_FLAGS(emu);
+        GET_EW;
+        tmp8u = F8&15;
+        if(EW->word[0] & (1<<tmp8u))
+            SET_FLAG(F_CF);
+        else
+            CLEAR_FLAG(F_CF);
+        switch((nextop>>3)&7) {
+            case 4:                 /* BT Ew,Ib */
+                break;
+            case 5:                 /* BTS Ew,Ib */
+                EW->word[0] |= (1<<tmp8u);
+                break;
+            case 6:                 /* BTR Ew,Ib */
+                EW->word[0] &= ~(1<<tmp8u);
+                break;
+            case 7:                 /* BTC Ew,Ib */
+                EW->word[0] ^= (1<<tmp8u);
+                break;
+        }
+        NEXT;
+
     _6f_0xBB:                      /* BTC Ew,Gw */
         CHECK_FLAGS(emu);
         nextop = F8;
@@ -773,6 +1189,12 @@
         GX.q[1] = eax1.q[1];
         NEXT;
 
+    _6f_0xD0:  /* ADDSUBPD Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        GX.d[0] -= EX->d[0];
+        GX.d[1] += EX->d[1];
+        NEXT;
     _6f_0xD1:  /* PSRLW Gx, Ex */
         nextop = F8;
         GET_EX;
@@ -800,16 +1222,12 @@
     _6f_0xD4:  /* PADDQ Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.sq[0] += EX->sq[0];
-        GX.sq[1] += EX->sq[1];
+        paddq_128(&GX, EX);
         NEXT;
     _6f_0xD5:  /* PMULLW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i) {
-            tmp32s = (int32_t)GX.sw[i] * EX->sw[i];
-            GX.sw[i] = tmp32s;
-        }
+        pmullw_128(&GX, EX);
         NEXT;
     _6f_0xD6:  /* MOVQ Ex,Gx */
         nextop = F8;
@@ -829,46 +1247,34 @@
     _6f_0xD8:  /* PSUBUSB Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<16; ++i) {
-            tmp16s = (int16_t)GX.ub[i] - EX->ub[i];
-            GX.ub[i] = (tmp16s<0)?0:((tmp16s>255)?255:tmp16s);
-        }
+        psubusb_128(&GX, EX);
         NEXT;
     _6f_0xD9:  /* PSUBUSW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i) {
-            tmp32s = (int32_t)GX.uw[i] - EX->uw[i];
-            GX.uw[i] = (tmp32s<0)?0:((tmp32s>0xffff)?0xffff:tmp32s);
-        }
+        psubusw_128(&GX, EX);
         NEXT;
 
     _6f_0xDB:  /* PAND Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.q[0] &= EX->q[0];
-        GX.q[1] &= EX->q[1];
+        pand_128(&GX, EX);
         NEXT;
     _6f_0xDC:  /* PADDUSB Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<16; ++i) {
-            tmp16s = (int16_t)GX.ub[i] + EX->ub[i];
-            GX.ub[i] = (tmp16s>255)?255:tmp16s;
-        }
+        paddusb_128(&GX, EX);
         NEXT;
 
     _6f_0xDE:  /* PMAXUB Gx, Ex */
         nextop = F8;
         GET_EX;
-        for (int i=0; i<16; ++i)
-            if(EX->ub[i]>GX.ub[i]) GX.ub[i] = EX->ub[i];
+        pmaxub_128(&GX, EX);
         NEXT;
     _6f_0xDF:  /* PANDN Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.q[0] = (~GX.q[0]) & EX->q[0];
-        GX.q[1] = (~GX.q[1]) & EX->q[1];
+        pandn_128(&GX, EX);
         NEXT;
 
     _6f_0xE1:  /* PSRAW Gx, Ex */
@@ -908,62 +1314,42 @@
     _6f_0xE8:  /* PSUBSB Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<16; ++i) {
-            tmp16s = (int16_t)GX.sb[i] - EX->sb[i];
-            GX.ub[i] = (tmp16s<-128)?-128:((tmp16s>127)?127:tmp16s);
-        }
+        psubsb_128(&GX, EX);
         NEXT;
     _6f_0xE9:  /* PSUBSW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i) {
-            tmp32s = (int32_t)GX.sw[i] - EX->sw[i];
-            GX.sw[i] = (tmp32s>32767)?32767:((tmp32s<-32768)?-32768:tmp32s);
-        }
+        psubsw_128(&GX, EX);
         NEXT;
     _6f_0xEA:  /* PMINSW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for (int i=0; i<8; ++i)
-            GX.sw[i] = (GX.sw[i]<EX->sw[i])?GX.sw[i]:EX->sw[i];
+        pminsw_128(&GX, EX);
         NEXT;
     _6f_0xEB:  /* POR Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.ud[0] |= EX->ud[0];
-        GX.ud[1] |= EX->ud[1];
-        GX.ud[2] |= EX->ud[2];
-        GX.ud[3] |= EX->ud[3];
+        por_128(&GX, EX);
         NEXT;
     _6f_0xEC:  /* PADDSB Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<16; ++i) {
-            tmp16s = (int16_t)GX.sb[i] + EX->sb[i];
-            GX.sb[i] = (tmp16s>127)?127:((tmp16s<-128)?-128:tmp16s);
-        }
+        paddsb_128(&GX, EX);
         NEXT;
     _6f_0xED:  /* PADDSW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i) {
-            tmp32s = (int32_t)GX.sw[i] + EX->sw[i];
-            GX.sw[i] = (tmp32s>32767)?32767:((tmp32s<-32768)?-32768:tmp32s);
-        }
+        paddsw_128(&GX, EX);
         NEXT;
     _6f_0xEE:  /* PMAXSW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i)
-            GX.sw[i] = (GX.sw[i]>EX->sw[i])?GX.sw[i]:EX->sw[i];
+        pmaxsw_128(&GX, EX);
         NEXT;
     _6f_0xEF:  /* PXOR Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.ud[0] ^= EX->ud[0];
-        GX.ud[1] ^= EX->ud[1];
-        GX.ud[2] ^= EX->ud[2];
-        GX.ud[3] ^= EX->ud[3];
+        pxor_128(&GX, EX);
         NEXT;
 
     _6f_0xF1:  /* PSLLW Gx, Ex */
@@ -1027,42 +1413,32 @@
     _6f_0xF9:  /* PSUBW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i)
-            GX.uw[i] -= EX->uw[i];
+        psubw_128(&GX, EX);
         NEXT;
     _6f_0xFA:  /* PSUBD Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.sd[0] -= EX->sd[0];
-        GX.sd[1] -= EX->sd[1];
-        GX.sd[2] -= EX->sd[2];
-        GX.sd[3] -= EX->sd[3];
+        psubd_128(&GX, EX);
         NEXT;
     _6f_0xFB:  /* PSUBQ Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.sq[0] -= EX->sq[0];
-        GX.sq[1] -= EX->sq[1];
+        psubq_128(&GX, EX);
         NEXT;
     _6f_0xFC:  /* PADDB Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<16; ++i)
-            GX.sb[i] += EX->sb[i];
+        paddb_128(&GX, EX);
         NEXT;
     _6f_0xFD:  /* PADDW Gx,Ex */
         nextop = F8;
         GET_EX;
-        for(int i=0; i<8; ++i)
-            GX.sw[i] += EX->sw[i];
+        paddw_128(&GX, EX);
         NEXT;
     _6f_0xFE:  /* PADDD Gx,Ex */
         nextop = F8;
         GET_EX;
-        GX.sd[0] += EX->sd[0];
-        GX.sd[1] += EX->sd[1];
-        GX.sd[2] += EX->sd[2];
-        GX.sd[3] += EX->sd[3];
+        paddd_128(&GX, EX);
         NEXT;
 
 
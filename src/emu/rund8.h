@@ -98,7 +98,7 @@
             #ifdef USE_FLOAT
             ST0.f /= ST(nextop&7).f;
             #else
-            ST0.d /= ST(nextop&7).d;
+            ST0.d = fpu_div(ST0.d, ST(nextop&7).d);
             #endif
             break;
         case 0xF8:
@@ -112,7 +112,7 @@
             #ifdef USE_FLOAT
             ST0.f = ST(nextop&7).f / ST0.f;
             #else
-            ST0.d = ST(nextop&7).d / ST0.d;
+            ST0.d = fpu_div(ST(nextop&7).d, ST0.d);
             #endif
             break;
         default:
@@ -207,36 +207,26 @@
             case 6:         /* FDIV ST0, float */
                 GET_ED;
                 if(!(((uintptr_t)ED)&3))
-                    #ifdef USE_FLOAT
-                    ST0.f /= *(float*)ED;
-                    #else
-                    ST0.d /= *(float*)ED;
-                    #endif
-                else {
+                    f = *(float*)ED;
+                else
                     *(uint32_t*)&f = ED->dword[0];
-                    #ifdef USE_FLOAT
-                    ST0.f /= f;
-                    #else
-                    ST0.d /= f;
-                    #endif
-                }
+                #ifdef USE_FLOAT
+                ST0.f /= f;
+                #else
+                ST0.d = fpu_div(ST0.d, f);
+                #endif
                 break;
             case 7:         /* FDIVR ST0, float */
                 GET_ED;
                 if(!(((uintptr_t)ED)&3))
-                    #ifdef USE_FLOAT
-                    ST0.f = *(float*)ED / ST0.f;
-                    #else
-                    ST0.d = *(float*)ED / ST0.d;
-                    #endif
-                else {
+                    f = *(float*)ED;
+                else
                     *(uint32_t*)&f = ED->dword[0];
-                    #ifdef USE_FLOAT
-                    ST0.f = f / ST0.f;
-                    #else
-                    ST0.d = f / ST0.d;
-                    #endif
-                }
+                #ifdef USE_FLOAT
+                ST0.f = f / ST0.f;
+                #else
+                ST0.d = fpu_div(f, ST0.d);
+                #endif
                 break;
             default:
                 goto _default;
@@ -113,14 +113,20 @@
             #ifdef USE_FLOAT
             ST0.f = exp2f(ST0.f) - 1.0f;
             #else
-            ST0.d = exp2(ST0.d) - 1.0;
+            if(box86_x87_precision==X87_FLOAT)
+                ST0.d = exp2f(ST0.d) - 1.0;
+            else
+                ST0.d = exp2(ST0.d) - 1.0;
             #endif
             break;
         case 0xF1:  /* FYL2X */
             #ifdef USE_FLOAT
             ST(1).f = log2f(ST0.f)*ST(1).f;
             #else
-            ST(1).d = log2(ST0.d)*ST(1).d;
+            if(box86_x87_precision==X87_FLOAT)
+                ST(1).d = log2f(ST0.d)*ST(1).d;
+            else
+                ST(1).d = log2(ST0.d)*ST(1).d;
             #endif
             fpu_do_pop(emu);
             break;
@@ -130,7 +136,10 @@
             fpu_do_push(emu);
             ST0.f = 1.0f;
             #else
-            ST0.d = tan(ST0.d);
+            if(box86_x87_precision==X87_FLOAT)
+                ST0.d = tanf(ST0.d);
+            else
+                ST0.d = tan(ST0.d);
             fpu_do_push(emu);
             ST0.d = 1.0;
             #endif
@@ -139,7 +148,10 @@
             #ifdef USE_FLOAT
             ST1.f = atan2f(ST1.f, ST0.f);
             #else
-            ST1.d = atan2(ST1.d, ST0.d);
+            if(box86_x87_precision==X87_FLOAT)
+                ST1.d = atan2f(ST1.d, ST0.d);
+            else
+                ST1.d = atan2(ST1.d, ST0.d);
             #endif
             fpu_do_pop(emu);
             break;
@@ -208,7 +220,10 @@
             #ifdef USE_FLOAT
             ST(1).f = log2f(ST0.f + 1.0f)*ST(1).f;
             #else
-            ST(1).d = log2(ST0.d + 1.0)*ST(1).d;
+            if(box86_x87_precision==X87_FLOAT)
+                ST(1).d = log2f(ST0.d + 1.0)*ST(1).d;
+            else
+                ST(1).d = log2(ST0.d + 1.0)*ST(1).d;
             #endif
             fpu_do_pop(emu);
             break;
@@ -216,7 +231,10 @@
             #ifdef USE_FLOAT
             ST0.f = sqrtf(ST0.f);
             #else
-            ST0.d = sqrt(ST0.d);
+            if(box86_x87_precision==X87_FLOAT)
+                ST0.d = sqrtf(ST0.d);
+            else
+                ST0.d = sqrt(ST0.d);
             #endif
             break;
         case 0xFB:  /* FSINCOS */
@@ -224,7 +242,11 @@
             #ifdef USE_FLOAT
             sincosf(ST1.f, &ST1.f, &ST0.f);
             #else
-            sincos(ST1.d, &ST1.d, &ST0.d);
+            if(box86_x87_precision==X87_FLOAT) {
+                ST0.d = cosf(ST1.d);
+                ST1.d = sinf(ST1.d);
+            } else
+                sincos(ST1.d, &ST1.d, &ST0.d);
             #endif
             break;
         case 0xFC:  /* FRNDINT */
@@ -239,21 +261,30 @@
             #ifdef USE_FLOAT
             ST0.f *= exp2f(truncf(ST1.f));
             #else
-            ST0.d *= exp2(trunc(ST1.d));
+            if(isfinite(ST1.d))
+                ST0.d = ldexp(ST0.d, (ST1.d>3066.0)?3066:((ST1.d<-3066.0)?-3066:(int)ST1.d));  // more than enough for double range
+            else
+                ST0.d *= exp2(ST1.d);
             #endif
             break;
         case 0xFE:  /* FSIN */
             #ifdef USE_FLOAT
             ST0.f = sinf(ST0.f);
             #else
-            ST0.d = sin(ST0.d);
+            if(box86_x87_precision==X87_FLOAT)
+                ST0.d = sinf(ST0.d);
+            else
+                ST0.d = sin(ST0.d);
             #endif
             break;
         case 0xFF:  /* FCOS */
             #ifdef USE_FLOAT
             ST0.f = cosf(ST0.f);
             #else
-            ST0.d = cos(ST0.d);
+            if(box86_x87_precision==X87_FLOAT)
+                ST0.d = cosf(ST0.d);
+            else
+                ST0.d = cos(ST0.d);
             #endif
             break;
 
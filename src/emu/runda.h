@@ -120,7 +120,7 @@
                 #ifdef USE_FLOAT
                 ST0.f /= ED->sdword[0];
                 #else
-                ST0.d /= ED->sdword[0];
+                ST0.d = fpu_div(ST0.d, ED->sdword[0]);
                 #endif
                 break;
             case 7:     /* FIDIVR ST0, Ed int */
@@ -128,7 +128,7 @@
                 #ifdef USE_FLOAT
                 ST0.f = ED->sdword[0] / ST0.f;
                 #else
-                ST0.d = ED->sdword[0] / ST0.d;
+                ST0.d = fpu_div(ED->sdword[0], ST0.d);
                 #endif
                 break;
         }
@@ -214,18 +214,23 @@
             case 5: /* FLD ST0, Gt */
                 GET_ED;
                 fpu_do_push(emu);
-                memcpy(&STld(0).ld, ED, 10);
                 #ifdef USE_FLOAT
+                memcpy(&STld(0).ld, ED, 10);
                 LD2D(&STld(0), &d);
                 ST0.f = d;
+                STld(0).ref = ST0.ll;
                 #else
-                LD2D(&STld(0), &ST(0).d);
+                if(box86_x87_precision==X87_EXACT80) {
+                    memcpy(&STld(0).ld, ED, 10);
+                    LD2D(&STld(0), &ST(0).d);
+                    STld(0).ref = ST0.ll;
+                } else
+                    LD2D(ED, &ST(0).d);
                 #endif
-                STld(0).ref = ST0.ll;
                 break;
             case 7: /* FSTP tbyte */
                 GET_ED;
-                if(ST0.ll!=STld(0).ref)
+                if(box86_x87_precision!=X87_EXACT80 || ST0.ll!=STld(0).ref)
                     #ifdef USE_FLOAT
                     {d = ST0.f; D2LD(&d, ED);}
                     #else
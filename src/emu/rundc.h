@@ -98,7 +98,7 @@
             #ifdef USE_FLOAT
             ST(nextop&7).f = ST0.f / ST(nextop&7).f;
             #else
-            ST(nextop&7).d = ST0.d / ST(nextop&7).d;
+            ST(nextop&7).d = fpu_div(ST0.d, ST(nextop&7).d);
             #endif
             break;
         case 0xF8:
@@ -112,7 +112,7 @@
             #ifdef USE_FLOAT
             ST(nextop&7).f /=  ST0.f;
             #else
-            ST(nextop&7).d /=  ST0.d;
+            ST(nextop&7).d = fpu_div(ST(nextop&7).d, ST0.d);
             #endif
             break;
         default:
@@ -213,10 +213,10 @@
                 }
                 #else
                 if(!(((uintptr_t)ED)&7))
-                    ST0.d /= *(double*)ED;
+                    ST0.d = fpu_div(ST0.d, *(double*)ED);
                 else {
                     *(uint64_t*)&d = *(uint64_t*)ED;
-                    ST0.d /= d;
+                    ST0.d = fpu_div(ST0.d, d);
                 }
                 #endif
                 break;
@@ -230,10 +230,10 @@
                 }
                 #else
                 if(!(((uintptr_t)ED)&7))
-                    ST0.d = *(double*)ED / ST0.d;
+                    ST0.d = fpu_div(*(double*)ED, ST0.d);
                 else {
                     *(uint64_t*)&d = *(uint64_t*)ED;
-                    ST0.d = d / ST0.d;
+                    ST0.d = fpu_div(d, ST0.d);
                 }
                 #endif
                 break;
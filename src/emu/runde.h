@@ -105,7 +105,7 @@
         #ifdef USE_FLOAT
         ST(nextop&7).f = ST0.f / ST(nextop&7).f;
         #else
-        ST(nextop&7).d = ST0.d / ST(nextop&7).d;
+        ST(nextop&7).d = fpu_div(ST0.d, ST(nextop&7).d);
         #endif
         fpu_do_pop(emu);
         break;
@@ -120,7 +120,7 @@
         #ifdef USE_FLOAT
         ST(nextop&7).f /= ST0.f;
         #else
-        ST(nextop&7).d /= ST0.d;
+        ST(nextop&7).d = fpu_div(ST(nextop&7).d, ST0.d);
         #endif
         fpu_do_pop(emu);
         break;
@@ -181,7 +181,7 @@
                 #ifdef USE_FLOAT
                 ST0.f /= EW->sword[0];
                 #else
-                ST0.d /= EW->sword[0];
+                ST0.d = fpu_div(ST0.d, EW->sword[0]);
                 #endif
                 break;
             case 7:     /* FIDIVR ST0, Ew int */
@@ -189,7 +189,7 @@
                 #ifdef USE_FLOAT
                 ST0.f = EW->sword[0] / ST0.f;
                 #else
-                ST0.d = EW->sword[0] / ST0.d;
+                ST0.d = fpu_div(EW->sword[0], ST0.d);
                 #endif
                 break;
         default:
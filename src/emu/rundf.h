@@ -207,8 +207,10 @@
             #else
             ST0.d = tmp64s;
             #endif
-            STll(0).ll = tmp64s;
-            STll(0).ref = ST0.ll;
+            if(box86_x87_precision==X87_EXACT80) {
+                STll(0).ll = tmp64s;
+                STll(0).ref = ST0.ll;
+            }
             break;
         case 6: /* FBSTP tbytes, ST0 */
             GET_ED;
@@ -217,7 +219,7 @@
             break;
         case 7: /* FISTP i64 */
             GET_ED;
-            if(STll(0).ref==ST(0).ll) {
+            if(box86_x87_precision==X87_EXACT80 && STll(0).ref==ST(0).ll) {
                 *(int64_t*)ED = STll(0).ll;
             } else {
                 #ifdef USE_FLOAT
@@ -111,6 +111,25 @@
         }
         break;
 
+    case 0x7C:  /* HADDPS Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        eax1 = *EX;
+        GX.f[0] += GX.f[1];
+        GX.f[1] = GX.f[2] + GX.f[3];
+        GX.f[2] = eax1.f[0] + eax1.f[1];
+        GX.f[3] = eax1.f[2] + eax1.f[3];
+        break;
+    case 0x7D:  /* HSUBPS Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        eax1 = *EX;
+        GX.f[0] -= GX.f[1];
+        GX.f[1] = GX.f[2] - GX.f[3];
+        GX.f[2] = eax1.f[0] - eax1.f[1];
+        GX.f[3] = eax1.f[2] - eax1.f[3];
+        break;
+
     case 0xC2:  /* CMPSD Gx, Ex, Ib */
         nextop = F8;
         GET_EX;
@@ -129,6 +148,15 @@
         GX.q[0]=(tmp8s)?0xffffffffffffffffLL:0LL;
         break;
 
+    case 0xD0:  /* ADDSUBPS Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        GX.f[0] -= EX->f[0];
+        GX.f[1] += EX->f[1];
+        GX.f[2] -= EX->f[2];
+        GX.f[3] += EX->f[3];
+        break;
+
     case 0xD6:  /* MOVDQ2Q Gm, Ex */
         nextop = F8;
         GET_EX;
@@ -143,6 +171,12 @@
         GX.q[1] = 0;
         break;
 
+    case 0xF0:  /* LDDQU Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        memcpy(&GX, EX, 16);
+        break;
+
     default:
         goto _default;
     }
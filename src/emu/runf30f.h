@@ -15,6 +15,20 @@
         GET_EX;
         EX->ud[0] = GX.ud[0];
         break;
+    case 0x12:  /* MOVSLDUP Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        eax1 = *EX;
+        GX.ud[1] = GX.ud[0] = eax1.ud[0];
+        GX.ud[3] = GX.ud[2] = eax1.ud[2];
+        break;
+    case 0x16:  /* MOVSHDUP Gx, Ex */
+        nextop = F8;
+        GET_EX;
+        eax1 = *EX;
+        GX.ud[1] = GX.ud[0] = eax1.ud[1];
+        GX.ud[3] = GX.ud[2] = eax1.ud[3];
+        break;
 
     case 0x2A:  /* CVTSI2SS Gx, Ed */
         nextop = F8;
@@ -5,6 +5,8 @@
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
+#include <signal.h>
+#include <setjmp.h>
 
 #include "debug.h"
 #include "box86stack.h"
@@ -68,6 +70,12 @@ static void internalX86Setup(x86emu_t* emu, box86context_t *context, uintptr_t s
     emu->segs[_DS] = emu->segs[_ES] = emu->segs[_SS] = 0x7b;
     emu->segs[_FS] = 0;
     emu->segs[_GS] = 0x33;
+    emu->gsbase_tlssize = -1;   // GS base will be fetched on 1st use, in the thread running this emu
+    #ifdef DISPATCH_STATS
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    emu->start_time = tv.tv_sec*1000000LL + tv.tv_usec;
+    #endif
     // setup fpu regs
     reset_fpu(emu);
     // if trace is activated
@@ -82,7 +90,10 @@ x86emu_t *NewX86Emu(box86context_t *context, uintptr_t start, uintptr_t stack, i
 {
     printf_log(LOG_DEBUG, "Allocate a new X86 Emu, with EIP=%p and Stack=%p/0x%X\n", (void*)start, (void*)stack, stacksize);
 
-    x86emu_t *emu = (x86emu_t*)calloc(1, sizeof(x86emu_t));
+    x86emu_t *emu = NULL;
+    if(posix_memalign((void**)&emu, __alignof__(x86emu_t), sizeof(x86emu_t)))
+        return NULL;
+    memset(emu, 0, sizeof(x86emu_t));
 
     internalX86Setup(emu, context, start, stack, stacksize, ownstack);
 
@@ -177,6 +188,15 @@ void CallAllCleanup(x86emu_t *emu)
 
 static void internalFreeX86(x86emu_t* emu)
 {
+    #ifdef DISPATCH_STATS
+    if(emu->dispatch) {
+        struct timeval tv;
+        gettimeofday(&tv, NULL);
+        uint64_t t = tv.tv_sec*1000000LL + tv.tv_usec - emu->start_time;
+        printf_log(LOG_NONE, "Interpreter stats: %llu dispatches, %llu opcodes fused, %.2f M dispatches/s (%.2f M opcodes/s)\n",
+            emu->dispatch, emu->fused, t?(double)emu->dispatch/t:0.0, t?(double)(emu->dispatch+emu->fused)/t:0.0);
+    }
+    #endif
     // stop trace now
     if(emu->dec)
         DeleteX86TraceDecoder(&emu->dec);
@@ -444,7 +464,95 @@ static inline void init_perfcounters (int32_t do_reset, int32_t enable_divider)
 }
 
 #endif
+#if (__ARM_ARCH >= 7)
+#define HAVE_CNTVCT
+static inline uint64_t arm_cntvct (void)
+{
+  uint32_t lo, hi;
+  // Read the virtual count of the generic timer
+  asm volatile ("MRRC p15, 1, %0, %1, c14\t\n": "=r"(lo), "=r"(hi));
+  return ((uint64_t)hi<<32) | lo;
+}
+static inline uint32_t arm_cntfrq (void)
+{
+  uint32_t value;
+  asm volatile ("MRC p15, 0, %0, c14, c0, 0\t\n": "=r"(value));
+  return value;
+}
+static sigjmp_buf tsc_probe_jmp;
+static void tsc_probe_sigill(int sig)
+{
+  siglongjmp(tsc_probe_jmp, 1);
+}
+#endif
+#endif
+
+// frequency of ReadTSC, for its fallback time source (the native one is set by InitTSC or ReadTSCFrequency)
+#ifdef NOGETCLOCK
+static uint64_t tsc_frequency = 1000000LL;      // gettimeofday, in us
+#else
+static uint64_t tsc_frequency = 1000000000LL;   // clock_gettime, in ns
+#endif
+
+void InitTSC()
+{
+#if defined(__i386__)
+    // native rdtsc: its frequency is only measured when a program ask for it (CPUID leaf 0x15)
+    return;
+#endif
+#ifdef HAVE_CNTVCT
+    if(box86_fastrdtsc) {
+        // the kernel may not give access to the generic timer to userspace: probe it
+        struct sigaction sa, old;
+        memset(&sa, 0, sizeof(sa));
+        sa.sa_handler = tsc_probe_sigill;
+        sigaction(SIGILL, &sa, &old);
+        uint32_t freq = 0;
+        if(!sigsetjmp(tsc_probe_jmp, 1)) {
+            freq = arm_cntfrq();
+            arm_cntvct();
+        }
+        sigaction(SIGILL, &old, NULL);
+        if(freq) {
+            tsc_frequency = freq;
+            printf_log(LOG_INFO, "RDTSC use the ARM generic timer (%u Hz)\n", freq);
+            return;
+        }
+    }
+#endif
+    if(box86_fastrdtsc)
+        printf_log(LOG_INFO, "ARM generic timer not available to RDTSC, using %s\n",
+#ifdef NOGETCLOCK
+            "gettimeofday"
+#else
+            "clock_gettime"
 #endif
+            );
+    box86_fastrdtsc = 0;
+}
+
+uint64_t ReadTSCFrequency()
+{
+#if defined(__i386__)
+    static int calibrated = 0;
+    if(!calibrated) {
+        // native rdtsc: measure its frequency against gettimeofday, over 10ms
+        struct timeval t0, t1;
+        int64_t us;
+        uint64_t c0 = ReadTSC(NULL);
+        gettimeofday(&t0, NULL);
+        do {
+            gettimeofday(&t1, NULL);
+            us = (int64_t)(t1.tv_sec-t0.tv_sec)*1000000LL + (t1.tv_usec-t0.tv_usec);
+        } while(us<10000);
+        uint64_t c1 = ReadTSC(NULL);
+        tsc_frequency = (c1-c0)*1000000LL/us;
+        calibrated = 1;     // concurrent first calls just measure twice
+        printf_log(LOG_DEBUG, "RDTSC use the native TSC (%llu Hz)\n", tsc_frequency);
+    }
+#endif
+    return tsc_frequency;
+}
 
 uint64_t ReadTSC(x86emu_t* emu)
 {
@@ -454,6 +562,9 @@ uint64_t ReadTSC(x86emu_t* emu)
   uint64_t ret;
   __asm__ volatile("rdtsc" : "=A"(ret));
   return ret;
+#elif defined(HAVE_CNTVCT)
+  if(box86_fastrdtsc)
+    return arm_cntvct();
 #if 0
 #elif defined(__ARM_ARCH)
 #if (__ARM_ARCH >= 6)
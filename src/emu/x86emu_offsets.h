@@ -0,0 +1,9 @@
+#ifndef __X86EMU_OFFSETS_H_
+#define __X86EMU_OFFSETS_H_
+
+// offsets in x86emu_t used by the assembly parts of the dynarec (checked against the struct in x86emu_private.h)
+// only #define here, this is included by the .S files
+#define EMU_OFFSET_REGS     0   // regs[8] then ip: arm_prolog LDM r4-r11, arm_epilog STM r4-r12 (r12 is EIP)
+#define EMU_OFFSET_IP       32
+
+#endif //__X86EMU_OFFSETS_H_
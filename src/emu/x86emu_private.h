@@ -1,7 +1,9 @@
 #ifndef __X86EMU_PRIVATE_H_
 #define __X86EMU_PRIVATE_H_
 
+#include <stddef.h>
 #include "regs.h"
+#include "x86emu_offsets.h"
 
 typedef struct zydis_dec_s zydis_dec_t;
 typedef struct box86context_s box86context_t;
@@ -21,40 +23,60 @@ typedef struct forkpty_s {
     void*   f;  // forkpty function
 } forkpty_t;
 
+// x86emu_t is split in 3 cache line aligned parts: the integer / flags state used by every instruction
+// (and by the block transitions of the dynarec), the x87 / MMX / SSE registers, and the cold bookkeeping.
+// Generated code reach the first part with imm8 LDRH / STRH, so it must stay in the first 256 bytes
 typedef struct x86emu_s {
-    // cpu
+    // cpu (regs and ip first, for the LDM / STM of arm_prolog / arm_epilog)
 	reg32_t     regs[8],ip;
-    int         flags[F_LAST];
+    // defered flags
+    defered_flags_t df;
+    uint32_t    op1;
+    uint32_t    op2;
+    uint32_t    res;
 	x86flags_t  packed_eflags;
     uintptr_t   old_ip;
-    // fpu
-	fpu_reg_t   fpu[9];
+    uint32_t    *x86emu_parity_tab; // helper
+    int         flags[F_LAST];
+    // segments
+    uint32_t    segs[6];    // only 32bits value?
+    uintptr_t   gsbase;         // cached GS base (the TLS data of the thread)
+    int32_t     gsbase_tlssize; // context->tlssize when gsbase was cached (-1 if not cached, reset on each Run / DynaRun / DynaCall)
+    uint32_t    spin;           // PAUSE / polling loops done since last yield (dynarec)
+    int         quit;
+    // fpu control (here because of the imm8 accesses)
 	uint16_t    cw,cw_mask_all;
 	x87flags_t  sw;
 	uint32_t    top;        // top is part of sw, but it's faster to have it separatly
+    // parent context
+    box86context_t *context;
+    // cpu helpers
+    reg32_t     zero;
+    reg32_t     *sbiidx[8];
+
+    // sse
+    sse_regs_t  xmm[8] __attribute__((aligned(64)));
+    uint32_t    mxcsr;
+    // mmx
+    mmx_regs_t  mmx[8];
+    // fpu
+	fpu_reg_t   fpu[9];
     int         fpu_stack;
 	fpu_round_t round;
-    fpu_ld_t    fpu_ld[9]; // for long double emulation / 80bits fld fst
-    fpu_ll_t    fpu_ll[9]; // for 64bits fild / fist sequence
 	fpu_p_reg_t p_regs[9];
-    // mmx
-    mmx_regs_t  mmx[8];
-    // sse
-    sse_regs_t  xmm[8];
-    uint32_t    mxcsr;
-    // defered flags
-    defered_flags_t df;
-    uint32_t    op1;
-    uint32_t    op2;
-    uint32_t    res;
-    uint32_t    *x86emu_parity_tab; // helper
+
+    // fpu exact values
+    fpu_ld_t    fpu_ld[9] __attribute__((aligned(64))); // for long double emulation / 80bits fld fst
+    fpu_ll_t    fpu_ll[9]; // for 64bits fild / fist sequence
     #ifdef HAVE_TRACE
     uintptr_t   prev2_ip, prev_ip;
     #endif
-    // segments
-    uint32_t    segs[6];    // only 32bits value?
+    #ifdef DISPATCH_STATS
+    uint64_t    dispatch;       // opcodes dispatched by the interpreter
+    uint64_t    fused;          // opcodes run inside a superinstruction (no dispatch)
+    uint64_t    start_time;     // usec
+    #endif
     // emu control
-    int         quit;
     int         error;
     int         fork;   // quit because need to fork
     forkpty_t*  forkpty_info;
@@ -64,11 +86,6 @@ typedef struct x86emu_s {
     // trace
     zydis_dec_t *dec;
     uintptr_t   trace_start, trace_end;
-    // parent context
-    box86context_t *context;
-    // cpu helpers
-    reg32_t     zero;
-    reg32_t     *sbiidx[8];
     // atexit and fini functions
     cleanup_t   *cleanups;
     int         clean_sz;
@@ -84,6 +101,9 @@ typedef struct x86emu_s {
 
 } x86emu_t;
 
+_Static_assert(offsetof(x86emu_t, regs)==EMU_OFFSET_REGS && offsetof(x86emu_t, ip)==EMU_OFFSET_IP, "x86emu_offsets.h is out of date");
+_Static_assert(offsetof(x86emu_t, top)<256, "x86emu_t fields accessed with imm8 from generated code are too far");
+
 //#define INTR_RAISE_DIV0(emu) {emu->error |= ERR_DIVBY0; emu->quit=1;}
 #define INTR_RAISE_DIV0(emu) {emu->error |= ERR_DIVBY0;} // should rise a SIGFPE and not quit
 
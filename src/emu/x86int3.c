@@ -20,6 +20,7 @@
 #include "wrapper.h"
 #include "box86context.h"
 #include "librarian.h"
+#include "profiler.h"
 
 typedef int32_t (*iFpppp_t)(void*, void*, void*, void*);
 
@@ -183,7 +184,9 @@ void x86Int3(x86emu_t* emu)
                 }
                 printf_log(LOG_DEBUG, "%s =>", buff);
                 pthread_mutex_unlock(&emu->context->mutex_trace);
+                uintptr_t prof = ProfilerEnterNative(addr);
                 w(emu, addr);   // some function never come back, so unlock the mutex first!
+                ProfilerLeaveNative(prof);
                 pthread_mutex_lock(&emu->context->mutex_trace);
                 if(post)
                     switch(post) {
@@ -212,8 +215,11 @@ void x86Int3(x86emu_t* emu)
                     snprintf(buff3, 63, " (errno=%d)", errno);
                 printf_log(LOG_DEBUG, " return 0x%08X%s%s\n", R_EAX, buff2, buff3);
                 pthread_mutex_unlock(&emu->context->mutex_trace);
-            } else
+            } else {
+                uintptr_t prof = ProfilerEnterNative(addr);
                 w(emu, addr);
+                ProfilerLeaveNative(prof);
+            }
         }
         return;
     }
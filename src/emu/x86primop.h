@@ -470,6 +470,75 @@ static inline uint32_t sub32(x86emu_t *emu, uint32_t d, uint32_t s)
 void         test8  (x86emu_t *emu, uint8_t d, uint8_t s);
 void         test16 (x86emu_t *emu, uint16_t d, uint16_t s);
 void         test32 (x86emu_t *emu, uint32_t d, uint32_t s);
+/****************************************************************************
+REMARKS:
+Implements the CMP instruction with the flags defered (cmp8 computes them right away,
+the dynarec needs that).
+****************************************************************************/
+static inline void lazycmp8(x86emu_t *emu, uint8_t d, uint8_t s)
+{
+	emu->res = d - s;
+	emu->op1 = d;
+	emu->op2 = s;
+	emu->df = d_sub8;
+}
+
+/****************************************************************************
+REMARKS:
+Implements the CMP instruction with the flags defered (cmp16 computes them right away,
+the dynarec needs that).
+****************************************************************************/
+static inline void lazycmp16(x86emu_t *emu, uint16_t d, uint16_t s)
+{
+	emu->res = d - s;
+	emu->op1 = d;
+	emu->op2 = s;
+	emu->df = d_sub16;
+}
+
+/****************************************************************************
+REMARKS:
+Implements the CMP instruction with the flags defered (cmp32 computes them right away,
+the dynarec needs that).
+****************************************************************************/
+static inline void lazycmp32(x86emu_t *emu, uint32_t d, uint32_t s)
+{
+	emu->res = d - s;
+	emu->op1 = d;
+	emu->op2 = s;
+	emu->df = d_sub32;
+}
+
+/****************************************************************************
+REMARKS:
+Implements the TEST instruction with the flags defered.
+****************************************************************************/
+static inline void lazytest8(x86emu_t *emu, uint8_t d, uint8_t s)
+{
+	emu->res = d & s;
+	emu->df = d_and8;
+}
+
+/****************************************************************************
+REMARKS:
+Implements the TEST instruction with the flags defered.
+****************************************************************************/
+static inline void lazytest16(x86emu_t *emu, uint16_t d, uint16_t s)
+{
+	emu->res = d & s;
+	emu->df = d_and16;
+}
+
+/****************************************************************************
+REMARKS:
+Implements the TEST instruction with the flags defered.
+****************************************************************************/
+static inline void lazytest32(x86emu_t *emu, uint32_t d, uint32_t s)
+{
+	emu->res = d & s;
+	emu->df = d_and32;
+}
+
 /****************************************************************************
 REMARKS:
 Implements the XOR instruction and side effects.
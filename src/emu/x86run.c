@@ -15,9 +15,11 @@
 #include "x86emu_private.h"
 #include "x86run_private.h"
 #include "x86primop.h"
+#include "x86simd.h"
 #include "x86trace.h"
 #include "x87emu_private.h"
 #include "box86context.h"
+#include "profiler.h"
 
 int my_setcontext(x86emu_t* emu, void* ucp);
 
@@ -36,6 +38,8 @@ int Run(x86emu_t *emu, int step)
     uint64_t tmp64u;
     int64_t tmp64s;
     uintptr_t ip, old_ip;
+    uintptr_t pause_ip = 0; // last PAUSE, and number of times it was done in a row
+    uint32_t pauses = 0;
     double d;
     float f;
     int64_t ll;
@@ -46,6 +50,12 @@ int Run(x86emu_t *emu, int step)
         return 0;
 
     old_ip = 0;
+    const int profip = box86_profile;  // the sampling profiler reads the current EIP from the emu
+    profstate_t prof = {0};
+    if(!step) {
+        prof = ProfilerEnterEmu(emu);
+        emu->gsbase_tlssize = -1;   // the emu may now run on another thread (callbacks), refetch its GS base
+    }
 
     //ref opcode: http://ref.x86asm.net/geek32.html#xA1
     printf_log(LOG_DEBUG, "Run X86 (%p), EIP=%p, Stack=%p\n", emu, (void*)R_EIP, emu->context->stack);
@@ -104,7 +114,7 @@ int Run(x86emu_t *emu, int step)
     &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x20-0x27
     &&_0f_0x28, &&_0f_0x29, &&_0f_0x2A, &&_0f_0x2B, &&_0f_0x2C, &&_0f_0x2D, &&_0f_0x2E, &&_0f_0x2F, 
     &&_default, &&_0f_0x31, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x30-0x37
-    &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x38-0x3F
+    &&_0f_0x38, &&_default, &&_0f_0x3A, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x38-0x3F
     &&_0f_0x40_0, &&_0f_0x40_1, &&_0f_0x40_2, &&_0f_0x40_3, &&_0f_0x40_4, &&_0f_0x40_5, &&_0f_0x40_6, &&_0f_0x40_7,
     &&_0f_0x40_8, &&_0f_0x40_9, &&_0f_0x40_A, &&_0f_0x40_B, &&_0f_0x40_C, &&_0f_0x40_D, &&_0f_0x40_E, &&_0f_0x40_F,
     &&_0f_0x50, &&_0f_0x51, &&_0f_0x52, &&_0f_0x53, &&_0f_0x54, &&_0f_0x55, &&_0f_0x56, &&_0f_0x57, //0x50-0x57
@@ -123,12 +133,12 @@ int Run(x86emu_t *emu, int step)
     &&_default, &&_default, &&_0f_0xBA, &&_0f_0xBB, &&_0f_0xBC, &&_0f_0xBD, &&_0f_0xBE, &&_0f_0xBF, 
     &&_0f_0xC0, &&_0f_0xC1, &&_0f_0xC2, &&_default, &&_0f_0xC4, &&_0f_0xC5, &&_0f_0xC6, &&_0f_0xC7, 
     &&_0f_0xC8, &&_0f_0xC9, &&_0f_0xCA, &&_0f_0xCB, &&_0f_0xCC, &&_0f_0xCD, &&_0f_0xCE, &&_0f_0xCF, //0xC8-0xCF
-    &&_default, &&_0f_0xD1, &&_0f_0xD2, &&_0f_0xD3, &&_0f_0xD4 ,&&_0f_0xD5, &&_default, &&_default, //0xD0-0xD7
-    &&_0f_0xD8, &&_0f_0xD9, &&_default, &&_0f_0xDB, &&_0f_0xDC ,&&_0f_0xDD, &&_default, &&_0f_0xDF, //0xD8-0xDF
-    &&_0f_0xE0, &&_0f_0xE1, &&_0f_0xE2, &&_0f_0xE3, &&_0f_0xE4 ,&&_0f_0xE5, &&_default, &&_default, //0xE0-0xE7
-    &&_0f_0xE8, &&_0f_0xE9, &&_default, &&_0f_0xEB, &&_0f_0xEC ,&&_0f_0xED, &&_default, &&_0f_0xEF, //0xE8-0xEF
-    &&_default, &&_0f_0xF1, &&_0f_0xF2, &&_0f_0xF3, &&_0f_0xF4 ,&&_0f_0xF5, &&_0f_0xF6, &&_default, //0xF0-0xF7
-    &&_0f_0xF8, &&_0f_0xF9, &&_0f_0xFA, &&_default, &&_0f_0xFC ,&&_0f_0xFD, &&_0f_0xFE, &&_default  //0xF8-0xFF
+    &&_default, &&_0f_0xD1, &&_0f_0xD2, &&_0f_0xD3, &&_0f_0xD4 ,&&_0f_0xD5, &&_default, &&_0f_0xD7, //0xD0-0xD7
+    &&_0f_0xD8, &&_0f_0xD9, &&_0f_0xDA, &&_0f_0xDB, &&_0f_0xDC ,&&_0f_0xDD, &&_0f_0xDE, &&_0f_0xDF, //0xD8-0xDF
+    &&_0f_0xE0, &&_0f_0xE1, &&_0f_0xE2, &&_0f_0xE3, &&_0f_0xE4 ,&&_0f_0xE5, &&_default, &&_0f_0xE7, //0xE0-0xE7
+    &&_0f_0xE8, &&_0f_0xE9, &&_0f_0xEA, &&_0f_0xEB, &&_0f_0xEC ,&&_0f_0xED, &&_0f_0xEE, &&_0f_0xEF, //0xE8-0xEF
+    &&_default, &&_0f_0xF1, &&_0f_0xF2, &&_0f_0xF3, &&_0f_0xF4 ,&&_0f_0xF5, &&_0f_0xF6, &&_0f_0xF7, //0xF0-0xF7
+    &&_0f_0xF8, &&_0f_0xF9, &&_0f_0xFA, &&_0f_0xFB, &&_0f_0xFC ,&&_0f_0xFD, &&_0f_0xFE, &&_default  //0xF8-0xFF
     };
 
     static const void* opcodes66[256] = {
@@ -149,8 +159,8 @@ int Run(x86emu_t *emu, int step)
     &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x70-0x77
     &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x78-0x7F
     &&_default, &&_66_0x81, &&_default, &&_66_0x83, &&_default, &&_66_0x85, &&_default, &&_66_0x87, 
-    &&_default, &&_66_0x89, &&_default, &&_66_0x8B, &&_66_0x8C, &&_default, &&_66_0x8E, &&_66_0x8F, 
-    &&_66_0x90, &&_default, &&_66_0x92, &&_default, &&_default, &&_default, &&_default, &&_default, 
+    &&_default, &&_66_0x89, &&_default, &&_66_0x8B, &&_66_0x8C, &&_66_0x8D, &&_66_0x8E, &&_66_0x8F, 
+    &&_66_0x90, &&_66_0x91, &&_66_0x92, &&_66_0x93, &&_66_0x94, &&_66_0x95, &&_66_0x96, &&_66_0x97, 
     &&_66_0x98, &&_66_0x99, &&_default, &&_default, &&_66_0x9C, &&_default, &&_default, &&_default, //0x98-0x9F
     &&_default, &&_66_0xA1, &&_default, &&_66_0xA3, &&_default, &&_66_0xA5, &&_default, &&_66_0xA7, 
     &&_default, &&_66_0xA9, &&_default, &&_66_0xAB, &&_default, &&_66_0xAD, &&_default, &&_66_0xAF, //0xA8-0xAF
@@ -182,7 +192,7 @@ int Run(x86emu_t *emu, int step)
     &&_6f_0x60, &&_6f_0x61, &&_6f_0x62, &&_6f_0x63, &&_6f_0x64, &&_6f_0x65, &&_6f_0x66, &&_6f_0x67, 
     &&_6f_0x68, &&_6f_0x69, &&_6f_0x6A, &&_6f_0x6B, &&_6f_0x6C, &&_6f_0x6D, &&_6f_0x6E, &&_6f_0x6F,     
     &&_6f_0x70, &&_6f_0x71, &&_6f_0x72, &&_6f_0x73, &&_6f_0x74, &&_6f_0x75, &&_6f_0x76, &&_default, 
-    &&_default, &&_default, &&_default, &&_default, &&_default, &&_default, &&_6f_0x7E, &&_6f_0x7F, //0x78-0x7F
+    &&_default, &&_default, &&_default, &&_default, &&_6f_0x7C, &&_6f_0x7D, &&_6f_0x7E, &&_6f_0x7F, //0x78-0x7F
     &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x80-0x87
     &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x88-0x8F
     &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0x90-0x97
@@ -190,10 +200,10 @@ int Run(x86emu_t *emu, int step)
     &&_default, &&_default, &&_default, &&_6f_0xA3, &&_6f_0xA4, &&_6f_0xA5, &&_default, &&_default, 
     &&_default, &&_default, &&_default, &&_6f_0xAB, &&_6f_0xAC, &&_6f_0xAD, &&_default, &&_6f_0xAF, 
     &&_default, &&_6f_0xB1, &&_default, &&_6f_0xB3, &&_default, &&_default, &&_6f_0xB6, &&_default, 
-    &&_default, &&_default, &&_default, &&_6f_0xBB, &&_6f_0xBC, &&_6f_0xBD, &&_6f_0xBE, &&_default, //0xB8-0xBF
+    &&_default, &&_default, &&_6f_0xBA, &&_6f_0xBB, &&_6f_0xBC, &&_6f_0xBD, &&_6f_0xBE, &&_default, //0xB8-0xBF
     &&_default, &&_6f_0xC1, &&_6f_0xC2, &&_default, &&_6f_0xC4, &&_6f_0xC5, &&_6f_0xC6, &&_default, 
     &&_default, &&_default, &&_default, &&_default, &&_default ,&&_default, &&_default, &&_default, //0xC8-0xCF
-    &&_default, &&_6f_0xD1, &&_6f_0xD2, &&_6f_0xD3, &&_6f_0xD4, &&_6f_0xD5, &&_6f_0xD6, &&_6f_0xD7, 
+    &&_6f_0xD0, &&_6f_0xD1, &&_6f_0xD2, &&_6f_0xD3, &&_6f_0xD4, &&_6f_0xD5, &&_6f_0xD6, &&_6f_0xD7, 
     &&_6f_0xD8, &&_6f_0xD9, &&_default, &&_6f_0xDB, &&_6f_0xDC, &&_default, &&_6f_0xDE, &&_6f_0xDF, 
     &&_default, &&_6f_0xE1, &&_6f_0xE2, &&_default, &&_default, &&_6f_0xE5, &&_6f_0xE6, &&_6f_0xE7, 
     &&_6f_0xE8, &&_6f_0xE9, &&_6f_0xEA, &&_6f_0xEB, &&_6f_0xEC, &&_6f_0xED, &&_6f_0xEE, &&_6f_0xEF, 
@@ -203,20 +213,60 @@ int Run(x86emu_t *emu, int step)
 
 x86emurun:
     ip = R_EIP;
+    #define PROFIP  if(profip) R_EIP = ip
 //    UnpackFlags(emu);
 #ifdef HAVE_TRACE
 _trace:
     emu->prev2_ip = emu->prev_ip;
     emu->prev_ip = old_ip;
     old_ip = ip;
+    PROFIP;
     if(emu->dec && (
         (emu->trace_end == 0) 
         || ((ip >= emu->trace_start) && (ip < emu->trace_end))) )
             PrintTrace(emu, ip, 0);
 
     #define NEXT    __builtin_prefetch((void*)ip, 0, 0); goto _trace;
+    // no superinstruction when tracing, every opcode goes through _trace
+    #define FUSEJCC
+    #define FUSEPUSH
+#else
+#ifdef DISPATCH_STATS
+    #define NEXT    old_ip = ip; PROFIP; ++emu->dispatch; __builtin_prefetch((void*)ip, 0, 0); goto *baseopcodes[(opcode=F8)];
+    #define FUSED   ++emu->fused
 #else
-    #define NEXT    old_ip = ip; __builtin_prefetch((void*)ip, 0, 0); goto *baseopcodes[(opcode=F8)];
+    #define NEXT    old_ip = ip; PROFIP; __builtin_prefetch((void*)ip, 0, 0); goto *baseopcodes[(opcode=F8)];
+    #define FUSED
+#endif
+    // superinstruction: a Jcc just after an opcode that sets the flags is done right away, without a dispatch
+    #define FUSEJCC                                         \
+        if(box86_superinst) {                               \
+            if((PK(0)&0xF0)==0x70) {                        \
+                old_ip = ip;                                \
+                tmp8u = F8;                                 \
+                tmp8s = F8S;                                \
+                if(EvalCond(emu, tmp8u&15))                 \
+                    ip += tmp8s;                            \
+                FUSED;                                      \
+            } else if(PK(0)==0x0F && (PK(1)&0xF0)==0x80) {  \
+                old_ip = ip;                                \
+                tmp8u = PK(1);                              \
+                ip += 2;                                    \
+                tmp32s = F32S;                              \
+                if(EvalCond(emu, tmp8u&15))                 \
+                    ip += tmp32s;                           \
+                FUSED;                                      \
+            }                                               \
+        }
+    // superinstruction: a run of PUSH reg (a function prolog) is done in one go
+    #define FUSEPUSH                                        \
+        if(box86_superinst)                                 \
+            while((PK(0)&0xF8)==0x50 && PK(0)!=0x54) {      \
+                old_ip = ip;                                \
+                tmp8u = F8&7;                               \
+                Push(emu, emu->regs[tmp8u].dword[0]);       \
+                FUSED;                                      \
+            }
 #endif
 
 #include "modrm.h"
@@ -266,28 +316,34 @@ _trace:
         _0x38:
             nextop = F8;
             GET_EB;
-            cmp8(emu, EB->byte[0], GB);
+            lazycmp8(emu, EB->byte[0], GB);
+            FUSEJCC
             NEXT;
         _0x39:
             nextop = F8;
             GET_ED;
-            cmp32(emu, ED->dword[0], GD.dword[0]);
+            lazycmp32(emu, ED->dword[0], GD.dword[0]);
+            FUSEJCC
             NEXT;
         _0x3A:
             nextop = F8;
             GET_EB;
-            cmp8(emu, GB, EB->byte[0]);
+            lazycmp8(emu, GB, EB->byte[0]);
+            FUSEJCC
             NEXT;
         _0x3B:
             nextop = F8;
             GET_ED;
-            cmp32(emu, GD.dword[0], ED->dword[0]);
+            lazycmp32(emu, GD.dword[0], ED->dword[0]);
+            FUSEJCC
             NEXT;
         _0x3C:
-            cmp8(emu, R_AL, F8);
+            lazycmp8(emu, R_AL, F8);
+            FUSEJCC
             NEXT;
         _0x3D:
-            cmp32(emu, R_EAX, F32);
+            lazycmp32(emu, R_EAX, F32);
+            FUSEJCC
             NEXT;
 
         _0x06:                      /* PUSH ES */
@@ -337,6 +393,7 @@ _trace:
         _0x47:                      /* INC Reg */
             tmp8u = opcode&7;
             emu->regs[tmp8u].dword[0] = inc32(emu, emu->regs[tmp8u].dword[0]);
+            FUSEJCC
             NEXT;
         _0x48:
         _0x49:
@@ -348,6 +405,7 @@ _trace:
         _0x4F:                      /* DEC Reg */
             tmp8u = opcode&7;
             emu->regs[tmp8u].dword[0] = dec32(emu, emu->regs[tmp8u].dword[0]);
+            FUSEJCC
             NEXT;
         _0x54:                      /* PUSH ESP */
             tmp32u = R_ESP;
@@ -362,6 +420,7 @@ _trace:
         _0x57:                      /* PUSH Reg */
             tmp8u = opcode&7;
             Push(emu, emu->regs[tmp8u].dword[0]);
+            FUSEPUSH
             NEXT;
         _0x58:
         _0x59:
@@ -469,86 +528,86 @@ _trace:
         #define GOCOND(BASE, PREFIX, CONDITIONAL) \
         _##BASE##_0:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_OF))               \
+            if(EvalCond(emu, 0x0))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_1:                            \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_OF))              \
+            if(EvalCond(emu, 0x1))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_2:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_CF))               \
+            if(EvalCond(emu, 0x2))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_3:                            \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_CF))              \
+            if(EvalCond(emu, 0x3))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_4:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_ZF))               \
+            if(EvalCond(emu, 0x4))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_5:                            \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_ZF))              \
+            if(EvalCond(emu, 0x5))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_6:                            \
             PREFIX                              \
-            if((ACCESS_FLAG(F_ZF) || ACCESS_FLAG(F_CF)))  \
+            if(EvalCond(emu, 0x6))                        \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_7:                            \
             PREFIX                              \
-            if(!(ACCESS_FLAG(F_ZF) || ACCESS_FLAG(F_CF))) \
+            if(EvalCond(emu, 0x7))                        \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_8:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_SF))               \
+            if(EvalCond(emu, 0x8))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_9:                            \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_SF))              \
+            if(EvalCond(emu, 0x9))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_A:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_PF))               \
+            if(EvalCond(emu, 0xA))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_B:                            \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_PF))              \
+            if(EvalCond(emu, 0xB))              \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_C:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF))  \
+            if(EvalCond(emu, 0xC))                      \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_D:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_SF) == ACCESS_FLAG(F_OF)) \
+            if(EvalCond(emu, 0xD))                     \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_E:                            \
             PREFIX                              \
-            if(ACCESS_FLAG(F_ZF) || (ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF))) \
+            if(EvalCond(emu, 0xE))                                            \
                 CONDITIONAL                     \
             NEXT;                              \
         _##BASE##_F:                            \
             PREFIX                              \
-            if(!ACCESS_FLAG(F_ZF) && (ACCESS_FLAG(F_SF) == ACCESS_FLAG(F_OF))) \
+            if(EvalCond(emu, 0xF))                                             \
                 CONDITIONAL                     \
             NEXT;
         GOCOND(0x70
-            ,   tmp8s = F8S; CHECK_FLAGS(emu);
+            ,   tmp8s = F8S;
             ,   ip += tmp8s;
             )                           /* Jxx Ib */
         #undef GOCOND
@@ -567,8 +626,9 @@ _trace:
                 case 4: EB->byte[0] = and8(emu, EB->byte[0], tmp8u); break;
                 case 5: EB->byte[0] = sub8(emu, EB->byte[0], tmp8u); break;
                 case 6: EB->byte[0] = xor8(emu, EB->byte[0], tmp8u); break;
-                case 7:               cmp8(emu, EB->byte[0], tmp8u); break;
+                case 7:               lazycmp8(emu, EB->byte[0], tmp8u); break;
             }
+            FUSEJCC
             NEXT;
         _0x81:                      /* GRP Ed,Id */
             nextop = F8;
@@ -589,18 +649,21 @@ _trace:
                 case 4: ED->dword[0] = and32(emu, ED->dword[0], tmp32u); break;
                 case 5: ED->dword[0] = sub32(emu, ED->dword[0], tmp32u); break;
                 case 6: ED->dword[0] = xor32(emu, ED->dword[0], tmp32u); break;
-                case 7:                cmp32(emu, ED->dword[0], tmp32u); break;
+                case 7:                lazycmp32(emu, ED->dword[0], tmp32u); break;
             }
+            FUSEJCC
             NEXT;
         _0x84:                      /* TEST Eb,Gb */
             nextop = F8;
             GET_EB;
-            test8(emu, EB->byte[0], GB);
+            lazytest8(emu, EB->byte[0], GB);
+            FUSEJCC
             NEXT;
         _0x85:                      /* TEST Ed,Gd */
             nextop = F8;
             GET_ED;
-            test32(emu, ED->dword[0], GD.dword[0]);
+            lazytest32(emu, ED->dword[0], GD.dword[0]);
+            FUSEJCC
             NEXT;
         _0x86:                      /* XCHG Eb,Gb */
             nextop = F8;
@@ -684,9 +747,7 @@ _trace:
         _0x9B:                      /* FWAIT */
             NEXT;
         _0x9C:                      /* PUSHF */
-            CHECK_FLAGS(emu);
-            PackFlags(emu);
-            Push(emu, emu->packed_eflags.x32);
+            Push(emu, GetPackedFlags(emu));
             NEXT;
         _0x9D:                      /* POPF */
             emu->packed_eflags.x32 = ((Pop(emu) & 0x3F7FD7)/* & (0xffff-40)*/ ) | 0x2; // mask off res2 and res3 and on res1
@@ -703,9 +764,7 @@ _trace:
             RESET_FLAGS(emu);
             NEXT;
         _0x9F:                      /* LAHF */
-            CHECK_FLAGS(emu);
-            PackFlags(emu);
-            R_AH = (uint8_t)emu->packed_eflags.x32;
+            R_AH = (uint8_t)GetPackedFlags(emu);
             NEXT;
 
         _0xA0:                      /* MOV AL,Ob */
@@ -738,7 +797,7 @@ _trace:
             tmp8u2 = *(uint8_t*)R_ESI;
             R_EDI += tmp8s;
             R_ESI += tmp8s;
-            cmp8(emu, tmp8u2, tmp8u);
+            lazycmp8(emu, tmp8u2, tmp8u);
             NEXT;
         _0xA7:                      /* CMPSD */
             tmp8s = ACCESS_FLAG(F_DF)?-4:+4;
@@ -746,13 +805,15 @@ _trace:
             tmp32u2 = *(uint32_t*)R_ESI;
             R_EDI += tmp8s;
             R_ESI += tmp8s;
-            cmp32(emu, tmp32u2, tmp32u);
+            lazycmp32(emu, tmp32u2, tmp32u);
             NEXT;
         _0xA8:                      /* TEST AL, Ib */
-            test8(emu, R_AL, F8);
+            lazytest8(emu, R_AL, F8);
+            FUSEJCC
             NEXT;
         _0xA9:                      /* TEST EAX, Id */
-            test32(emu, R_EAX, F32);
+            lazytest32(emu, R_EAX, F32);
+            FUSEJCC
             NEXT;
         _0xAA:                      /* STOSB */
             tmp8s = ACCESS_FLAG(F_DF)?-1:+1;
@@ -776,12 +837,12 @@ _trace:
             NEXT;
         _0xAE:                      /* SCASB */
             tmp8s = ACCESS_FLAG(F_DF)?-1:+1;
-            cmp8(emu, R_AL, *(uint8_t*)R_EDI);
+            lazycmp8(emu, R_AL, *(uint8_t*)R_EDI);
             R_EDI += tmp8s;
             NEXT;
         _0xAF:                      /* SCASD */
             tmp8s = ACCESS_FLAG(F_DF)?-4:+4;
-            cmp32(emu, R_EAX, *(uint32_t*)R_EDI);
+            lazycmp32(emu, R_EAX, *(uint32_t*)R_EDI);
             R_EDI += tmp8s;
             NEXT;
         
@@ -1074,6 +1135,20 @@ _trace:
                 tmp32u = R_ECX;
                 switch(nextop) {
                     case 0x90:              /* PAUSE */
+                        #ifdef ARM
+                        asm volatile ("yield");
+                        #endif
+                        if(box86_pause_spin) {
+                            // only count the PAUSE of a same spin loop, that comes back to the same instruction
+                            if(old_ip!=pause_ip) {
+                                pause_ip = old_ip;
+                                pauses = 0;
+                            }
+                            if(++pauses>=(uint32_t)box86_pause_spin) {
+                                pauses = 0;
+                                SpinWait(emu);
+                            }
+                        }
                         NEXT;
                     case 0xC3:              /* REPZ RET... yup */
                         ip = Pop(emu);
@@ -1119,7 +1194,7 @@ _trace:
                                     break;
                             }
                         }
-                        if(R_ECX) cmp8(emu, tmp8u2, tmp8u);
+                        if(R_ECX) lazycmp8(emu, tmp8u2, tmp8u);
                         break;
                     case 0xA7:              /* REP(N)Z CMPSD */
                         tmp32u2 = 0;
@@ -1146,7 +1221,7 @@ _trace:
                                     break;
                             }
                         }
-                        if(R_ECX) cmp32(emu, tmp32u2, tmp32u3);
+                        if(R_ECX) lazycmp32(emu, tmp32u2, tmp32u3);
                         break;
                     case 0xAA:              /* REP STOSB */
                         while(tmp32u) {
@@ -1197,7 +1272,7 @@ _trace:
                                     break;
                             }
                         }
-                        if(R_ECX) cmp8(emu, R_AL, tmp8u);
+                        if(R_ECX) lazycmp8(emu, R_AL, tmp8u);
                         break;
                     case 0xAF:              /* REP(N)Z SCASD */
                         tmp32u2 = 0;
@@ -1219,7 +1294,7 @@ _trace:
                                     break;
                             }
                         }
-                        if(R_ECX) cmp32(emu, R_EAX, tmp32u2);
+                        if(R_ECX) lazycmp32(emu, R_EAX, tmp32u2);
                         break;
                     default:
                         goto _default;
@@ -1239,7 +1314,7 @@ _trace:
             switch((nextop>>3)&7) {
                 case 0: 
                 case 1:                 /* TEST Eb,Ib */
-                    test8(emu, EB->byte[0], F8);
+                    lazytest8(emu, EB->byte[0], F8);
                     break;
                 case 2:                 /* NOT Eb */
                     EB->byte[0] = not8(emu, EB->byte[0]);
@@ -1267,7 +1342,7 @@ _trace:
             switch((nextop>>3)&7) {
                 case 0: 
                 case 1:                 /* TEST Ed,Id */
-                    test32(emu, ED->dword[0], F32);
+                    lazytest32(emu, ED->dword[0], F32);
                     break;
                 case 2:                 /* NOT Ed */
                     ED->dword[0] = not32(emu, ED->dword[0]);
@@ -1416,5 +1491,7 @@ fini:
         my_setcontext(emu, emu->uc_link);
         goto x86emurun;
     }
+    if(!step)
+        ProfilerLeaveEmu(prof);
     return 0;
 }
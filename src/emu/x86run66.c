@@ -71,6 +71,13 @@ void Run67(x86emu_t *emu)
         Run6766(emu);
         break;
 
+    case 0x8D:                      /* LEA Gd,Ew */
+        nextop = Fetch8(emu);
+        op1=GetEw16(emu, nextop);
+        op2=GetG(emu, nextop);
+        op2->dword[0] = (uint16_t)(uintptr_t)op1;
+        break;
+
     case 0xE0:                      /* LOOPNZ */
         CHECK_FLAGS(emu);
         tmp8s = Fetch8s(emu);
@@ -4,6 +4,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sched.h>
 #ifdef HAVE_TRACE
 #include <unistd.h>
 #include <sys/syscall.h>
@@ -545,62 +546,142 @@ void UpdateFlags(x86emu_t *emu)
 }
 
 
+// flags[] is indexed by the EFLAGS bit number (IOPL is 2 bits wide, so flags[F_IOPL+1] is unused)
+#define FLAG_MASK(i)    (((i)==F_IOPL)?3:1)
 void PackFlags(x86emu_t* emu)
 {
-    #define GO(A) emu->packed_eflags.f.F__##A = emu->flags[F_##A];
-    GO(CF);
-    GO(res1);
-    GO(PF);
-    GO(res2);
-    GO(AF);
-    GO(res3);
-    GO(ZF);
-    GO(SF);
-    GO(TF);
-    GO(IF);
-    GO(DF);
-    GO(OF);
-    GO(IOPL);
-    GO(NT);
-    GO(dummy);
-    GO(RF);
-    GO(VM);
-    GO(AC);
-    GO(VIF);
-    GO(VIP);
-    GO(ID);
-    #undef GO
+    uint32_t f = 0;
+    for(int i=0; i<F_LAST; ++i)
+        if(i!=F_IOPL+1)
+            f |= (emu->flags[i]&FLAG_MASK(i))<<i;
+    emu->packed_eflags.x32 = f;
 }
 void UnpackFlags(x86emu_t* emu)
 {
-    #define GO(A) emu->flags[F_##A] = emu->packed_eflags.f.F__##A;
-    GO(CF);
-    GO(res1);
-    GO(PF);
-    GO(res2);
-    GO(AF);
-    GO(res3);
-    GO(ZF);
-    GO(SF);
-    GO(TF);
-    GO(IF);
-    GO(DF);
-    GO(OF);
-    GO(IOPL);
-    GO(NT);
-    GO(dummy);
-    GO(RF);
-    GO(VM);
-    GO(AC);
-    GO(VIF);
-    GO(VIP);
-    GO(ID);
-    #undef GO
+    uint32_t f = emu->packed_eflags.x32;
+    for(int i=0; i<F_LAST; ++i)
+        if(i!=F_IOPL+1)
+            emu->flags[i] = (f>>i)&FLAG_MASK(i);
 }
+#undef FLAG_MASK
 
 uintptr_t GetGSBaseEmu(x86emu_t* emu)
 {
-    return (uintptr_t)GetGSBase(emu->context);
+    // TLS data is reallocated only when tlssize changes, so the cached base is good until then
+    // (the cache is also dropped each time the emu is entered, as it's only valid for the current thread)
+    if(emu->gsbase_tlssize != emu->context->tlssize) {
+        emu->gsbase = (uintptr_t)GetGSBase(emu->context);
+        emu->gsbase_tlssize = emu->context->tlssize;
+    }
+    return emu->gsbase;
+}
+
+void SpinWait(x86emu_t* emu)
+{
+    // too many PAUSE / polling loops in a row: give the CPU to the thread that will release the lock
+    emu->spin = 0;
+    sched_yield();
+}
+
+void my_cpuid(x86emu_t* emu, uint32_t tmp32u)
+{
+    // also used by the dynarec
+    switch(tmp32u) {
+        case 0x0:
+            // emulate a P4
+            R_EAX = 0x80000004;
+            // return GenuineIntel
+            R_EBX = 0x756E6547;
+            R_EDX = 0x49656E69;
+            R_ECX = 0x6C65746E;
+            break;
+        case 0x1:
+            R_EAX = 0x00000101; // familly and all
+            R_EBX = 0;          // Brand indexe, CLFlush, Max APIC ID, Local APIC ID
+            R_EDX =   1         // fpu 
+                    | 1<<8      // cmpxchg8
+                    | 1<<11     // sep (sysenter & sysexit)
+                    | 1<<15     // cmov
+                    | 1<<19     // clflush (seems to be with SSE2)
+                    | 1<<23     // mmx
+                    //| 1<<24     // fxsr (fxsave, fxrestore)
+                    | 1<<25     // SSE
+                    | 1<<26     // SSE2
+                    ;
+            R_ECX =   1<<13     // cx16 (cmpxchg16)
+                    ;
+            // SSE extensions, up to the one selected with BOX86_SSE
+            if(box86_sse>=SSE_SSE3)     R_ECX |= 1<<0;      // SSE3
+            if(box86_sse>=SSE_SSSE3)    R_ECX |= 1<<9;      // SSSE3
+            if(box86_sse>=SSE_SSE41)    R_ECX |= 1<<19;     // SSE4.1
+            break;
+        case 0x2:   // TLB and Cache info. Sending 1st gen P4 info...
+            R_EAX = 0x665B5001;
+            R_EBX = 0x00000000;
+            R_ECX = 0x00000000;
+            R_EDX = 0x007A7000;
+            break;
+        
+        case 0x4:   // Cache info
+            switch (R_ECX) {
+                case 0: // L1 data cache
+                    R_EAX = (1 | (1<<5) | (1<<8));   //type
+                    R_EBX = (63 | (7<<22)); // size
+                    R_ECX = 63;
+                    R_EDX = 1;
+                    break;
+                case 1: // L1 inst cache
+                    R_EAX = (2 | (1<<5) | (1<<8)); //type
+                    R_EBX = (63 | (7<<22)); // size
+                    R_ECX = 63;
+                    R_EDX = 1;
+                    break;
+                case 2: // L2 cache
+                    R_EAX = (3 | (2<<5) | (1<<8)); //type
+                    R_EBX = (63 | (15<<22));    // size
+                    R_ECX = 4095;
+                    R_EDX = 1;
+                    break;
+
+                default:
+                    R_EAX = 0x00000000;
+                    R_EBX = 0x00000000;
+                    R_ECX = 0x00000000;
+                    R_EDX = 0x00000000;
+                    break;
+            }
+            break;
+        case 0x5:   //mwait info
+            R_EAX = 0;
+            R_EBX = 0;
+            R_ECX = 1 | 2;
+            R_EDX = 0;
+            break;
+        case 0x6:   // thermal
+        case 0x9:   // direct cache access
+        case 0xA:   // Architecture performance monitor
+            R_EAX = 0;
+            R_EBX = 0;
+            R_ECX = 0;
+            R_EDX = 0;
+            break;
+        case 0x7:   // extended bits...
+            /*if(R_ECX==0)    R_EAX = 0;
+            else*/ R_EAX = R_ECX = R_EBX = R_EDX = 0;
+            break;
+        case 0x15:  // TSC / crystal ratio: the TSC runs at the frequency of ReadTSC
+            R_EAX = 1;
+            R_EBX = 1;
+            R_ECX = ReadTSCFrequency();
+            R_EDX = 0;
+            break;
+
+        case 0x80000000:        // max extended
+            break;              // no extended, so return same value as beeing the max value!
+        default:
+            printf_log(LOG_INFO, "Warning, CPUID command %X unsupported (ECX=%08x)\n", tmp32u, R_ECX);
+            R_EAX = 0;
+    }
 }
 
 #ifdef HAVE_TRACE
@@ -167,6 +167,90 @@ void UpdateFlags(x86emu_t *emu);
 #define CHECK_FLAGS(emu) if(emu->df) UpdateFlags(emu)
 #define RESET_FLAGS(emu) emu->df = d_none
 
+// condition cc (low nibble of Jcc / SETcc / CMOVcc) from the flags array
+static inline int FlagsCond(x86emu_t* emu, const int cc)
+{
+    int r;
+    switch(cc>>1) {
+        case 0: r = ACCESS_FLAG(F_OF); break;
+        case 1: r = ACCESS_FLAG(F_CF); break;
+        case 2: r = ACCESS_FLAG(F_ZF); break;
+        case 3: r = ACCESS_FLAG(F_ZF) || ACCESS_FLAG(F_CF); break;
+        case 4: r = ACCESS_FLAG(F_SF); break;
+        case 5: r = ACCESS_FLAG(F_PF); break;
+        case 6: r = ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF); break;
+        default: r = ACCESS_FLAG(F_ZF) || (ACCESS_FLAG(F_SF) != ACCESS_FLAG(F_OF)); break;
+    }
+    return r^(cc&1);
+}
+
+// condition cc computed directly from the defered flags when possible (ADD / SUB / CMP / logic ops),
+// so the full flags (parity and AF included) are only computed when really needed
+static inline int EvalCond(x86emu_t* emu, const int cc)
+{
+    uint32_t op1 = emu->op1, op2 = emu->op2, res = emu->res;
+    int r;
+    #define SUBCOND(T, ST, W)                                               \
+        switch(cc>>1) {                                                     \
+            case 0: r = (((op1^op2)&(op1^res))>>(W-1))&1; break;            \
+            case 1: r = (T)op1<(T)op2; break;                               \
+            case 2: r = (T)res==0; break;                                   \
+            case 3: r = (T)op1<=(T)op2; break;                              \
+            case 4: r = (res>>(W-1))&1; break;                              \
+            case 5: UpdateFlags(emu); return FlagsCond(emu, cc);            \
+            case 6: r = (ST)op1<(ST)op2; break;                             \
+            default: r = (ST)op1<=(ST)op2; break;                           \
+        }
+    #define ADDCOND(T, W)                                                   \
+        switch(cc>>1) {                                                     \
+            case 0: r = ((~(op1^op2)&(op1^res))>>(W-1))&1; break;           \
+            case 1: r = (T)res<(T)op1; break;                               \
+            case 2: r = (T)res==0; break;                                   \
+            case 3: r = ((T)res<(T)op1) || ((T)res==0); break;              \
+            case 4: r = (res>>(W-1))&1; break;                              \
+            case 5: UpdateFlags(emu); return FlagsCond(emu, cc);            \
+            case 6: r = ((res^(~(op1^op2)&(op1^res)))>>(W-1))&1; break;     \
+            default: r = ((T)res==0) || (((res^(~(op1^op2)&(op1^res)))>>(W-1))&1); break; \
+        }
+    #define LOGICCOND(T, W)                                                 \
+        switch(cc>>1) {                                                     \
+            case 0:                                                         \
+            case 1: r = 0; break;                                           \
+            case 2:                                                         \
+            case 3: r = (T)res==0; break;                                   \
+            case 4:                                                         \
+            case 6: r = (res>>(W-1))&1; break;                              \
+            case 5: UpdateFlags(emu); return FlagsCond(emu, cc);            \
+            default: r = ((T)res==0) || ((res>>(W-1))&1); break;            \
+        }
+    switch(emu->df) {
+        case d_none:
+            return FlagsCond(emu, cc);
+        case d_sub8:  SUBCOND(uint8_t, int8_t, 8); break;
+        case d_sub16: SUBCOND(uint16_t, int16_t, 16); break;
+        case d_sub32: SUBCOND(uint32_t, int32_t, 32); break;
+        case d_add8:  ADDCOND(uint8_t, 8); break;
+        case d_add16: ADDCOND(uint16_t, 16); break;
+        case d_add32: ADDCOND(uint32_t, 32); break;
+        case d_and8:
+        case d_or8:
+        case d_xor8:  LOGICCOND(uint8_t, 8); break;
+        case d_and16:
+        case d_or16:
+        case d_xor16: LOGICCOND(uint16_t, 16); break;
+        case d_and32:
+        case d_or32:
+        case d_xor32: LOGICCOND(uint32_t, 32); break;
+        default:
+            UpdateFlags(emu);
+            return FlagsCond(emu, cc);
+    }
+    #undef SUBCOND
+    #undef ADDCOND
+    #undef LOGICCOND
+    return r^(cc&1);
+}
+
 void Run67(x86emu_t *emu);
 void Run0F(x86emu_t *emu);
 void Run660F(x86emu_t *emu);
@@ -182,7 +266,56 @@ x86emu_t* x86emu_fork(x86emu_t* e, int forktype);
 void PackFlags(x86emu_t* emu);
 void UnpackFlags(x86emu_t* emu);
 
+// EFLAGS as a packed word (PUSHF, LAHF): OSZAPC are built straight from op1/op2/res for the ADD, SUB and logic
+// op families, without going through flags[]. The defered state is left untouched, like for EvalCond
+static inline uint32_t GetPackedFlags(x86emu_t* emu)
+{
+    uint32_t op1 = emu->op1, op2 = emu->op2, res = emu->res;
+    uint32_t c; // carry / borrow chain: bit i is the carry out of bit i
+    int w;
+    #define SUBCHAIN    (res & (~op1 | op2)) | (~op1 & op2)
+    #define ADDCHAIN    (op1 & op2) | (~res & (op1 | op2))
+    switch(emu->df) {
+        case d_none:
+            PackFlags(emu);
+            return emu->packed_eflags.x32;
+        case d_sub8:  w = 8;  c = SUBCHAIN; break;
+        case d_sub16: w = 16; c = SUBCHAIN; break;
+        case d_sub32: w = 32; c = SUBCHAIN; break;
+        case d_add8:  w = 8;  c = ADDCHAIN; break;
+        case d_add16: w = 16; c = ADDCHAIN; break;
+        case d_add32: w = 32; c = ADDCHAIN; break;
+        case d_and8:
+        case d_or8:
+        case d_xor8:  w = 8;  c = 0; break;
+        case d_and16:
+        case d_or16:
+        case d_xor16: w = 16; c = 0; break;
+        case d_and32:
+        case d_or32:
+        case d_xor32: w = 32; c = 0; break;
+        default:
+            UpdateFlags(emu);
+            PackFlags(emu);
+            return emu->packed_eflags.x32;
+    }
+    #undef SUBCHAIN
+    #undef ADDCHAIN
+    uint32_t f = ((c>>(w-1))&1)<<F_CF;
+    f |= (((c>>(w-2))^(c>>(w-1)))&1)<<F_OF;
+    f |= ((c>>3)&1)<<F_AF;
+    f |= ((res&(0xffffffffU>>(32-w)))==0)<<F_ZF;
+    f |= ((res>>(w-1))&1)<<F_SF;
+    f |= (((emu->x86emu_parity_tab[(res&0xff)/32]>>((res&0xff)%32))&1)==0)<<F_PF;
+    PackFlags(emu);
+    return (emu->packed_eflags.x32 & ~((1<<F_CF)|(1<<F_PF)|(1<<F_AF)|(1<<F_ZF)|(1<<F_SF)|(1<<F_OF))) | f;
+}
+
 uintptr_t GetGSBaseEmu(x86emu_t* emu);
+// CPUID command tmp32u
+void my_cpuid(x86emu_t* emu, uint32_t tmp32u);
+// called when emu->spin reach box86_pause_spin
+void SpinWait(x86emu_t* emu);
 
 const char* GetNativeName(x86emu_t* emu, void* p);
 
@@ -0,0 +1,317 @@
+#ifndef __X86SIMD_H_
+#define __X86SIMD_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "regs.h"
+
+/*
+    Packed MMX / SSE opcodes of the interpreter, on host SIMD
+
+Simple lane-wise ops (add, sub, logic, compare, multiply) use GCC vector extensions, so the compiler emits
+NEON on ARM or SSE2 on x86 for them. Saturating, min / max and average ops have no vector extension
+operator, they use NEON or SSE2 intrinsics (chosen at compile time), with a scalar fallback for other hosts.
+Every opcode works on a register (d, the destination) and a register or a memory operand (s), MMX ones are
+named _64 and SSE ones _128. Operands are loaded / stored with memcpy, as s can be unaligned guest memory.
+Float ops stay IEEE exact: GCC only use NEON for them when the FPU mode allows it (never with denormal flush).
+*/
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SIMD_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SIMD_SSE2
+#endif
+
+// signed types are only used for compares, wrapping arithmetic is done on unsigned lanes
+typedef int8_t   v8i8   __attribute__((vector_size(8)));
+typedef int16_t  v4i16  __attribute__((vector_size(8)));
+typedef int32_t  v2i32  __attribute__((vector_size(8)));
+typedef uint8_t  v8u8   __attribute__((vector_size(8)));
+typedef uint16_t v4u16  __attribute__((vector_size(8)));
+typedef uint32_t v2u32  __attribute__((vector_size(8)));
+typedef uint64_t v1u64  __attribute__((vector_size(8)));
+typedef int8_t   v16i8  __attribute__((vector_size(16)));
+typedef int16_t  v8i16  __attribute__((vector_size(16)));
+typedef int32_t  v4i32  __attribute__((vector_size(16)));
+typedef uint8_t  v16u8  __attribute__((vector_size(16)));
+typedef uint16_t v8u16  __attribute__((vector_size(16)));
+typedef uint32_t v4u32  __attribute__((vector_size(16)));
+typedef uint64_t v2u64  __attribute__((vector_size(16)));
+typedef float    v4f32  __attribute__((vector_size(16)));
+typedef double   v2f64  __attribute__((vector_size(16)));
+
+// d = d OP s, lane wise, with vector extensions (E is an expression of a and b)
+#define SIMD_VEXT(name, T64, T128, E)                                           \
+static inline void name##_64(mmx_regs_t* d, const mmx_regs_t* s)               \
+{                                                                               \
+    T64 a, b;                                                                   \
+    memcpy(&a, d, 8); memcpy(&b, s, 8);                                         \
+    a = E;                                                                      \
+    memcpy(d, &a, 8);                                                           \
+}                                                                               \
+static inline void name##_128(sse_regs_t* d, const sse_regs_t* s)              \
+{                                                                               \
+    T128 a, b;                                                                  \
+    memcpy(&a, d, 16); memcpy(&b, s, 16);                                       \
+    a = E;                                                                      \
+    memcpy(d, &a, 16);                                                          \
+}
+
+SIMD_VEXT(paddb,   v8u8,  v16u8, a+b)
+SIMD_VEXT(paddw,   v4u16, v8u16, a+b)
+SIMD_VEXT(paddd,   v2u32, v4u32, a+b)
+SIMD_VEXT(paddq,   v1u64, v2u64, a+b)
+SIMD_VEXT(psubb,   v8u8,  v16u8, a-b)
+SIMD_VEXT(psubw,   v4u16, v8u16, a-b)
+SIMD_VEXT(psubd,   v2u32, v4u32, a-b)
+SIMD_VEXT(psubq,   v1u64, v2u64, a-b)
+SIMD_VEXT(pand,    v2u32, v4u32, a&b)
+SIMD_VEXT(pandn,   v2u32, v4u32, (~a)&b)
+SIMD_VEXT(por,     v2u32, v4u32, a|b)
+SIMD_VEXT(pxor,    v2u32, v4u32, a^b)
+SIMD_VEXT(pcmpeqb, v8i8,  v16i8, a==b)
+SIMD_VEXT(pcmpeqw, v4i16, v8i16, a==b)
+SIMD_VEXT(pcmpeqd, v2i32, v4i32, a==b)
+SIMD_VEXT(pcmpgtb, v8i8,  v16i8, a>b)
+SIMD_VEXT(pcmpgtw, v4i16, v8i16, a>b)
+SIMD_VEXT(pcmpgtd, v2i32, v4i32, a>b)
+SIMD_VEXT(pmullw,  v4u16, v8u16, a*b)
+
+// packed float, SSE only
+#define SIMD_VEXTF(name, T, E)                                                  \
+static inline void name(sse_regs_t* d, const sse_regs_t* s)                    \
+{                                                                               \
+    T a, b;                                                                     \
+    memcpy(&a, d, 16); memcpy(&b, s, 16);                                       \
+    a = E;                                                                      \
+    memcpy(d, &a, 16);                                                          \
+}
+
+SIMD_VEXTF(addps, v4f32, a+b)
+SIMD_VEXTF(subps, v4f32, a-b)
+SIMD_VEXTF(mulps, v4f32, a*b)
+SIMD_VEXTF(divps, v4f32, a/b)
+SIMD_VEXTF(addpd, v2f64, a+b)
+SIMD_VEXTF(subpd, v2f64, a-b)
+SIMD_VEXTF(mulpd, v2f64, a*b)
+SIMD_VEXTF(divpd, v2f64, a/b)
+
+#if defined(SIMD_NEON)
+// d = OP(d, s) with a NEON intrinsic (sfx is the lane type suffix, like s8 or u16)
+#define SIMD_INTRIN(name, OP, sfx, T)                                           \
+static inline void name##_64(mmx_regs_t* d, const mmx_regs_t* s)               \
+{                                                                               \
+    vst1_##sfx((T*)d, OP##_##sfx(vld1_##sfx((const T*)d), vld1_##sfx((const T*)s))); \
+}                                                                               \
+static inline void name##_128(sse_regs_t* d, const sse_regs_t* s)              \
+{                                                                               \
+    vst1q_##sfx((T*)d, OP##q_##sfx(vld1q_##sfx((const T*)d), vld1q_##sfx((const T*)s))); \
+}
+
+SIMD_INTRIN(paddsb, vqadd, s8, int8_t)
+SIMD_INTRIN(paddsw, vqadd, s16, int16_t)
+SIMD_INTRIN(paddusb, vqadd, u8, uint8_t)
+SIMD_INTRIN(paddusw, vqadd, u16, uint16_t)
+SIMD_INTRIN(psubsb, vqsub, s8, int8_t)
+SIMD_INTRIN(psubsw, vqsub, s16, int16_t)
+SIMD_INTRIN(psubusb, vqsub, u8, uint8_t)
+SIMD_INTRIN(psubusw, vqsub, u16, uint16_t)
+SIMD_INTRIN(pminub, vmin, u8, uint8_t)
+SIMD_INTRIN(pmaxub, vmax, u8, uint8_t)
+SIMD_INTRIN(pminsw, vmin, s16, int16_t)
+SIMD_INTRIN(pmaxsw, vmax, s16, int16_t)
+SIMD_INTRIN(pavgb, vrhadd, u8, uint8_t)
+SIMD_INTRIN(pavgw, vrhadd, u16, uint16_t)
+
+#elif defined(SIMD_SSE2)
+// d = OP(d, s) with an SSE2 intrinsic (MMX ones use the low half of an xmm register)
+#define SIMD_INTRIN(name, OP)                                                   \
+static inline void name##_64(mmx_regs_t* d, const mmx_regs_t* s)               \
+{                                                                               \
+    _mm_storel_epi64((__m128i*)d, OP(_mm_loadl_epi64((const __m128i*)d), _mm_loadl_epi64((const __m128i*)s))); \
+}                                                                               \
+static inline void name##_128(sse_regs_t* d, const sse_regs_t* s)              \
+{                                                                               \
+    _mm_storeu_si128((__m128i*)d, OP(_mm_loadu_si128((const __m128i*)d), _mm_loadu_si128((const __m128i*)s))); \
+}
+
+SIMD_INTRIN(paddsb, _mm_adds_epi8)
+SIMD_INTRIN(paddsw, _mm_adds_epi16)
+SIMD_INTRIN(paddusb, _mm_adds_epu8)
+SIMD_INTRIN(paddusw, _mm_adds_epu16)
+SIMD_INTRIN(psubsb, _mm_subs_epi8)
+SIMD_INTRIN(psubsw, _mm_subs_epi16)
+SIMD_INTRIN(psubusb, _mm_subs_epu8)
+SIMD_INTRIN(psubusw, _mm_subs_epu16)
+SIMD_INTRIN(pminub, _mm_min_epu8)
+SIMD_INTRIN(pmaxub, _mm_max_epu8)
+SIMD_INTRIN(pminsw, _mm_min_epi16)
+SIMD_INTRIN(pmaxsw, _mm_max_epi16)
+SIMD_INTRIN(pavgb, _mm_avg_epu8)
+SIMD_INTRIN(pavgw, _mm_avg_epu16)
+
+#else
+// d = E(a, b), one lane at a time (F is the lane field of mmx_regs_t / sse_regs_t)
+#define SIMD_SAT(V, L, H)   (((V)<(L))?(L):(((V)>(H))?(H):(V)))
+#define SIMD_INTRIN(name, F, N, E)                                              \
+static inline void name##_64(mmx_regs_t* d, const mmx_regs_t* s)               \
+{                                                                               \
+    for(int i=0; i<N; ++i) {                                                    \
+        int32_t a = d->F[i], b = s->F[i];                                       \
+        d->F[i] = E;                                                            \
+    }                                                                           \
+}                                                                               \
+static inline void name##_128(sse_regs_t* d, const sse_regs_t* s)              \
+{                                                                               \
+    for(int i=0; i<N*2; ++i) {                                                  \
+        int32_t a = d->F[i], b = s->F[i];                                       \
+        d->F[i] = E;                                                            \
+    }                                                                           \
+}
+
+SIMD_INTRIN(paddsb, sb, 8, SIMD_SAT(a+b, -128, 127))
+SIMD_INTRIN(paddsw, sw, 4, SIMD_SAT(a+b, -32768, 32767))
+SIMD_INTRIN(paddusb, ub, 8, SIMD_SAT(a+b, 0, 255))
+SIMD_INTRIN(paddusw, uw, 4, SIMD_SAT(a+b, 0, 65535))
+SIMD_INTRIN(psubsb, sb, 8, SIMD_SAT(a-b, -128, 127))
+SIMD_INTRIN(psubsw, sw, 4, SIMD_SAT(a-b, -32768, 32767))
+SIMD_INTRIN(psubusb, ub, 8, SIMD_SAT(a-b, 0, 255))
+SIMD_INTRIN(psubusw, uw, 4, SIMD_SAT(a-b, 0, 65535))
+SIMD_INTRIN(pminub, ub, 8, (a<b)?a:b)
+SIMD_INTRIN(pmaxub, ub, 8, (a>b)?a:b)
+SIMD_INTRIN(pminsw, sw, 4, (a<b)?a:b)
+SIMD_INTRIN(pmaxsw, sw, 4, (a>b)?a:b)
+SIMD_INTRIN(pavgb, ub, 8, (a+b+1)>>1)
+SIMD_INTRIN(pavgw, uw, 4, (a+b+1)>>1)
+
+#undef SIMD_SAT
+#endif
+
+/*
+SSSE3 ops, that shuffle or combine lanes in ways host SIMD doesn't match exactly. They are written once,
+for n bytes (8 for MMX, 16 for SSE), on copies of both operands (d and s can be the same register).
+*/
+#define SIMD_SAT16(V)   (((V)<-32768)?-32768:(((V)>32767)?32767:(V)))
+
+static inline void pshufb_n(uint8_t* d, const uint8_t* s, int n)
+{
+    sse_regs_t a, b;
+    memcpy(&a, d, n); memcpy(&b, s, n);
+    for(int i=0; i<n; ++i)
+        d[i] = (b.ub[i]&128)?0:a.ub[b.ub[i]&(n-1)];
+}
+// horizontal ops: the low half of the result comes from d, the high half from s
+#define SIMD_HORIZ(name, F, T, E)                                               \
+static inline void name##_n(uint8_t* d, const uint8_t* s, int n)               \
+{                                                                               \
+    sse_regs_t a, b, r;                                                         \
+    memcpy(&a, d, n); memcpy(&b, s, n);                                         \
+    int c = n/sizeof(T);                                                        \
+    for(int i=0; i<c/2; ++i) {                                                  \
+        int32_t x = a.F[i*2], y = a.F[i*2+1];                                   \
+        r.F[i] = E;                                                             \
+        x = b.F[i*2]; y = b.F[i*2+1];                                           \
+        r.F[c/2+i] = E;                                                         \
+    }                                                                           \
+    memcpy(d, &r, n);                                                           \
+}
+SIMD_HORIZ(phaddw, sw, int16_t, x+y)
+SIMD_HORIZ(phaddd, sd, int32_t, (uint32_t)x+(uint32_t)y)
+SIMD_HORIZ(phaddsw, sw, int16_t, SIMD_SAT16(x+y))
+SIMD_HORIZ(phsubw, sw, int16_t, x-y)
+SIMD_HORIZ(phsubd, sd, int32_t, (uint32_t)x-(uint32_t)y)
+SIMD_HORIZ(phsubsw, sw, int16_t, SIMD_SAT16(x-y))
+#undef SIMD_HORIZ
+
+static inline void pmaddubsw_n(uint8_t* d, const uint8_t* s, int n)
+{
+    sse_regs_t a, b;
+    memcpy(&a, d, n); memcpy(&b, s, n);
+    for(int i=0; i<n/2; ++i) {
+        int32_t v = (int32_t)a.ub[i*2]*b.sb[i*2] + (int32_t)a.ub[i*2+1]*b.sb[i*2+1];
+        a.sw[i] = SIMD_SAT16(v);
+    }
+    memcpy(d, &a, n);
+}
+static inline void pmulhrsw_n(uint8_t* d, const uint8_t* s, int n)
+{
+    sse_regs_t a, b;
+    memcpy(&a, d, n); memcpy(&b, s, n);
+    for(int i=0; i<n/2; ++i)
+        a.sw[i] = ((((int32_t)a.sw[i]*b.sw[i])>>14)+1)>>1;
+    memcpy(d, &a, n);
+}
+// d = -d, 0 or d depending on the sign of s / d = |s|
+#define SIMD_SIGNABS(sfx, F, T)                                                 \
+static inline void psign##sfx##_n(uint8_t* d, const uint8_t* s, int n)         \
+{                                                                               \
+    sse_regs_t a, b;                                                            \
+    memcpy(&a, d, n); memcpy(&b, s, n);                                         \
+    for(int i=0; i<n/(int)sizeof(T); ++i)                                       \
+        a.F[i] = (b.F[i]<0)?(T)(0-(u##T)a.F[i]):((b.F[i])?a.F[i]:0);           \
+    memcpy(d, &a, n);                                                           \
+}                                                                               \
+static inline void pabs##sfx##_n(uint8_t* d, const uint8_t* s, int n)          \
+{                                                                               \
+    sse_regs_t b;                                                               \
+    memcpy(&b, s, n);                                                           \
+    for(int i=0; i<n/(int)sizeof(T); ++i)                                       \
+        b.F[i] = (b.F[i]<0)?(T)(0-(u##T)b.F[i]):b.F[i];                        \
+    memcpy(d, &b, n);                                                           \
+}
+SIMD_SIGNABS(b, sb, int8_t)
+SIMD_SIGNABS(w, sw, int16_t)
+SIMD_SIGNABS(d, sd, int32_t)
+#undef SIMD_SIGNABS
+#undef SIMD_SAT16
+
+// the MMX / SSE version of each SSSE3 op
+#define SIMD_SIZES(name)                                                        \
+static inline void name##_64(mmx_regs_t* d, const mmx_regs_t* s)               \
+{                                                                               \
+    name##_n((uint8_t*)d, (const uint8_t*)s, 8);                                \
+}                                                                               \
+static inline void name##_128(sse_regs_t* d, const sse_regs_t* s)              \
+{                                                                               \
+    name##_n((uint8_t*)d, (const uint8_t*)s, 16);                               \
+}
+SIMD_SIZES(pshufb)
+SIMD_SIZES(phaddw)
+SIMD_SIZES(phaddd)
+SIMD_SIZES(phaddsw)
+SIMD_SIZES(phsubw)
+SIMD_SIZES(phsubd)
+SIMD_SIZES(phsubsw)
+SIMD_SIZES(pmaddubsw)
+SIMD_SIZES(pmulhrsw)
+SIMD_SIZES(psignb)
+SIMD_SIZES(psignw)
+SIMD_SIZES(psignd)
+SIMD_SIZES(pabsb)
+SIMD_SIZES(pabsw)
+SIMD_SIZES(pabsd)
+#undef SIMD_SIZES
+
+// d = bytes imm to imm+n-1 of s:d (s is the low part)
+static inline void palignr_n(uint8_t* d, const uint8_t* s, int n, uint8_t imm)
+{
+    uint8_t tmp[32] = {0};
+    memcpy(tmp, s, n); memcpy(tmp+n, d, n);
+    for(int i=0; i<n; ++i)
+        d[i] = (imm+i<n*2)?tmp[imm+i]:0;
+}
+static inline void palignr_64(mmx_regs_t* d, const mmx_regs_t* s, uint8_t imm)
+{
+    palignr_n((uint8_t*)d, (const uint8_t*)s, 8, imm);
+}
+static inline void palignr_128(sse_regs_t* d, const sse_regs_t* s, uint8_t imm)
+{
+    palignr_n((uint8_t*)d, (const uint8_t*)s, 16, imm);
+}
+#undef SIMD_INTRIN
+#undef SIMD_VEXT
+#undef SIMD_VEXTF
+
+#endif //__X86SIMD_H_
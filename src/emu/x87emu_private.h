@@ -159,14 +159,14 @@ static inline float fpu_round(x86emu_t* emu, float d) {
         return d;
     switch(emu->round) {
         case ROUND_Nearest:
-            return floorf(d+0.5);
+            return nearbyintf(d);   // ties to even, like the x87
         case ROUND_Down:
             return floorf(d);
         case ROUND_Up:
             return ceilf(d);
         case ROUND_Chop:
         default:
-            return roundf(d);
+            return truncf(d);
     }
 }
 #else
@@ -175,18 +175,27 @@ static inline double fpu_round(x86emu_t* emu, double d) {
         return d;
     switch(emu->round) {
         case ROUND_Nearest:
-            return floor(d+0.5);
+            return nearbyint(d);   // ties to even, like the x87
         case ROUND_Down:
             return floor(d);
         case ROUND_Up:
             return ceil(d);
         case ROUND_Chop:
         default:
-            return round(d);
+            return trunc(d);
     }
 }
 #endif
 
+#ifndef USE_FLOAT
+// x87 division, done in single precision when BOX86_X87_PRECISION is float
+static inline double fpu_div(double a, double b) {
+    if(box86_x87_precision==X87_FLOAT)
+        return (float)a / (float)b;
+    return a / b;
+}
+#endif
+
 static inline void fpu_fxam(x86emu_t* emu) {
     #ifdef USE_FLOAT
     emu->sw.f.F87_C1 = (ST0.ll&0x8000)?1:0;
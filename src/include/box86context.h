@@ -24,6 +24,7 @@ typedef struct atfork_fnc_s {
 } atfork_fnc_t;
 #ifdef DYNAREC
 typedef struct dynablocklist_s dynablocklist_t;
+typedef struct dynablock_s     dynablock_t;
 typedef struct mmaplist_s      mmaplist_t;
 typedef struct dynmap_s        dynmap_t;
 #endif
@@ -133,7 +134,14 @@ typedef struct box86context_s {
     dynablocklist_t     *dynablocks;
     mmaplist_t          *mmaplist;
     int                 mmapsize;
+    uintptr_t           dynarec_near;       // code arena reserved in BL range of box86 text (0 if not available)
+    mmaplist_t          *nearmap;           // the near arena
     dynmap_t*           dynmap[65536];  // 4G of memory mapped by 64K block
+    uint32_t            dynarec_nblocks;    // stats: number of block emited
+    uint32_t            dynarec_x86size;    // stats: x86 bytes translated
+    uint32_t            dynarec_armsize;    // stats: ARM bytes emited
+    uint32_t            dynarec_thumb2size; // stats: size of the same blocks in Thumb-2 (BOX86_DYNAREC_THUMB2)
+    uint32_t            dynarec_thumb2untr; // stats: ARM opcodes without Thumb-2 equivalent
 #endif
 #ifndef NOALIGN
     kh_fts_t            *ftsmap;
@@ -164,7 +172,11 @@ int AddTLSPartition(box86context_t* context, int tlssize);
 
 #ifdef DYNAREC
 // the nolinker specified if static map or dynamic (can be deleted) has to be used
-uintptr_t AllocDynarecMap(box86context_t *context, int size, int nolinker);
+uintptr_t AllocDynarecMap(box86context_t *context, int size, int nolinker, dynablock_t* db);
+uintptr_t AllocDynarecNear(box86context_t *context, int size, dynablock_t* db);
+int IsDynarecNear(box86context_t *context, uintptr_t target);
+dynablock_t* FindDynablockFromNativeAddress(box86context_t *context, uintptr_t addr, uintptr_t* start);
+void RemoveDynarecOwner(uintptr_t addr, dynablock_t* db);
 
 dynablocklist_t* getDBFromAddress(box86context_t* context, uintptr_t addr);
 void addDBFromAddressRange(box86context_t* context, uintptr_t addr, uintptr_t size);
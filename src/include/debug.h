@@ -9,6 +9,11 @@ extern int box86_dynarec;
 extern int box86_dynarec_linker;
 extern int box86_dynarec_trace;
 extern int box86_dynarec_forced;
+extern int box86_dynarec_peephole;
+extern int box86_dynarec_strongmem;
+extern int box86_dynarec_perfmap;
+extern int box86_dynarec_thumb2;
+extern int box86_dynarec_lockstep;
 #ifdef ARM
 extern int arm_vfp;     // vfp version (3 or 4), with 32 registers is mendatory
 extern int arm_swap;
@@ -19,6 +24,19 @@ extern int dlsym_error;  // log dlsym error
 extern int trace_xmm;    // include XMM reg in trace?
 extern int trace_emm;    // include EMM reg in trace?
 extern int allow_missing_libs;
+extern int box86_fastrdtsc;     // RDTSC read the ARM generic timer directly
+extern int box86_x87_precision; // one of the X87_xxx below
+#define X87_FLOAT   0   // double, but divisions and square roots are done in single precision
+#define X87_DOUBLE  1   // double only, no 80bits / 64bits integer shadows
+#define X87_EXACT80 2   // double, with a shadow of 80bits and 64bits integer loads so they are stored back exactly
+extern int box86_pause_spin;    // number of PAUSE / polling loops before yielding the CPU (0 to never yield)
+extern int box86_superinst;     // the interpreter run common opcode pairs / sequences without dispatch
+extern int box86_profile;       // SIGPROF samples per second of thread CPU time (0 to not profile)
+extern int box86_sse;           // highest SSE extension advertised by CPUID, one of the SSE_xxx below
+#define SSE_SSE2    0
+#define SSE_SSE3    1
+#define SSE_SSSE3   2
+#define SSE_SSE41   3
 #define LOG_NONE 0
 #define LOG_INFO 1
 #define LOG_DEBUG 2
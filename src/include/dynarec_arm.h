@@ -4,6 +4,13 @@
 typedef struct dynablock_s dynablock_t;
 typedef struct x86emu_s x86emu_t;
 
+typedef struct box86context_s box86context_t;
+
 void FillBlock(x86emu_t* emu, dynablock_t* block, uintptr_t addr);
+// SIGBUS handler that recover from unaligned accesses in generated code
+void InstallUnalignedHandler(box86context_t* context);
+// if the handler is installed, set (and / or get) the SIGBUS action it chains to, and return 1 (0 if not installed)
+struct sigaction;
+int UnalignedSigaction(const struct sigaction* act, struct sigaction* oldact);
 
 #endif //__DYNAREC_ARM_H_
\ No newline at end of file
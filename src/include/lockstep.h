@@ -0,0 +1,13 @@
+#ifndef __LOCKSTEP_H_
+#define __LOCKSTEP_H_
+#include <stdint.h>
+
+typedef struct x86emu_s x86emu_t;
+typedef struct dynablock_s dynablock_t;
+
+// return 1 if the x86 instruction at addr can be run again by the interpreter after the block ran (last: last instruction of the block)
+int LockstepCheckable(uintptr_t addr, int last);
+// run the block, and 1 time every box86_dynarec_lockstep, run it again with the interpreter and compare
+void LockstepRun(x86emu_t* emu, dynablock_t* block);
+
+#endif //__LOCKSTEP_H_
@@ -0,0 +1,12 @@
+#ifndef __PERFMAP_H_
+#define __PERFMAP_H_
+#include <stdint.h>
+
+typedef struct x86emu_s x86emu_t;
+
+// open /tmp/perf-<pid>.map (and /tmp/jit-<pid>.dump if box86_dynarec_perfmap is 2)
+void PerfMapInit();
+// add a translated block (native call bridges are named after the native function)
+void PerfMapAddBlock(x86emu_t* emu, uintptr_t x86addr, int x86size, void* code, int codesize);
+
+#endif //__PERFMAP_H_
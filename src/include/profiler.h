@@ -0,0 +1,25 @@
+#ifndef __PROFILER_H_
+#define __PROFILER_H_
+#include <stdint.h>
+
+typedef struct box86context_s box86context_t;
+typedef struct x86emu_s x86emu_t;
+
+// what the sampler must know about the running thread, saved / restored around nested emulation
+typedef struct profstate_s {
+    x86emu_t*   emu;
+    uintptr_t   native;
+} profstate_t;
+
+// install the SIGPROF handler, sampling box86_profile times per second of thread CPU time
+void ProfilerInit(box86context_t* context);
+// the thread start running emu (the per thread timer is created the first time)
+profstate_t ProfilerEnterEmu(x86emu_t* emu);
+void ProfilerLeaveEmu(profstate_t old);
+// the thread is calling the native function fnc (from a wrapper)
+uintptr_t ProfilerEnterNative(uintptr_t fnc);
+void ProfilerLeaveNative(uintptr_t old);
+// stop sampling, symbolize and write /tmp/box86-<pid>.folded
+void ProfilerDump(box86context_t* context);
+
+#endif //__PROFILER_H_
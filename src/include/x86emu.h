@@ -40,6 +40,10 @@ void CallAllCleanup(x86emu_t *emu);
 void UnimpOpcode(x86emu_t* emu);
 
 uint64_t ReadTSC(x86emu_t* emu);
+// check the time source of ReadTSC (box86_fastrdtsc is reset if the ARM generic timer cannot be used)
+void InitTSC();
+// frequency of the value returned by ReadTSC, in Hz (the native TSC is measured on the first call)
+uint64_t ReadTSCFrequency();
 
 double FromLD(void* ld);        // long double (80bits pointer) -> double
 void LD2D(void* ld, void* d);   // long double (80bits) -> double (64bits)
@@ -17,6 +17,9 @@
 #include "box86stack.h"
 #include "dynarec.h"
 #include "callback.h"
+#ifdef DYNAREC
+#include "dynarec_arm.h"
+#endif
 
 
 static box86context_t *context = NULL;  // global context, because signals are globals?
@@ -189,6 +192,16 @@ static void CheckSignalContext(x86emu_t* emu, int sig)
     }
 }
 
+// the dynarec keeps SIGBUS for unaligned accesses, and chains other SIGBUS to the action set here
+static int native_sigaction(int signum, const struct sigaction* act, struct sigaction* oldact)
+{
+#ifdef DYNAREC
+    if(signum==SIGBUS && UnalignedSigaction(act, oldact))
+        return 0;
+#endif
+    return sigaction(signum, act, oldact);
+}
+
 EXPORT sighandler_t my_signal(x86emu_t* emu, int signum, sighandler_t handler)
 {
     if(signum<0 || signum>=MAX_SIGNAL)
@@ -206,6 +219,17 @@ EXPORT sighandler_t my_signal(x86emu_t* emu, int signum, sighandler_t handler)
         context->restorer[signum] = 0;
         handler = my_sighandler;
     }
+#ifdef DYNAREC
+    if(signum==SIGBUS) {
+        struct sigaction newact = {0};
+        struct sigaction old = {0};
+        newact.sa_handler = handler;
+        newact.sa_flags = SA_RESTART;   // signal() has BSD semantics
+        sigemptyset(&newact.sa_mask);
+        if(UnalignedSigaction(&newact, &old))
+            return old.sa_handler;
+    }
+#endif
     return signal(signum, handler);
 }
 EXPORT sighandler_t my___sysv_signal(x86emu_t* emu, int signum, sighandler_t handler) __attribute__((alias("my_signal")));
@@ -239,7 +263,7 @@ int EXPORT my_sigaction(x86emu_t* emu, int signum, const x86_sigaction_t *act, x
         }
         context->restorer[signum] = (act->sa_flags&0x04000000)?(uintptr_t)act->sa_restorer:0;
     }
-    int ret = sigaction(signum, act?&newact:NULL, oldact?&old:NULL);
+    int ret = native_sigaction(signum, act?&newact:NULL, oldact?&old:NULL);
     if(oldact) {
         oldact->sa_flags = old.sa_flags;
         oldact->sa_mask = old.sa_mask;
@@ -337,7 +361,7 @@ int EXPORT my_syscall_sigaction(x86emu_t* emu, int signum, const x86_sigaction_r
             old.sa_mask = oldact->sa_mask;
         }
 
-        int ret = sigaction(signum, act?&newact:NULL, oldact?&old:NULL);
+        int ret = native_sigaction(signum, act?&newact:NULL, oldact?&old:NULL);
         if(oldact && ret==0) {
             oldact->sa_flags = old.sa_flags;
             oldact->sa_mask = old.sa_mask;
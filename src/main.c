@@ -16,6 +16,7 @@
 #include <time.h>
 #include <limits.h>
 #include <errno.h>
+#include <unistd.h>
 #ifdef DYNAREC
 #ifdef ARM
 #include <sys/auxv.h>
@@ -35,6 +36,11 @@
 #include "librarian.h"
 #include "library.h"
 #include "auxval.h"
+#ifdef DYNAREC
+#include "dynarec_arm.h"
+#include "perfmap.h"
+#endif
+#include "profiler.h"
 
 int box86_log = LOG_INFO;//LOG_NONE;
 #ifdef DYNAREC
@@ -43,6 +49,11 @@ int box86_dynarec_log = LOG_NONE;
 int box86_dynarec = 1;
 int box86_dynarec_linker = 1;
 int box86_dynarec_forced = 0;
+int box86_dynarec_peephole = 1;
+int box86_dynarec_strongmem = 0;
+int box86_dynarec_perfmap = 0;
+int box86_dynarec_thumb2 = 0;
+int box86_dynarec_lockstep = 0;
 #ifdef ARM
 int arm_vfp = 0;     // vfp version (3 or 4), with 32 registers is mendatory
 int arm_swap = 0;
@@ -63,6 +74,12 @@ int x11color16 = 0;
 #endif
 int x11threads = 0;
 int allow_missing_libs = 0;
+int box86_pause_spin = 64;
+int box86_profile = 0;
+int box86_superinst = 1;
+int box86_sse = SSE_SSSE3;
+int box86_fastrdtsc = 0;
+int box86_x87_precision = X87_EXACT80;
 char* libGL = NULL;
 
 FILE* ftrace = NULL;
@@ -195,6 +212,52 @@ void LoadLogEnv()
         if(box86_dynarec_forced)
         printf_log(LOG_INFO, "Dynarec is Forced on all addresses\n");
     }
+    p = getenv("BOX86_DYNAREC_PEEPHOLE");
+    if(p) {
+        if(strlen(p)==1) {
+            if(p[0]>='0' && p[0]<='1')
+                box86_dynarec_peephole = p[0]-'0';
+        }
+        printf_log(LOG_INFO, "Dynarec Peephole is %s\n", box86_dynarec_peephole?"On":"Off");
+    }
+    p = getenv("BOX86_DYNAREC_STRONGMEM");
+    if(p) {
+        if(strlen(p)==1) {
+            if(p[0]>='0' && p[0]<='2')
+                box86_dynarec_strongmem = p[0]-'0';
+        }
+        const char* mode[] = {"weak", "TSO", "TSO-selective"};
+        printf_log(LOG_INFO, "Dynarec memory ordering is %s\n", mode[box86_dynarec_strongmem]);
+    }
+    p = getenv("BOX86_DYNAREC_PERFMAP");
+    if(p) {
+        if(strlen(p)==1) {
+            if(p[0]>='0' && p[0]<='2')
+                box86_dynarec_perfmap = p[0]-'0';
+        }
+        if(box86_dynarec_perfmap)
+            printf_log(LOG_INFO, "Dynarec will write a perf map%s\n", (box86_dynarec_perfmap==2)?" and a jitdump":"");
+    }
+    p = getenv("BOX86_DYNAREC_THUMB2");
+    if(p) {
+        if(strlen(p)==1) {
+            if(p[0]>='0' && p[0]<='1')
+                box86_dynarec_thumb2 = p[0]-'0';
+        }
+        if(box86_dynarec_thumb2)
+            printf_log(LOG_INFO, "Dynarec will measure the Thumb-2 size of the blocks\n");
+    }
+    p = getenv("BOX86_DYNAREC_LOCKSTEP");
+    if(p) {
+        char* p2;
+        int n = strtol(p, &p2, 10);
+        if(p2!=p && n>=0)
+            box86_dynarec_lockstep = n;
+        if(box86_dynarec_lockstep) {
+            box86_dynarec_linker = 0;   // each block must go back to the main loop
+            printf_log(LOG_INFO, "Dynarec blocks are checked against the interpreter (1 run every %d), Linker is Off\n", box86_dynarec_lockstep);
+        }
+    }
 #endif
 #ifdef HAVE_TRACE
     p = getenv("BOX86_TRACE_XMM");
@@ -285,6 +348,58 @@ void LoadLogEnv()
         if(allow_missing_libs)
             printf_log(LOG_INFO, "Allow missing needed libs\n");
     }
+    p = getenv("BOX86_FASTRDTSC");
+    if(p) {
+        if(strlen(p)==1) {
+            if(p[0]>='0' && p[0]<='1')
+                box86_fastrdtsc = p[0]-'0';
+        }
+    }
+    p = getenv("BOX86_X87_PRECISION");
+    if(p) {
+        const char* mode[] = {"float", "double", "exact80"};
+        for(int i=0; i<3; ++i)
+            if(!strcmp(p, mode[i]))
+                box86_x87_precision = i;
+        printf_log(LOG_INFO, "x87 precision is %s\n", mode[box86_x87_precision]);
+    }
+    p = getenv("BOX86_SSE");
+    if(p) {
+        const char* level[] = {"sse2", "sse3", "ssse3", "sse4.1"};
+        for(int i=0; i<4; ++i)
+            if(!strcmp(p, level[i]))
+                box86_sse = i;
+        printf_log(LOG_INFO, "CPUID advertise up to %s\n", level[box86_sse]);
+    }
+    p = getenv("BOX86_PROFILE");
+    if(p) {
+        char* p2;
+        int n = strtol(p, &p2, 10);
+        if(p2!=p && n>=0)
+            box86_profile = (n==1)?100:n;
+        if(box86_profile)
+            printf_log(LOG_INFO, "Profiling emulated threads at %dHz, to /tmp/box86-%d.folded\n", box86_profile, getpid());
+    }
+    p = getenv("BOX86_SUPERINST");
+    if(p) {
+        if(strlen(p)==1) {
+            if(p[0]>='0' && p[0]<='1')
+                box86_superinst = p[0]-'0';
+        }
+        if(!box86_superinst)
+            printf_log(LOG_INFO, "Interpreter superinstructions are Off\n");
+    }
+    p = getenv("BOX86_PAUSE_SPIN");
+    if(p) {
+        char* p2;
+        int spin = strtol(p, &p2, 10);
+        if(p2!=p && spin>=0)
+            box86_pause_spin = spin;
+        if(box86_pause_spin)
+            printf_log(LOG_INFO, "Yield the CPU after %d PAUSE / polling loops\n", box86_pause_spin);
+        else
+            printf_log(LOG_INFO, "Never yield the CPU on PAUSE / polling loops\n");
+    }
 #ifdef DYNAREC
     GatherDynarecExtensions();
 #endif
@@ -562,10 +677,19 @@ int main(int argc, const char **argv, const char **env) {
 
     // check BOX86_LOG debug level
     LoadLogEnv();
+    InitTSC();
     
     // Create a new context
     box86context_t *context = NewBox86Context(argc - 1);
     context->box86path = strdup(argv[0]);
+#ifdef DYNAREC
+    if(box86_dynarec)
+        InstallUnalignedHandler(context);
+    if(box86_dynarec && box86_dynarec_perfmap)
+        PerfMapInit();
+#endif
+    if(box86_profile)
+        ProfilerInit(context);
 
     const char *p;
     const char* prog = argv[1];
@@ -0,0 +1,351 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "debug.h"
+#include "box86context.h"
+#include "elfloader.h"
+#include "x86emu.h"
+#include "emu/x86emu_private.h"
+#include "emu/x86run_private.h"
+#include "profiler.h"
+#include "khash.h"
+#ifdef DYNAREC
+#include "dynablock.h"
+#include "dynarec/dynablock_private.h"
+#endif
+
+/*
+    Sampling profiler
+
+Each thread running x86 code gets a CLOCK_THREAD_CPUTIME_ID timer sending SIGPROF to that thread only,
+so only threads that use the CPU are sampled. The handler only touches memory of its own thread, allocated
+beforehand: it takes the x86 EIP (or the ARM PC when in generated code, translated at exit thanks to the
+dynablock), does a frame pointer walk of the x86 stack (bounded by the emu stack, so no fault is possible),
+and counts the stack in a small per thread hash table. Everything else (symbols, output) is done at exit.
+When the thread is inside a native wrapped function, the leaf is that function (the "native:" bucket).
+The interpreter normally only write back EIP when it leaves, so when profiling it also stores it on each
+dispatch (that's the leaf for interpreted code).
+*/
+
+#define PROF_DEPTH  32          // frames kept per sample
+#define PROF_SIZE   4096        // different stacks per thread (power of 2)
+#define PROF_PROBES 16
+
+#define PROF_X86    0           // frames[0] is an x86 address
+#define PROF_ARM    1           // frames[0] is an ARM address in generated code
+#define PROF_NATIVE 2           // frames[0] is a native wrapped function
+
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+
+typedef struct profsample_s {
+    uint32_t    hash;
+    uint32_t    count;          // 0 for a free entry
+    uint8_t     kind;
+    uint8_t     depth;
+    uint32_t    frames[PROF_DEPTH];
+} profsample_t;
+
+typedef struct profthread_s {
+    x86emu_t*       emu;
+    uintptr_t       native;
+    timer_t         timer;
+    int             has_timer;
+    uint32_t        lost;       // samples that didn't fit in the table
+    profsample_t*   samples;
+    struct profthread_s* next;
+} profthread_t;
+
+KHASH_MAP_INIT_STR(folded, uint32_t)
+
+static volatile int profiler_on = 0;
+static pid_t profiler_pid = 0;
+static pthread_key_t profiler_key;
+static pthread_mutex_t profiler_mutex = PTHREAD_MUTEX_INITIALIZER;
+static profthread_t* profiler_threads = NULL;
+static __thread profthread_t* profiler_self = NULL;
+
+extern char __executable_start[];
+extern char etext[];
+
+static void profiler_add(profthread_t* t, int kind, uint32_t* frames, int n)
+{
+    uint32_t h = 2166136261u^kind;
+    for(int i=0; i<n; ++i)
+        h = (h^frames[i])*16777619u;
+    for(int p=0; p<PROF_PROBES; ++p) {
+        profsample_t* s = &t->samples[(h+p)&(PROF_SIZE-1)];
+        if(!s->count) {
+            s->hash = h;
+            s->kind = kind;
+            s->depth = n;
+            for(int i=0; i<n; ++i)
+                s->frames[i] = frames[i];
+            s->count = 1;
+            return;
+        }
+        if(s->hash==h && s->kind==kind && s->depth==n) {
+            int i = 0;
+            while(i<n && s->frames[i]==frames[i])
+                ++i;
+            if(i==n) {
+                ++s->count;
+                return;
+            }
+        }
+    }
+    ++t->lost;
+}
+
+static void profiler_signal(int sig, siginfo_t* info, void* ucntx)
+{
+    profthread_t* t = profiler_self;
+    if(!t || !t->emu || !profiler_on)
+        return;
+    x86emu_t* emu = t->emu;
+    uint32_t frames[PROF_DEPTH];
+    int kind = PROF_X86;
+    uintptr_t esp = R_ESP;
+    uintptr_t ebp = R_EBP;
+    if(t->native) {
+        kind = PROF_NATIVE;
+        frames[0] = t->native;
+    } else {
+        frames[0] = R_EIP;
+#if defined(DYNAREC) && defined(ARM)
+        // generated code keeps emu in r0 and the x86 registers in r4-r11, and doesn't live in box86 text
+        ucontext_t* uc = (ucontext_t*)ucntx;
+        uintptr_t pc = uc->uc_mcontext.arm_pc;
+        if(uc->uc_mcontext.arm_r0==(uintptr_t)emu && (pc<(uintptr_t)__executable_start || pc>=(uintptr_t)etext)) {
+            kind = PROF_ARM;
+            frames[0] = pc;
+            esp = uc->uc_mcontext.arm_r8;
+            ebp = uc->uc_mcontext.arm_r9;
+        }
+#endif
+    }
+    int n = 1;
+    uintptr_t top = (uintptr_t)emu->init_stack + emu->size_stack;
+    if(esp>=(uintptr_t)emu->init_stack && esp<top) {
+        if(kind==PROF_NATIVE && esp+4<=top)
+            frames[n++] = *(uint32_t*)esp;     // the x86 caller of the wrapped function
+        while(n<PROF_DEPTH && ebp>=esp && ebp+8<=top && !(ebp&3)) {
+            frames[n++] = ((uint32_t*)ebp)[1];
+            uintptr_t next = ((uint32_t*)ebp)[0];
+            if(next<=ebp)
+                break;
+            ebp = next;
+        }
+    }
+    profiler_add(t, kind, frames, n);
+}
+
+static void profiler_thread_end(void* p)
+{
+    profthread_t* t = (profthread_t*)p;
+    t->emu = NULL;
+    if(t->has_timer) {
+        timer_delete(t->timer);
+        t->has_timer = 0;
+    }
+}
+
+static profthread_t* profiler_thread_start()
+{
+    profthread_t* t = (profthread_t*)calloc(1, sizeof(profthread_t));
+    t->samples = (profsample_t*)mmap(NULL, PROF_SIZE*sizeof(profsample_t), PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if(t->samples==MAP_FAILED) {
+        free(t);
+        return NULL;
+    }
+    struct sigevent sev = {0};
+    sev.sigev_notify = SIGEV_THREAD_ID;
+    sev.sigev_signo = SIGPROF;
+    sev.sigev_notify_thread_id = syscall(SYS_gettid);
+    if(timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &t->timer)==0) {
+        struct itimerspec its = {0};
+        its.it_interval.tv_sec = its.it_value.tv_sec = 1/box86_profile;
+        its.it_interval.tv_nsec = its.it_value.tv_nsec = (box86_profile>1)?(1000000000/box86_profile):0;
+        timer_settime(t->timer, 0, &its, NULL);
+        t->has_timer = 1;
+    } else
+        printf_log(LOG_INFO, "Profiler: cannot create a timer for thread %d\n", (int)syscall(SYS_gettid));
+    pthread_mutex_lock(&profiler_mutex);
+    t->next = profiler_threads;
+    profiler_threads = t;
+    pthread_mutex_unlock(&profiler_mutex);
+    pthread_setspecific(profiler_key, t);
+    return t;
+}
+
+void ProfilerInit(box86context_t* context)
+{
+    if(box86_profile>1000000000)
+        box86_profile = 1000000000;
+    pthread_key_create(&profiler_key, profiler_thread_end);
+    struct sigaction action = {0};
+    action.sa_sigaction = profiler_signal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, NULL);
+    profiler_pid = getpid();
+    profiler_on = 1;
+}
+
+profstate_t ProfilerEnterEmu(x86emu_t* emu)
+{
+    profstate_t old = {0};
+    if(!profiler_on)
+        return old;
+    profthread_t* t = profiler_self;
+    if(!t && !(t = profiler_self = profiler_thread_start()))
+        return old;
+    old.emu = t->emu;
+    old.native = t->native;
+    t->native = 0;
+    t->emu = emu;
+    return old;
+}
+
+void ProfilerLeaveEmu(profstate_t old)
+{
+    profthread_t* t = profiler_self;
+    if(!t)
+        return;
+    t->emu = old.emu;
+    t->native = old.native;
+}
+
+uintptr_t ProfilerEnterNative(uintptr_t fnc)
+{
+    profthread_t* t = profiler_self;
+    if(!t)
+        return 0;
+    uintptr_t old = t->native;
+    t->native = fnc;
+    return old;
+}
+
+void ProfilerLeaveNative(uintptr_t old)
+{
+    profthread_t* t = profiler_self;
+    if(t)
+        t->native = old;
+}
+
+static uintptr_t profiler_arm2x86(box86context_t* context, uintptr_t pc)
+{
+#ifdef DYNAREC
+    uintptr_t start = 0;
+    dynablock_t* db = FindDynablockFromNativeAddress(context, pc, &start);
+    if(!db)
+        return 0;
+    // same walk as the SIGBUS handler, the block start if it has been rebuilt since
+    uintptr_t x86 = db->x86addr;
+    if(start!=(uintptr_t)db->block || !db->instsize)
+        return x86;
+    uintptr_t arm = start;
+    for(int i=0; i<db->ninst; ++i) {
+        arm += db->instsize[i]>>8;
+        if(pc<arm)
+            return x86;
+        x86 += db->instsize[i]&0xff;
+    }
+    return db->x86addr;
+#else
+    return 0;
+#endif
+}
+
+static void profiler_name(box86context_t* context, uintptr_t addr, char* buff, int size)
+{
+    elfheader_t* h = FindElfAddress(context, addr);
+    uintptr_t start = 0;
+    const char* symbname = FindNearestSymbolName(h, (void*)addr, &start, NULL);
+    if(symbname && symbname[0])
+        snprintf(buff, size, "%s", symbname);
+    else if(h)
+        snprintf(buff, size, "[%s]", ElfName(h));
+    else
+        snprintf(buff, size, "[unknown]");
+}
+
+void ProfilerDump(box86context_t* context)
+{
+    if(!profiler_on || getpid()!=profiler_pid)   // forked children don't have the timers
+        return;
+    profiler_on = 0;
+    kh_folded_t* folded = kh_init(folded);
+    uint32_t total = 0, lost = 0;
+    pthread_mutex_lock(&profiler_mutex);
+    for(profthread_t* t=profiler_threads; t; t=t->next) {
+        if(t->has_timer) {
+            timer_delete(t->timer);
+            t->has_timer = 0;
+        }
+        lost += t->lost;
+        for(int i=0; i<PROF_SIZE; ++i) {
+            profsample_t* s = &t->samples[i];
+            if(!s->count)
+                continue;
+            char line[PROF_DEPTH*128] = {0};
+            int l = 0;
+            // folded stacks are root first
+            for(int j=s->depth-1; j>=0 && l<(int)sizeof(line)-1; --j) {
+                char name[300];
+                uintptr_t addr = s->frames[j];
+                if(!j && s->kind==PROF_NATIVE)
+                    snprintf(name, sizeof(name), "native:%s", GetNativeName(context->emu, (void*)addr));
+                else if(!j && s->kind==PROF_ARM) {
+                    addr = profiler_arm2x86(context, addr);
+                    if(addr)
+                        profiler_name(context, addr, name, sizeof(name));
+                    else
+                        snprintf(name, sizeof(name), "[dynarec]");
+                } else
+                    profiler_name(context, j?(addr-1):addr, name, sizeof(name)); // return address can be just after the function
+                for(char* c=name; *c; ++c)
+                    if(*c==';')
+                        *c = ':';
+                l += snprintf(line+l, sizeof(line)-l, "%s%s", (j==s->depth-1)?"":";", name);
+            }
+            int ret;
+            khint_t k = kh_get(folded, folded, line);
+            if(k==kh_end(folded)) {
+                k = kh_put(folded, folded, strdup(line), &ret);
+                kh_value(folded, k) = 0;
+            }
+            kh_value(folded, k) += s->count;
+            total += s->count;
+        }
+    }
+    pthread_mutex_unlock(&profiler_mutex);
+
+    char name[100];
+    sprintf(name, "/tmp/box86-%d.folded", getpid());
+    FILE* f = fopen(name, "w");
+    if(!f)
+        printf_log(LOG_INFO, "Cannot create profile file %s\n", name);
+    const char* key;
+    uint32_t count;
+    kh_foreach(folded, key, count,
+        if(f) fprintf(f, "%s %u\n", key, count);
+        free((void*)key);
+    );
+    kh_destroy(folded, folded);
+    if(f) {
+        fclose(f);
+        printf_log(LOG_INFO, "Profile of %u samples written to %s (%u lost)\n", total, name, lost);
+    }
+}
@@ -581,6 +581,126 @@ MMX_SHIFT_TEST(test_mmx_psrlqi, mmx_psrlq_test_data, _m_psrlqi);
 MMX_SHIFT_TEST(test_mmx_psrlwi, mmx_psrlw_test_data, _m_psrlwi);
 
 
+// MMX extensions (SSE integer instructions on mm registers)
+mmx_u64_test_t mmx_psubq_test_data[] = {
+	{ .a = 0x0000000100000000,
+	  .b = 0x0000000000000001,
+	  .result = 0x00000000FFFFFFFF },
+	{ .a = 0x0000000000000000,
+	  .b = 0x0000000000000001,
+	  .result = 0xFFFFFFFFFFFFFFFF },
+};
+
+mmx_u64_test_t mmx_pavgb_test_data[] = {
+	{ .a = 0x00FF01FE80007F10,
+	  .b = 0x00FF00FF80FF7F20,
+	  .result = 0x00FF01FF80807F18 },
+};
+
+mmx_u64_test_t mmx_pavgw_test_data[] = {
+	{ .a = 0x0000FFFF00018000,
+	  .b = 0x0001FFFF00000001,
+	  .result = 0x0001FFFF00014001 },
+};
+
+mmx_u64_test_t mmx_pminub_test_data[] = {
+	{ .a = 0x00FF7F8001FE1234,
+	  .b = 0xFF00807F02FD3412,
+	  .result = 0x00007F7F01FD1212 },
+};
+
+mmx_u64_test_t mmx_pmaxub_test_data[] = {
+	{ .a = 0x00FF7F8001FE1234,
+	  .b = 0xFF00807F02FD3412,
+	  .result = 0xFFFF808002FE3434 },
+};
+
+mmx_u64_test_t mmx_pminsw_test_data[] = {
+	{ .a = 0x7FFF800000011234,
+	  .b = 0x8000FFFFFFFF3412,
+	  .result = 0x80008000FFFF1234 },
+};
+
+mmx_u64_test_t mmx_pmaxsw_test_data[] = {
+	{ .a = 0x7FFF800000011234,
+	  .b = 0x8000FFFFFFFF3412,
+	  .result = 0x7FFFFFFF00013412 },
+};
+
+mmx_u64_test_t mmx_psadbw_test_data[] = {
+	{ .a = 0x00FF00FF00FF00FF,
+	  .b = 0xFF00FF00FF00FF00,
+	  .result = 0x00000000000007F8 },
+	{ .a = 0x0102030405060708,
+	  .b = 0x0807060504030201,
+	  .result = 0x0000000000000020 },
+};
+
+// _mm_sub_si64 needs SSE2, that would let the compiler use xmm registers for the other tests
+__m64 mm_psubq(__m64 a, __m64 b) {
+	asm("psubq %1, %0" : "+y" (a) : "y" (b));
+	return a;
+}
+
+MMX_64_TEST(test_mmx_psubq, mmx_psubq_test_data, mm_psubq);
+MMX_64_TEST(test_mmx_pavgb, mmx_pavgb_test_data, _m_pavgb);
+MMX_64_TEST(test_mmx_pavgw, mmx_pavgw_test_data, _m_pavgw);
+MMX_64_TEST(test_mmx_pminub, mmx_pminub_test_data, _m_pminub);
+MMX_64_TEST(test_mmx_pmaxub, mmx_pmaxub_test_data, _m_pmaxub);
+MMX_64_TEST(test_mmx_pminsw, mmx_pminsw_test_data, _m_pminsw);
+MMX_64_TEST(test_mmx_pmaxsw, mmx_pmaxsw_test_data, _m_pmaxsw);
+MMX_64_TEST(test_mmx_psadbw, mmx_psadbw_test_data, _m_psadbw);
+
+bool test_mmx_pmovmskb() {
+	printf("TEST: test_mmx_pmovmskb\n");
+	int errors = 0;
+
+	int result = _m_pmovmskb(mm_load64(0x80017F8000FF0180));
+	if (result != 0x95) {
+		printf("Failed; Expected: 0x%02x\tGot: 0x%02x\n", 0x95, result);
+		errors++;
+	}
+
+	_m_empty();
+	printf("TEST: finished with: %d errors\n", errors);
+	return errors;
+}
+
+bool test_mmx_maskmovq() {
+	printf("TEST: test_mmx_maskmovq\n");
+	int errors = 0;
+
+	u64 mem = 0x1111111111111111;
+	_m_maskmovq(mm_load64(0x0123456789ABCDEF), mm_load64(0x80007F80FF000180), (char*)&mem);
+	if (mem != 0x01111167891111EF) {
+		printf("Failed; Expected: 0x%08x_%08x\tGot: 0x%08x_%08x\n", 0x01111167, 0x891111EF, (u32)(mem >> 32), (u32)mem);
+		errors++;
+	}
+
+	_m_empty();
+	printf("TEST: finished with: %d errors\n", errors);
+	return errors;
+}
+
+bool test_mmx_movntq() {
+	printf("TEST: test_mmx_movntq\n");
+	int errors = 0;
+
+	__m64 mem = mm_load64(0);
+	_mm_stream_pi(&mem, mm_load64(0x0123456789ABCDEF));
+	_mm_sfence();
+	if (!mm_raw_compare(mem, mm_load64(0x0123456789ABCDEF))) {
+		printf("Failed; Expected: 0x%08x_%08x\tGot: 0x%08x_%08x\n", 0x01234567, 0x89ABCDEF,
+			_m_to_int(_mm_srli_si64(mem, 32)), _m_to_int(mem));
+		errors++;
+	}
+
+	_m_empty();
+	printf("TEST: finished with: %d errors\n", errors);
+	return errors;
+}
+
+
 
 
 bool test_mmx_cpuid() {
@@ -667,6 +787,18 @@ int main() {
 	errors += (int) test_mmx_psrlw();
 	errors += (int) test_mmx_psrlwi();
 
+	errors += (int) test_mmx_psubq();
+	errors += (int) test_mmx_pavgb();
+	errors += (int) test_mmx_pavgw();
+	errors += (int) test_mmx_pminub();
+	errors += (int) test_mmx_pmaxub();
+	errors += (int) test_mmx_pminsw();
+	errors += (int) test_mmx_pmaxsw();
+	errors += (int) test_mmx_psadbw();
+	errors += (int) test_mmx_pmovmskb();
+	errors += (int) test_mmx_maskmovq();
+	errors += (int) test_mmx_movntq();
+
 
 	printf("Errors: %d\n", errors);
 	return errors;
@@ -0,0 +1,46 @@
+// Host side test of the load / store classification of src/dynarec/arm_memorder.c
+#include <stdio.h>
+#include <stdint.h>
+
+int box86_dynarec_strongmem = 0;
+
+#include "dynarec/arm_memorder.c"
+
+typedef struct access_s {
+    const char* name;
+    uint32_t    op;
+    int         type;   // 0: none, 1: load, 2: store
+    int         rn;
+} access_t;
+
+static const access_t accesses[] = {
+    {"vld1.8 {d0}, [r1]",       0xf421070f, 1, 1},
+    {"vst1.8 {d0}, [r1]",       0xf401070f, 2, 1},
+    {"vld1.32 {d0-d1}, [r2]!",  0xf4220a8d, 1, 2},
+    {"vst1.32 {d0-d1}, [r2]!",  0xf4020a8d, 2, 2},
+    {"ldr r0, [r1]",            0xe5910000, 1, 1},
+    {"str r0, [r1]",            0xe5810000, 2, 1},
+    {"ldrd r2, r3, [r1]",       0xe1c120d0, 1, 1},
+    {"strd r2, r3, [r1]",       0xe1c120f0, 2, 1},
+    {"ldrex r0, [r1]",          0xe1910f9f, 1, 1},
+    {"strex r2, r0, [r1]",      0xe1812f90, 2, 1},
+    {"vldr d0, [r1]",           0xed910b00, 1, 1},
+    {"vstr d0, [r1]",           0xed810b00, 2, 1},
+    {"add r0, r1, r2",          0xe0810002, 0, 1},
+    {"dmb ish",                 0xf57ff05b, 0, 15},
+};
+
+int main(int argc, const char** argv)
+{
+    int errors = 0;
+    for(int i=0; i<(int)(sizeof(accesses)/sizeof(accesses[0])); ++i) {
+        int rn;
+        int type = memaccess(accesses[i].op, &rn);
+        if(type!=accesses[i].type || (type && rn!=accesses[i].rn)) {
+            printf("%s (%08x): got type %d rn %d, expected type %d rn %d\n", accesses[i].name, accesses[i].op, type, rn, accesses[i].type, accesses[i].rn);
+            ++errors;
+        }
+    }
+    printf("memorder: %d opcodes checked, %d errors\n", (int)(sizeof(accesses)/sizeof(accesses[0])), errors);
+    return errors?1:0;
+}
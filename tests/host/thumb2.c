@@ -0,0 +1,106 @@
+// Host side test of the A32 to Thumb-2 translation of src/dynarec/arm_thumb2.c
+// (expected encodings checked with llvm-mc -triple=thumbv7a)
+#include <stdio.h>
+#include <stdint.h>
+
+#include "dynarec/arm_thumb2.c"
+
+typedef struct opcode_s {
+    const char* name;
+    uint32_t    a32;
+    int         size;   // 0: no T32 equivalent
+    uint32_t    t32;    // first halfword in the high 16 bits for a 32bits opcode
+    int         in_it;
+} opcode_t;
+
+static const opcode_t opcodes[] = {
+    {"movs r0, r1",                       0xe1b00001, 2, 0x0008, 0},
+    {"mov r8, r9",                        0xe1a08009, 2, 0x46c8, 0},
+    {"mov r0, #0x1000",                   0xe3a00a01, 4, 0xf44f5080, 0},
+    {"add sp, sp, #16",                   0xe28dd010, 2, 0xb004, 0},
+    {"add r0, r1, #4000",                 0xe2810efa, 4, 0xf501607a, 0},
+    {"adds r0, r1, r2",                   0xe0910002, 2, 0x1888, 0},
+    {"add r0, r1, r2",                    0xe0810002, 4, 0xeb010002, 0},
+    {"add r0, r1, r2 (in IT)",            0xe0810002, 2, 0x1888, 1},
+    {"adds r0, r1, r2 (in IT)",           0xe0910002, 4, 0xeb110002, 1},
+    {"ands r0, r0, r1",                   0xe0100001, 2, 0x4008, 0},
+    {"orr r0, r1, r2, lsr #31",           0xe1810fa2, 4, 0xea4170d2, 0},
+    {"tst r8, #0x80000000",               0xe3180102, 4, 0xf0184f00, 0},
+    {"cmp r8, r1",                        0xe1580001, 2, 0x4588, 0},
+    {"lsls r0, r0, r2",                   0xe1b00210, 2, 0x4090, 0},
+    {"movw r0, #0x1234",                  0xe3010234, 4, 0xf2412034, 0},
+    {"movt r0, #0xabcd",                  0xe34a0bcd, 4, 0xf6ca30cd, 0},
+    {"mul r0, r1, r2",                    0xe0000291, 4, 0xfb01f002, 0},
+    {"umull r0, r1, r2, r3",              0xe0810392, 4, 0xfba20103, 0},
+    {"ldrex r0, [r1]",                    0xe1910f9f, 4, 0xe8510f00, 0},
+    {"strex r2, r0, [r1]",                0xe1812f90, 4, 0xe8410200, 0},
+    {"ldrh r0, [r1, #62]",                0xe1d103be, 2, 0x8fc8, 0},
+    {"ldrh r0, [r1], #4",                 0xe0d100b4, 4, 0xf8310b04, 0},
+    {"ldrsh r0, [r1, r2]",                0xe19100f2, 2, 0x5e88, 0},
+    {"ldrd r0, r1, [r2, #-8]",            0xe14200d8, 4, 0xe9520102, 0},
+    {"ldr r0, [r1, #124]",                0xe591007c, 2, 0x6fc8, 0},
+    {"ldr r0, [r1, #-4]",                 0xe5110004, 4, 0xf8510c04, 0},
+    {"ldr r0, [r1, r2, lsl #2]",          0xe7910102, 4, 0xf8510022, 0},
+    {"ldr r0, [sp, #8]",                  0xe59d0008, 2, 0x9802, 0},
+    {"strb r0, [r1, #-1]",                0xe5410001, 4, 0xf8010c01, 0},
+    {"push {r4, r5, lr}",                 0xe92d4030, 2, 0xb530, 0},
+    {"pop {r0, r1, r2, r3, r4, r5, r6, r7, r8, r9, r10, r11, r12, pc}", 0xe8bd9fff, 4, 0xe8bd9fff, 0},
+    {"ldm r0!, {r1}",                     0xe8b00002, 4, 0xf8501b04, 0},
+    {"stmdb r0!, {r1, r2}",               0xe9200006, 4, 0xe9200006, 0},
+    {"bx lr",                             0xe12fff1e, 2, 0x4770, 0},
+    {"blx r3",                            0xe12fff33, 2, 0x4798, 0},
+    {"clz r0, r1",                        0xe16f0f11, 4, 0xfab1f081, 0},
+    {"smulbt r0, r1, r2",                 0xe16002c1, 4, 0xfb11f012, 0},
+    {"uxth r0, r1",                       0xe6ff0071, 2, 0xb288, 0},
+    {"uxtah r0, r1, r2, ror #16",         0xe6f10872, 4, 0xfa11f0a2, 0},
+    {"rev r8, r1",                        0xe6bf8f31, 4, 0xfa91f881, 0},
+    {"ubfx r0, r1, #3, #5",               0xe7e401d1, 4, 0xf3c100c4, 0},
+    {"bfc r0, #4, #8",                    0xe7cb021f, 4, 0xf36f100b, 0},
+    {"ssat r0, #16, r1, lsl #4",          0xe6af0211, 4, 0xf301100f, 0},
+    {"sdiv r0, r1, r2",                   0xe710f211, 4, 0xfb91f0f2, 0},
+    {"smmul r0, r1, r2",                  0xe750f211, 4, 0xfb51f002, 0},
+    {"usad8 r0, r1, r2",                  0xe780f211, 4, 0xfb71f002, 0},
+    {"vadd.f64 d0, d1, d2",               0xee310b02, 4, 0xee310b02, 0},
+    {"vmov d0, r0, r1",                   0xec410b10, 4, 0xec410b10, 0},
+    {"vadd.i32 q0, q1, q2",               0xf2220844, 4, 0xef220844, 0},
+    {"vst1.32 {d0, d1, 0}, [r2]!",           0xf4020a8d, 4, 0xf9020a8d, 0},
+    {"dmb ish",                           0xf57ff05b, 4, 0xf3bf8f5b, 0},
+    {"pld [r0, #32]",                     0xf5d0f020, 4, 0xf890f020, 0},
+    {"rsc r0, r1, r2",                    0xe0e10002, 0, 0x0000, 0},
+    {"add r0, r1, r2, lsl r3",            0xe0810312, 0, 0x0000, 0},
+    {"ldr r0, [r1, -r2]",                 0xe7110002, 0, 0x0000, 0},
+    {"ldr r0, [pc, #4]",                  0xe59f0004, 0, 0x0000, 0},
+};
+
+// cmp r0, #0 / beq 1f / addne r1, r1, #1 / moveq r1, #0 / 1: add r2, r2, r1 / bx lr / b . / bl 2b
+static const uint32_t block[] = {0xe3500000, 0x0a000001, 0x12811001, 0x03a01000, 0xe0822001, 0xe12fff1e, 0xeafffffe, 0xebfffff9};
+// cmp r0, #0 / beq 1f / ite ne / adds r1, r1, #1 / movs r1, #0 / 1: add r2, r1 / bx lr / b . / bl 2b
+static const uint16_t block_t32[] = {0x2800, 0xd002, 0xbf14, 0x1c49, 0x2100, 0x440a, 0x4770, 0xe7fe, 0xf7ff, 0xfff8};
+
+int main(int argc, const char** argv)
+{
+    int errors = 0;
+    int n = sizeof(opcodes)/sizeof(opcodes[0]);
+    for(int i=0; i<n; ++i) {
+        uint32_t t = 0;
+        int size = arm_to_thumb2(opcodes[i].a32, opcodes[i].in_it, &t);
+        if(size!=opcodes[i].size || (size && t!=opcodes[i].t32)) {
+            printf("%s (%08x): got %d bytes %08x, expected %d bytes %08x\n", opcodes[i].name, opcodes[i].a32, size, t, opcodes[i].size, opcodes[i].t32);
+            ++errors;
+        }
+    }
+    uint16_t out[5*sizeof(block)/sizeof(block[0])];
+    int untranslated;
+    int size = arm_thumb2_block(block, sizeof(block)/sizeof(block[0]), 0x10000, out, &untranslated);
+    if(size!=sizeof(block_t32) || untranslated) {
+        printf("block: got %d bytes (%d untranslated), expected %d bytes\n", size, untranslated, (int)sizeof(block_t32));
+        ++errors;
+    } else
+        for(int i=0; i<size/2; ++i)
+            if(out[i]!=block_t32[i]) {
+                printf("block: halfword %d is %04x, expected %04x\n", i, out[i], block_t32[i]);
+                ++errors;
+            }
+    printf("thumb2: %d opcodes and 1 block checked, %d errors\n", n, errors);
+    return errors?1:0;
+}
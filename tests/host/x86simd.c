@@ -0,0 +1,256 @@
+// Host side test of src/emu/x86simd.h: every helper is run on random and edge case operands, and compared
+// lane by lane with plain scalar code (the per lane loops the interpreter used before).
+// Built twice by CMake: with the host SIMD path (NEON / SSE2) and with the scalar fallback.
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "regs.h"
+#include "emu/x86simd.h"
+
+typedef void (*op64_t)(mmx_regs_t* d, const mmx_regs_t* s);
+typedef void (*op128_t)(sse_regs_t* d, const sse_regs_t* s);
+typedef void (*ref_t)(sse_regs_t* d, const sse_regs_t* s, int n);  // on the n first bytes
+
+#define SAT(V, L, H)    (((V)<(L))?(L):(((V)>(H))?(H):(V)))
+
+// d = E(a, b) on each lane (F is the lane field, W the type used for the computation)
+#define REF(name, F, W, E)                                                      \
+static void name##_ref(sse_regs_t* d, const sse_regs_t* s, int n)              \
+{                                                                               \
+    for(int i=0; i<n/(int)sizeof(d->F[0]); ++i) {                               \
+        W a = d->F[i], b = s->F[i]; (void)a;                                    \
+        d->F[i] = (E);                                                          \
+    }                                                                           \
+}
+
+REF(paddb, ub, uint32_t, a+b)
+REF(paddw, uw, uint32_t, a+b)
+REF(paddd, ud, uint32_t, a+b)
+REF(paddq, q, uint64_t, a+b)
+REF(psubb, ub, uint32_t, a-b)
+REF(psubw, uw, uint32_t, a-b)
+REF(psubd, ud, uint32_t, a-b)
+REF(psubq, q, uint64_t, a-b)
+REF(pand, ud, uint32_t, a&b)
+REF(pandn, ud, uint32_t, (~a)&b)
+REF(por, ud, uint32_t, a|b)
+REF(pxor, ud, uint32_t, a^b)
+REF(pcmpeqb, sb, int32_t, (a==b)?-1:0)
+REF(pcmpeqw, sw, int32_t, (a==b)?-1:0)
+REF(pcmpeqd, sd, int32_t, (a==b)?-1:0)
+REF(pcmpgtb, sb, int32_t, (a>b)?-1:0)
+REF(pcmpgtw, sw, int32_t, (a>b)?-1:0)
+REF(pcmpgtd, sd, int32_t, (a>b)?-1:0)
+REF(pmullw, uw, uint32_t, a*b)
+REF(paddsb, sb, int32_t, SAT(a+b, -128, 127))
+REF(paddsw, sw, int32_t, SAT(a+b, -32768, 32767))
+REF(paddusb, ub, int32_t, SAT(a+b, 0, 255))
+REF(paddusw, uw, int32_t, SAT(a+b, 0, 65535))
+REF(psubsb, sb, int32_t, SAT(a-b, -128, 127))
+REF(psubsw, sw, int32_t, SAT(a-b, -32768, 32767))
+REF(psubusb, ub, int32_t, SAT(a-b, 0, 255))
+REF(psubusw, uw, int32_t, SAT(a-b, 0, 65535))
+REF(pminub, ub, int32_t, (a<b)?a:b)
+REF(pmaxub, ub, int32_t, (a>b)?a:b)
+REF(pminsw, sw, int32_t, (a<b)?a:b)
+REF(pmaxsw, sw, int32_t, (a>b)?a:b)
+REF(pavgb, ub, int32_t, (a+b+1)>>1)
+REF(pavgw, uw, int32_t, (a+b+1)>>1)
+REF(pmulhrsw, sw, int32_t, (((a*b)>>14)+1)>>1)
+REF(psignb, sb, int32_t, (b<0)?-a:(b?a:0))
+REF(psignw, sw, int32_t, (b<0)?-a:(b?a:0))
+REF(psignd, sd, int64_t, (b<0)?-a:(b?a:0))
+REF(pabsb, sb, int32_t, (b<0)?-b:b)
+REF(pabsw, sw, int32_t, (b<0)?-b:b)
+REF(pabsd, sd, int64_t, (b<0)?-b:b)
+REF(addps, f, float, a+b)
+REF(subps, f, float, a-b)
+REF(mulps, f, float, a*b)
+REF(divps, f, float, a/b)
+REF(addpd, d, double, a+b)
+REF(subpd, d, double, a-b)
+REF(mulpd, d, double, a*b)
+REF(divpd, d, double, a/b)
+
+static void pshufb_ref(sse_regs_t* d, const sse_regs_t* s, int n)
+{
+    sse_regs_t a = *d;
+    for(int i=0; i<n; ++i)
+        d->ub[i] = (s->ub[i]&128)?0:a.ub[s->ub[i]&(n-1)];
+}
+// horizontal ops: low half from pairs of d, high half from pairs of s
+#define REFH(name, F, E)                                                        \
+static void name##_ref(sse_regs_t* d, const sse_regs_t* s, int n)              \
+{                                                                               \
+    sse_regs_t r;                                                               \
+    int c = n/(int)sizeof(d->F[0]);                                             \
+    for(int i=0; i<c/2; ++i) {                                                  \
+        int64_t a = d->F[i*2], b = d->F[i*2+1];                                 \
+        r.F[i] = (E);                                                           \
+        a = s->F[i*2]; b = s->F[i*2+1];                                         \
+        r.F[c/2+i] = (E);                                                       \
+    }                                                                           \
+    memcpy(d, &r, n);                                                           \
+}
+REFH(phaddw, sw, a+b)
+REFH(phaddd, sd, a+b)
+REFH(phaddsw, sw, SAT(a+b, -32768, 32767))
+REFH(phsubw, sw, a-b)
+REFH(phsubd, sd, a-b)
+REFH(phsubsw, sw, SAT(a-b, -32768, 32767))
+static void pmaddubsw_ref(sse_regs_t* d, const sse_regs_t* s, int n)
+{
+    for(int i=0; i<n/2; ++i) {
+        int32_t v = d->ub[i*2]*s->sb[i*2] + d->ub[i*2+1]*s->sb[i*2+1];
+        d->sw[i] = SAT(v, -32768, 32767);
+    }
+}
+
+typedef struct simdop_s {
+    const char* name;
+    op64_t      op64;   // NULL for SSE only ops
+    op128_t     op128;
+    ref_t       ref;
+    int         fp;     // 1: float lanes, 2: double lanes (any NaN is equal to any NaN)
+} simdop_t;
+
+#define OP(name)    {#name, name##_64, name##_128, name##_ref, 0}
+#define OPF(name)   {#name, NULL, name, name##_ref, 1}
+#define OPD(name)   {#name, NULL, name, name##_ref, 2}
+
+static const simdop_t ops[] = {
+    OP(paddb), OP(paddw), OP(paddd), OP(paddq), OP(psubb), OP(psubw), OP(psubd), OP(psubq),
+    OP(pand), OP(pandn), OP(por), OP(pxor),
+    OP(pcmpeqb), OP(pcmpeqw), OP(pcmpeqd), OP(pcmpgtb), OP(pcmpgtw), OP(pcmpgtd), OP(pmullw),
+    OP(paddsb), OP(paddsw), OP(paddusb), OP(paddusw), OP(psubsb), OP(psubsw), OP(psubusb), OP(psubusw),
+    OP(pminub), OP(pmaxub), OP(pminsw), OP(pmaxsw), OP(pavgb), OP(pavgw),
+    OP(pshufb), OP(phaddw), OP(phaddd), OP(phaddsw), OP(phsubw), OP(phsubd), OP(phsubsw),
+    OP(pmaddubsw), OP(pmulhrsw), OP(psignb), OP(psignw), OP(psignd), OP(pabsb), OP(pabsw), OP(pabsd),
+    OPF(addps), OPF(subps), OPF(mulps), OPF(divps), OPD(addpd), OPD(subpd), OPD(mulpd), OPD(divpd),
+};
+
+#define NTESTS  20000
+
+static uint32_t rnd_state = 0x12345678;
+static uint32_t rnd()
+{
+    // xorshift32
+    rnd_state ^= rnd_state<<13;
+    rnd_state ^= rnd_state>>17;
+    rnd_state ^= rnd_state<<5;
+    return rnd_state;
+}
+
+// random bytes, with a lot of edge values (so lanes like 0x7fff, 0x8000 or 0xffff are frequent)
+static void fill(sse_regs_t* r)
+{
+    static const uint8_t edges[] = {0x00, 0x01, 0x7f, 0x80, 0xff};
+    for(int i=0; i<16; ++i) {
+        uint32_t v = rnd();
+        r->ub[i] = ((v>>8)&3)?(uint8_t)v:edges[(v>>16)%sizeof(edges)];
+    }
+}
+
+static int same(const sse_regs_t* a, const sse_regs_t* b, int n, int fp)
+{
+    if(fp==1) {
+        for(int i=0; i<n/4; ++i)
+            if(a->ud[i]!=b->ud[i] && !(isnan(a->f[i]) && isnan(b->f[i])))
+                return 0;
+        return 1;
+    }
+    if(fp==2) {
+        for(int i=0; i<n/8; ++i)
+            if(a->q[i]!=b->q[i] && !(isnan(a->d[i]) && isnan(b->d[i])))
+                return 0;
+        return 1;
+    }
+    return !memcmp(a, b, n);
+}
+
+static void dump(const char* txt, const sse_regs_t* r, int n)
+{
+    printf(" %s=", txt);
+    for(int i=n-1; i>=0; --i)
+        printf("%02x", r->ub[i]);
+}
+
+static int fail(const char* name, int n, const sse_regs_t* d, const sse_regs_t* s, const sse_regs_t* got, const sse_regs_t* expected)
+{
+    printf("%s_%d:", name, n*8);
+    dump("d", d, n); dump("s", s, n); dump("got", got, n); dump("expected", expected, n);
+    printf("\n");
+    return 1;
+}
+
+int main(int argc, const char** argv)
+{
+    int errors = 0;
+    for(int k=0; k<(int)(sizeof(ops)/sizeof(ops[0])); ++k) {
+        const simdop_t* op = &ops[k];
+        int err = 0;
+        for(int t=0; t<NTESTS && err<4; ++t) {
+            sse_regs_t d, s, got, expected;
+            fill(&d); fill(&s);
+            int alias = !(t&15);    // d and s are the same register
+            if(alias)
+                s = d;
+            if(op->op64) {
+                mmx_regs_t m;
+                memcpy(&m, &d, 8);
+                if(alias)
+                    op->op64(&m, &m);
+                else
+                    op->op64(&m, (mmx_regs_t*)&s);
+                memset(&got, 0, sizeof(got));
+                memcpy(&got, &m, 8);
+                memset(&expected, 0, sizeof(expected));
+                memcpy(&expected, &d, 8);
+                op->ref(&expected, &s, 8);
+                if(!same(&got, &expected, 8, op->fp))
+                    err += fail(op->name, 8, &d, &s, &got, &expected);
+            }
+            got = d;
+            if(alias)
+                op->op128(&got, &got);
+            else
+                op->op128(&got, &s);
+            expected = d;
+            op->ref(&expected, &s, 16);
+            if(!same(&got, &expected, 16, op->fp))
+                err += fail(op->name, 16, &d, &s, &got, &expected);
+        }
+        errors += err;
+    }
+    // palignr, for every immediate
+    for(int imm=0; imm<256; ++imm)
+        for(int t=0; t<64; ++t) {
+            sse_regs_t d, s, got, expected;
+            fill(&d); fill(&s);
+            for(int n=8; n<=16; n+=8) {
+                uint8_t tmp[64] = {0};
+                memcpy(tmp, &s, n); memcpy(tmp+n, &d, n);
+                memset(&expected, 0, sizeof(expected));
+                memcpy(&expected, tmp+((imm<32)?imm:32), n);
+                memset(&got, 0, sizeof(got));
+                memcpy(&got, &d, n);
+                if(n==8)
+                    palignr_64((mmx_regs_t*)&got, (mmx_regs_t*)&s, imm);
+                else
+                    palignr_128(&got, &s, imm);
+                if(memcmp(&got, &expected, n) && errors<100)
+                    errors += fail("palignr", n, &d, &s, &got, &expected);
+            }
+        }
+#if defined(SIMD_NEON)
+    const char* path = "NEON";
+#elif defined(SIMD_SSE2)
+    const char* path = "SSE2";
+#else
+    const char* path = "scalar";
+#endif
+    printf("x86simd (%s): %d ops checked, %d errors\n", path, (int)(sizeof(ops)/sizeof(ops[0]))+1, errors);
+    return errors?1:0;
+}
@@ -0,0 +1,4 @@
+#ifndef __SHIM_LIMITS_H_
+#define __SHIM_LIMITS_H_
+// intentionally empty: extensions/mmx.c includes it but uses none of its macros
+#endif //__SHIM_LIMITS_H_
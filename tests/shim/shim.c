@@ -0,0 +1,92 @@
+// Minimal runtime for the static i386 test binaries (test14, test15, extensions/mmx):
+// _start, a buffered printf and memcpy, using int 0x80 directly, so no i386 libc is needed to build them.
+// See README.md for the build commands.
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+
+static char buf[4096];
+static int pos;
+
+static void flush(void)
+{
+    int r;
+    asm volatile("int $0x80" : "=a"(r) : "a"(4), "b"(1), "c"(buf), "d"(pos) : "memory");   // write(1, buf, pos)
+    pos = 0;
+}
+
+static void out(char c)
+{
+    buf[pos++] = c;
+    if(pos==sizeof(buf))
+        flush();
+}
+
+static void num(uint32_t v, int base, int width, int neg)
+{
+    char t[16];
+    int n = 0;
+    do {
+        t[n++] = "0123456789abcdef"[v%base];
+        v /= base;
+    } while(v);
+    if(neg)
+        t[n++] = '-';
+    while(n<width)
+        t[n++] = '0';
+    while(n)
+        out(t[--n]);
+}
+
+int printf(const char* f, ...)
+{
+    va_list a;
+    va_start(a, f);
+    for(; *f; ++f) {
+        if(*f!='%') {
+            out(*f);
+            continue;
+        }
+        ++f;
+        int w = 0;
+        while(*f>='0' && *f<='9')
+            w = w*10 + (*f++ - '0');
+        switch(*f) {
+            case 'd': {
+                int v = va_arg(a, int);
+                num(v<0?-v:v, 10, w, v<0);
+                } break;
+            case 'u': num(va_arg(a, unsigned), 10, w, 0); break;
+            case 'x': num(va_arg(a, unsigned), 16, w, 0); break;
+            case 's': {
+                const char* s = va_arg(a, const char*);
+                while(*s)
+                    out(*s++);
+                } break;
+            case '%': out('%'); break;
+        }
+    }
+    va_end(a);
+    return 0;
+}
+
+void* memcpy(void* d, const void* s, size_t n)
+{
+    char* dd = d;
+    const char* ss = s;
+    while(n--)
+        *dd++ = *ss++;
+    return d;
+}
+
+int main(int argc, const char** argv);
+
+void __attribute__((noreturn)) cstart(void)
+{
+    int r = main(0, 0);
+    flush();
+    asm volatile("int $0x80" : : "a"(1), "b"(r));   // exit(r)
+    __builtin_unreachable();
+}
+
+asm(".globl _start\n_start:\n and $-16,%esp\n call cstart\n");
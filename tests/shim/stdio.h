@@ -0,0 +1,5 @@
+#ifndef __SHIM_STDIO_H_
+#define __SHIM_STDIO_H_
+// only %d %u %x %s and %%, with an optional 0 padded width
+int printf(const char* fmt, ...);
+#endif //__SHIM_STDIO_H_
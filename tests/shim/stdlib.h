@@ -0,0 +1,9 @@
+#ifndef __SHIM_STDLIB_H_
+#define __SHIM_STDLIB_H_
+#include <stddef.h>
+// declared for mm_malloc.h (pulled by immintrin.h), not implemented
+void* malloc(size_t sz);
+void free(void* p);
+int posix_memalign(void** p, size_t align, size_t sz);
+void abort(void);
+#endif //__SHIM_STDLIB_H_
@@ -0,0 +1,5 @@
+#ifndef __SHIM_STRING_H_
+#define __SHIM_STRING_H_
+#include <stddef.h>
+void* memcpy(void* d, const void* s, size_t n);
+#endif //__SHIM_STRING_H_
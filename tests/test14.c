@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdint.h>
+
+// 16bits operand size (0x66) and address size (0x67) prefixed opcodes
+
+#define FLAGS_MASK  0x8c5   // OF SF ZF PF CF
+
+static const uint16_t vals[] = {0x0000, 0x0001, 0x7fff, 0x8000, 0xffff, 0x1234};
+#define NVALS (sizeof(vals)/sizeof(vals[0]))
+
+#define ALU(name, op, mask) \
+static void test_##name(uint16_t a, uint16_t b) { \
+    uint32_t res = 0xdead0000 | a; uint32_t flags; \
+    asm volatile ( \
+        "clc\n" \
+        op " %w2, %w0\n" \
+        "pushf\n" \
+        "pop %1\n" \
+        : "+r"(res), "=r"(flags) : "r"((uint32_t)b) : "cc"); \
+    printf("%s %04x, %04x = %08x flags=%03x\n", #name, a, b, res, flags&(mask)); \
+}
+ALU(add, "addw", FLAGS_MASK)
+ALU(adc, "stc\nadcw", FLAGS_MASK)
+ALU(sub, "subw", FLAGS_MASK)
+ALU(sbb, "stc\nsbbw", FLAGS_MASK)
+ALU(and, "andw", FLAGS_MASK)
+ALU(or, "orw", FLAGS_MASK)
+ALU(xor, "xorw", FLAGS_MASK)
+ALU(cmp, "cmpw", FLAGS_MASK)
+ALU(test, "testw", FLAGS_MASK)
+ALU(imul, "imulw", 0x801)  // only OF and CF are defined
+#undef ALU
+
+#define SHIFT(name, op, mask) \
+static void test_##name(uint16_t a, uint8_t c) { \
+    uint32_t res1 = 0xbeef0000 | a, res2 = 0xbeef0000 | a; uint32_t flags; \
+    asm volatile ( \
+        op " $5, %w0\n" \
+        op " %%cl, %w1\n" \
+        "pushf\n" \
+        "pop %2\n" \
+        : "+r"(res1), "+r"(res2), "=r"(flags) : "c"((uint32_t)c) : "cc"); \
+    printf("%s %04x, 5 = %08x / %04x, %d = %08x flags=%03x\n", #name, a, res1, a, c, res2, flags&(mask)); \
+}
+SHIFT(shl, "shlw", FLAGS_MASK&~0x800)
+SHIFT(shr, "shrw", FLAGS_MASK&~0x800)
+SHIFT(sar, "sarw", FLAGS_MASK&~0x800)
+SHIFT(rol, "rolw", 0x001)
+SHIFT(ror, "rorw", 0x001)
+#undef SHIFT
+
+static void test_muldiv(uint16_t a, uint16_t b)
+{
+    uint32_t ax = 0x11110000 | a, dx = 0x22220000;
+    asm volatile ("mulw %w2" : "+a"(ax), "+d"(dx) : "r"((uint32_t)b) : "cc");
+    printf("mul %04x, %04x = %08x:%08x\n", a, b, dx, ax);
+    ax = 0x11110000 | a; dx = 0x22220000;
+    asm volatile ("imulw %w2" : "+a"(ax), "+d"(dx) : "r"((uint32_t)b) : "cc");
+    printf("imul %04x, %04x = %08x:%08x\n", a, b, dx, ax);
+    if(b>1 && b!=0xffff) {
+        ax = 0x11110000 | a; dx = 0x22220000;
+        asm volatile ("divw %w2" : "+a"(ax), "+d"(dx) : "r"((uint32_t)b) : "cc");
+        printf("div %04x, %04x = %08x:%08x\n", a, b, dx, ax);
+        ax = 0x11110000 | a; dx = 0x22220000;
+        asm volatile ("cwd\nidivw %w2" : "+a"(ax), "+d"(dx) : "r"((uint32_t)b) : "cc");
+        printf("cwd/idiv %04x, %04x = %08x:%08x\n", a, b, dx, ax);
+    }
+}
+
+static void test_bits(uint16_t a, uint8_t bit)
+{
+    uint32_t r1 = a, r2 = a, r3 = a;
+    uint8_t f1, f2, f3;
+    uint16_t m = a;
+    asm volatile ("btw $11, %w0\nsetc %1\nbtsw $3, %w0" : "+r"(r1), "=q"(f1) :: "cc");
+    asm volatile ("btrw $15, %w0\nsetc %1" : "+r"(r2), "=q"(f2) :: "cc");
+    asm volatile ("btcw %w2, %w0\nsetc %1" : "+r"(r3), "=q"(f3) : "r"((uint32_t)bit) : "cc");
+    asm volatile ("btcw $0, %0" : "+m"(m) :: "cc");
+    printf("bt %04x, %d: %04x %04x %04x %04x cf=%d%d%d\n", a, bit, r1&0xffff, r2&0xffff, r3&0xffff, m, f1, f2, f3);
+}
+
+static void test_cmov(uint16_t a, uint16_t b)
+{
+    uint32_t r1 = 0xaaaa0000 | a, r2 = 0xaaaa0000 | a;
+    asm volatile (
+        "cmpw %w3, %w2\n"
+        "cmovlw %w3, %w0\n"
+        "cmovaw %w3, %w1\n"
+        : "+r"(r1), "+r"(r2) : "r"((uint32_t)a), "r"((uint32_t)b) : "cc");
+    printf("cmov %04x, %04x = %08x %08x\n", a, b, r1, r2);
+}
+
+static void test_xchg(uint16_t a, uint16_t b)
+{
+    uint32_t r1 = 0x11110000 | a, r2 = 0x22220000 | b, ax, flags;
+    uint16_t m = b;
+    asm volatile ("xchgw %w0, %w1" : "+r"(r1), "+r"(r2));
+    printf("xchg %08x %08x\n", r1, r2);
+    asm volatile ("xaddw %w0, %1" : "+r"(r1), "+m"(m) :: "cc");
+    printf("xadd %08x %04x\n", r1, m);
+    ax = 0x33330000 | a;
+    asm volatile ("cmpxchgw %w3, %1\npushf\npop %2" : "+a"(ax), "+m"(m), "=r"(flags) : "r"(r2) : "cc");
+    printf("cmpxchg %08x %04x flags=%03x\n", ax, m, flags&FLAGS_MASK);
+    ax = 0x33330000 | m;
+    asm volatile ("cmpxchgw %w3, %1\npushf\npop %2" : "+a"(ax), "+m"(m), "=r"(flags) : "r"(r2) : "cc");
+    printf("cmpxchg %08x %04x flags=%03x\n", ax, m, flags&FLAGS_MASK);
+}
+
+static void test_lea(uint32_t bx, uint32_t si)
+{
+    uint32_t r1 = 0x55550000, r2 = 0x66660000, r3 = 0x77770000;
+    asm volatile (
+        "leaw 0x1234(%3,%4), %w0\n"
+        "addr16 lea 0x7f(%%bx,%%si), %1\n"     // 67 8D
+        "addr16 leaw -2(%%bx,%%si), %w2\n"     // 67 66 8D
+        : "+r"(r1), "+r"(r2), "+r"(r3) : "b"(bx), "S"(si));
+    printf("lea %08x %08x = %08x %08x %08x\n", bx, si, r1, r2, r3);
+}
+
+static void test_stack(uint16_t a)
+{
+    uint16_t m = a, m2 = 0;
+    uint32_t r = 0x12340000;
+    asm volatile (
+        "pushw %2\n"
+        "popw %1\n"
+        "pushw %1\n"
+        "popw %w0\n"
+        : "+r"(r), "+m"(m2) : "m"(m));
+    printf("push/pop %04x = %04x %08x\n", a, m2, r);
+}
+
+static void test_string()
+{
+    uint16_t src[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint16_t dst[8] = {0};
+    uint32_t c, flags, ax;
+    void *s = src, *d = dst;
+    c = 8;
+    asm volatile ("cld\nrep movsw" : "+S"(s), "+D"(d), "+c"(c) :: "memory");
+    printf("rep movsw: %d %d %d %d %d %d %d %d c=%d\n", dst[0], dst[1], dst[2], dst[3], dst[4], dst[5], dst[6], dst[7], c);
+    dst[5] = 0;
+    s = src; d = dst; c = 8;
+    asm volatile ("cld\n.byte 0xf3, 0x66, 0xa7\npushf\npop %3" : "+S"(s), "+D"(d), "+c"(c), "=r"(flags) :: "memory", "cc");   // F3 66 CMPSW
+    printf("repz cmpsw: c=%d si=%d flags=%03x\n", c, (int)((uint16_t*)s-src), flags&FLAGS_MASK);
+    d = dst; c = 8; ax = 0xffff0007;
+    asm volatile ("cld\nrepnz scasw\npushf\npop %3" : "+D"(d), "+c"(c), "+a"(ax), "=r"(flags) :: "memory", "cc");
+    printf("repnz scasw: c=%d di=%d flags=%03x\n", c, (int)((uint16_t*)d-dst), flags&FLAGS_MASK);
+    d = dst+7; c = 3; ax = 0xaaaa;
+    asm volatile ("std\nrep stosw\ncld" : "+D"(d), "+c"(c), "+a"(ax) :: "memory");
+    printf("rep stosw: %04x %04x %04x %04x %04x\n", dst[3], dst[4], dst[5], dst[6], dst[7]);
+    s = src; c = 5; ax = 0x12340000;
+    asm volatile ("cld\nrep lodsw" : "+S"(s), "+c"(c), "+a"(ax) :: "memory");
+    printf("rep lodsw: %08x\n", ax);
+}
+
+static void test_segprefix(uint16_t a, uint16_t b)
+{
+    uint32_t res = 0xdead0000 | a;
+    asm volatile (".byte 0x66, 0x26\naddl %1, %0" : "+r"(res) : "r"((uint32_t)b) : "cc");  // 66 ES: ADD Ew, Gw
+    printf("es: add %04x, %04x = %08x\n", a, b, res);
+}
+
+int main(int argc, const char** argv)
+{
+    for(int i=0; i<NVALS; ++i)
+        for(int j=0; j<NVALS; ++j) {
+            uint16_t a = vals[i], b = vals[j];
+            test_add(a, b); test_adc(a, b); test_sub(a, b); test_sbb(a, b);
+            test_and(a, b); test_or(a, b); test_xor(a, b); test_cmp(a, b);
+            test_test(a, b); test_imul(a, b);
+            test_muldiv(a, b);
+            test_cmov(a, b);
+            test_xchg(a, b);
+            test_segprefix(a, b);
+        }
+    for(int i=0; i<NVALS; ++i) {
+        uint16_t a = vals[i];
+        for(int c=0; c<18; c+=3) {
+            test_shl(a, c); test_shr(a, c); test_sar(a, c); test_rol(a, c); test_ror(a, c);
+            test_bits(a, c);
+        }
+        test_stack(a);
+        test_lea(0x10000+a, 0x20000+vals[(i+1)%NVALS]);
+    }
+    test_string();
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+// x87 transcendental and rounding opcodes
+
+#define OP1(name, insn) \
+static double name(double a) { \
+    double r; \
+    asm volatile (insn : "=t"(r) : "0"(a)); \
+    return r; \
+}
+OP1(do_fsin, "fsin")
+OP1(do_fcos, "fcos")
+OP1(do_f2xm1, "f2xm1")
+OP1(do_frndint, "frndint")
+#undef OP1
+
+#define OP2(name, insn) \
+static double name(double a, double b) { \
+    double r; \
+    asm volatile (insn : "=t"(r) : "0"(a), "u"(b) : "st(1)"); \
+    return r; \
+}
+OP2(do_fyl2x, "fyl2x")      // b*log2(a)
+OP2(do_fyl2xp1, "fyl2xp1")  // b*log2(a+1)
+OP2(do_fpatan, "fpatan")    // atan2(b, a)
+#undef OP2
+
+static double do_fscale(double a, double b)
+{
+    double r;
+    asm volatile ("fscale" : "=t"(r) : "0"(a), "u"(b));
+    return r;
+}
+
+static double do_fptan(double a, double* one)
+{
+    double r, o;
+    asm volatile ("fptan" : "=t"(o), "=u"(r) : "0"(a));
+    *one = o;
+    return r;
+}
+
+static void do_fsincos(double a, double* s, double* c)
+{
+    double ss, cc;
+    asm volatile ("fsincos" : "=t"(cc), "=u"(ss) : "0"(a));
+    *s = ss;
+    *c = cc;
+}
+
+static void set_round(int mode)
+{
+    uint16_t cw;
+    asm volatile ("fnstcw %0" : "=m"(cw));
+    cw = (cw & ~0x0c00) | (mode<<10);
+    asm volatile ("fldcw %0" : : "m"(cw));
+}
+
+// fixed point with 5 decimals, enough to not depend on the last bits of the result
+static void print_fix(const char* name, double v)
+{
+    int32_t i = (int32_t)(v*100000.0);
+    printf("%s%s%d.%05d", name, (i<0)?"-":"", (i<0?-i:i)/100000, (i<0?-i:i)%100000);
+}
+
+static void print_hex(const char* name, double v)
+{
+    uint32_t u[2];
+    memcpy(u, &v, 8);
+    printf("%s%08x%08x", name, u[1], u[0]);
+}
+
+int main(int argc, const char** argv)
+{
+    static const double angles[] = {0.0, 0.5, 1.0, -1.0, 2.0, 3.0, 10.0, -100.0};
+    for(int i=0; i<sizeof(angles)/sizeof(angles[0]); ++i) {
+        double a = angles[i], s, c, one;
+        printf("angle %d: ", i);
+        print_fix("sin=", do_fsin(a));
+        print_fix(" cos=", do_fcos(a));
+        do_fsincos(a, &s, &c);
+        print_fix(" sincos=", s);
+        print_fix(",", c);
+        print_fix(" tan=", do_fptan(a, &one));
+        print_fix(",", one);
+        printf("\n");
+    }
+    static const double atans[][2] = {{1.0, 1.0}, {-1.0, 1.0}, {1.0, -1.0}, {-2.0, -0.5}, {0.0, -1.0}, {3.0, 0.0}};
+    for(int i=0; i<sizeof(atans)/sizeof(atans[0]); ++i) {
+        printf("fpatan %d: ", i);
+        print_fix("atan=", do_fpatan(atans[i][1], atans[i][0]));
+        printf("\n");
+    }
+    static const double exps[] = {-1.0, -0.5, 0.0, 0.3, 1.0};
+    for(int i=0; i<sizeof(exps)/sizeof(exps[0]); ++i) {
+        printf("f2xm1 %d: ", i);
+        print_fix("r=", do_f2xm1(exps[i]));
+        printf("\n");
+    }
+    static const double logs[][2] = {{8.0, 1.0}, {10.0, 2.0}, {0.5, 3.0}, {1.0, 5.0}, {1024.0, -0.5}};
+    for(int i=0; i<sizeof(logs)/sizeof(logs[0]); ++i) {
+        printf("fyl2x %d: ", i);
+        print_fix("r=", do_fyl2x(logs[i][0], logs[i][1]));
+        print_fix(" p1=", do_fyl2xp1(logs[i][0]/16.0, logs[i][1]));
+        printf("\n");
+    }
+    static const double scales[][2] = {{1.5, 3.0}, {1.5, -3.7}, {3.0, 10.9}, {-1.0, 0.0}, {1e-300, 1500.0}, {1e300, -1100.0}, {0.0, 5000.0}, {2.0, 1e10}};
+    for(int i=0; i<sizeof(scales)/sizeof(scales[0]); ++i) {
+        printf("fscale %d: ", i);
+        print_hex("r=", do_fscale(scales[i][0], scales[i][1]));
+        printf("\n");
+    }
+    static const double rnds[] = {2.5, 3.5, -2.5, -0.3, 0.7, 1e20, 123456.5, -4503599627370495.5, 0.0};
+    static const char* modes[] = {"nearest", "down", "up", "chop"};
+    for(int m=0; m<4; ++m) {
+        set_round(m);
+        printf("frndint %s:", modes[m]);
+        for(int i=0; i<sizeof(rnds)/sizeof(rnds[0]); ++i)
+            print_hex(" ", do_frndint(rnds[i]));
+        printf("\n");
+    }
+    set_round(0);
+    return 0;
+}